@@ -1,4 +1,8 @@
 #pragma once
+#include "Matrix.h"
+#include "ProblemData.h"
+
+#include <memory>
 #include <vector>
 
 namespace cec22 {
@@ -7,148 +11,444 @@ namespace cec22 {
 
 // Ackley's
 double ackley_func(const std::vector<double>& x, std::vector<double>& aux,
-                   const std::vector<double>& shift,
-                   const std::vector<std::vector<double>>& rotate,
+                   const std::vector<double>& shift, const Matrix& rotate,
                    bool shift_flag, bool rotate_flag);
 
 // Bent Cigar
 double bent_cigar_func(const std::vector<double>& x, std::vector<double>& aux,
-                       const std::vector<double>& shift,
-                       const std::vector<std::vector<double>>& rotate,
+                       const std::vector<double>& shift, const Matrix& rotate,
                        bool shift_flag, bool rotate_flag);
 
 // Discus
 double discus_func(const std::vector<double>& x, std::vector<double>& aux,
-                   const std::vector<double>& shift,
-                   const std::vector<std::vector<double>>& rotate,
+                   const std::vector<double>& shift, const Matrix& rotate,
                    bool shift_flag, bool rotate_flag);
 
 // High Conditioned Elliptic Function
 double ellips_func(const std::vector<double>& x, std::vector<double>& aux,
-                   const std::vector<double>& shift,
-                   const std::vector<std::vector<double>>& rotate,
+                   const std::vector<double>& shift, const Matrix& rotate,
                    bool shift_flag, bool rotate_flag);
 
 // Expanded Schaffer’s f6
 double escaffer6_func(const std::vector<double>& x, std::vector<double>& aux,
-                      const std::vector<double>& shift,
-                      const std::vector<std::vector<double>>& rotate,
+                      const std::vector<double>& shift, const Matrix& rotate,
                       bool shift_flag, bool rotate_flag);
 
 // Griewank's
 double griewank_func(const std::vector<double>& x, std::vector<double>& aux,
-                     const std::vector<double>& shift,
-                     const std::vector<std::vector<double>>& rotate,
+                     const std::vector<double>& shift, const Matrix& rotate,
                      bool shift_flag, bool rotate_flag);
 
 // Griewank-Rosenbrock
 double grie_rosen_func(const std::vector<double>& x, std::vector<double>& aux,
-                       const std::vector<double>& shift,
-                       const std::vector<std::vector<double>>& rotate,
+                       const std::vector<double>& shift, const Matrix& rotate,
                        bool shift_flag, bool rotate_flag);
 
 // HappyCat
 double happycat_func(const std::vector<double>& x, std::vector<double>& aux,
-                     const std::vector<double>& shift,
-                     const std::vector<std::vector<double>>& rotate,
+                     const std::vector<double>& shift, const Matrix& rotate,
                      bool shift_flag, bool rotate_flag);
 
 // HGBat
 double hgbat_func(const std::vector<double>& x, std::vector<double>& aux,
-                  const std::vector<double>& shift,
-                  const std::vector<std::vector<double>>& rotate,
+                  const std::vector<double>& shift, const Matrix& rotate,
                   bool shift_flag, bool rotate_flag);
 
 // Rosenbrock's
 double rosenbrock_func(const std::vector<double>& x, std::vector<double>& aux,
-                       const std::vector<double>& shift,
-                       const std::vector<std::vector<double>>& rotate,
+                       const std::vector<double>& shift, const Matrix& rotate,
                        bool shift_flag, bool rotate_flag);
 
 // Rastrigin's
 double rastrigin_func(const std::vector<double>& x, std::vector<double>& aux,
-                      const std::vector<double>& shift,
-                      const std::vector<std::vector<double>>& rotate,
+                      const std::vector<double>& shift, const Matrix& rotate,
                       bool shift_flag, bool rotate_flag);
 
 // Schwefel's
 double schwefel_func(const std::vector<double>& x, std::vector<double>& aux,
-                     const std::vector<double>& shift,
-                     const std::vector<std::vector<double>>& rotate,
+                     const std::vector<double>& shift, const Matrix& rotate,
                      bool shift_flag, bool rotate_flag);
 
 // Schaffer’s F7
 double schaffer_F7_func(const std::vector<double>& x, std::vector<double>& aux,
-                        const std::vector<double>& shift,
-                        const std::vector<std::vector<double>>& rotate,
+                        const std::vector<double>& shift, const Matrix& rotate,
                         bool shift_flag, bool rotate_flag);
 
 // Noncontinuous Rastrigin's
 double
 step_rastrigin_func(const std::vector<double>& x, std::vector<double>& aux,
-                    const std::vector<double>& shift,
-                    const std::vector<std::vector<double>>& rotate,
+                    const std::vector<double>& shift, const Matrix& rotate,
                     bool shift_flag, bool rotate_flag);
 
 // Levy
 double levy_func(const std::vector<double>& x, std::vector<double>& aux,
-                 const std::vector<double>& shift,
-                 const std::vector<std::vector<double>>& rotate,
+                 const std::vector<double>& shift, const Matrix& rotate,
                  bool shift_flag, bool rotate_flag);
 
 // ZAKHAROV
 double zakharov_func(const std::vector<double>& x, std::vector<double>& aux,
-                     const std::vector<double>& shift,
-                     const std::vector<std::vector<double>>& rotate,
+                     const std::vector<double>& shift, const Matrix& rotate,
                      bool shift_flag, bool rotate_flag);
 
 // Katsuura
 double katsuura_func(const std::vector<double>& x, std::vector<double>& aux,
-                     const std::vector<double>& shift,
-                     const std::vector<std::vector<double>>& rotate,
+                     const std::vector<double>& shift, const Matrix& rotate,
                      bool shift_flag, bool rotate_flag);
 
+/// 2^j and 2^-j for the terms j = 1..32 of Katsuura's inner sum
+struct KatsuuraScales {
+    double up[32];
+    double down[32];
+};
+inline constexpr KatsuuraScales katsuuraScales = [] {
+    auto scales = KatsuuraScales{};
+    auto scale = 1.0;
+    for (auto j = 0; j < 32; ++j) {
+        scale *= 2.0;
+        scales.up[j] = scale;
+        scales.down[j] = 1.0 / scale;
+    }
+    return scales;
+}();
+
 // Hybrid Function 1
 double hf01(const std::vector<double>& x, std::vector<double>& aux,
-            const std::vector<double>& shift,
-            const std::vector<std::vector<double>>& rotate,
+            const std::vector<double>& shift, const Matrix& rotate,
             const std::vector<std::size_t>& indices, bool shift_flag,
             bool rotate_flag);
 
 // Hybrid Function 2
 double hf02(const std::vector<double>& x, std::vector<double>& aux,
-            const std::vector<double>& shift,
-            const std::vector<std::vector<double>>& rotate,
+            const std::vector<double>& shift, const Matrix& rotate,
             const std::vector<std::size_t>& indices, bool shift_flag,
             bool rotate_flag);
 
 // Hybrid Function 3
 double hf03(const std::vector<double>& x, std::vector<double>& aux,
-            const std::vector<double>& shift,
-            const std::vector<std::vector<double>>& rotate,
+            const std::vector<double>& shift, const Matrix& rotate,
             const std::vector<std::size_t>& indices, bool shift_flag,
             bool rotate_flag);
 
 // Composition Function 1
 double cf01(const std::vector<double>& x, std::vector<double>& aux,
             const std::vector<double>& shift,
-            const std::vector<std::vector<double>>& rotate, bool rotate_flag);
+            const Matrix& rotate, bool rotate_flag);
 
 // Composition Function 1
 double cf02(const std::vector<double>& x, std::vector<double>& aux,
             const std::vector<double>& shift,
-            const std::vector<std::vector<double>>& rotate, bool rotate_flag);
+            const Matrix& rotate, bool rotate_flag);
 
 // Composition Function 1
 double cf03(const std::vector<double>& x, std::vector<double>& aux,
             const std::vector<double>& shift,
-            const std::vector<std::vector<double>>& rotate, bool rotate_flag);
+            const Matrix& rotate, bool rotate_flag);
 
 // Composition Function 1
 double cf04(const std::vector<double>& x, std::vector<double>& aux,
             const std::vector<double>& shift,
-            const std::vector<std::vector<double>>& rotate, bool rotate_flag);
+            const Matrix& rotate, bool rotate_flag);
+
+int sanity_check();
+
+/// Evaluates the neighbours of a point that differ from it in one coordinate,
+/// as hillclimbing does. reset keeps the point and the shifted and rotated
+/// image of each component, then a coordinate change moves the images along
+/// one column of the rotation: O(D) per component instead of the O(D^2)
+/// product. Unrotated Rastrigin, Zakharov and Levy only update their sums.
+/// Values match the functions above up to rounding.
+class DeltaEvaluator
+{
+  public:
+    /// Numbered like the CEC 2022 functions
+    enum class Function
+    {
+        zakharov = 1,
+        rosenbrock,
+        schaffer_F7,
+        rastrigin,
+        levy,
+        hf01,
+        hf02,
+        hf03,
+        cf01,
+        cf02,
+        cf03,
+        cf04,
+    };
+
+    DeltaEvaluator() = default;
+    /// Composition functions are always shifted
+    DeltaEvaluator(Function function, std::shared_ptr<const ProblemData> data,
+                   bool shift_flag, bool rotate_flag);
+
+    /// Makes x the point whose neighbours are evaluated, O(D^2) per rotated
+    /// component
+    void reset(const std::vector<double>& x);
+    /// Value of the point with coordinate dimension set to value. The point
+    /// itself does not change.
+    double evaluateWithCoordinateChange(std::size_t dimension, double value);
+
+  private:
+    /// Shifted by shift[offset * D, (offset + 1) * D) and rotated by the rows
+    /// from offset * D, D being the size of the point
+    struct Component {
+        std::size_t offset;
+        bool rotated;
+    };
+
+    /// Function value of changed and point
+    double evaluateChanged();
+    /// Function value from the sums, with one term replaced
+    double evaluateSums(std::size_t dimension, double value) const;
+
+    Function function = Function::zakharov;
+    std::shared_ptr<const ProblemData> data;
+    bool shiftFlag = false;
+    std::vector<Component> components;
+    /// Unrotated Rastrigin, Zakharov or Levy, evaluated from sums of terms
+    bool separable = false;
+    /// The point, holding the changed coordinate during an evaluation
+    std::vector<double> point;
+    /// M * (point - shift) of each component, D apart, before the shift rate
+    std::vector<double> images;
+    /// images of the changed point
+    std::vector<double> changed;
+    std::vector<double> aux;
+    /// Per coordinate terms of the separable functions and their sums
+    std::vector<double> terms;
+    double sums[2] = {0.0, 0.0};
+};
+
+namespace batch {
+
+// Batched entry points. points is a structure-of-arrays block of count
+// points: points[d * count + p] is coordinate d of point p, and count is
+// values.size(). Each call writes one value per point, sharing the shift,
+// rotation and component loops between all of them.
+
+/// Scratch space reused between batched calls. Buffers only grow, so calling
+/// repeatedly with the same batch size does not allocate.
+struct Buffers {
+    std::vector<double> transformed;  // shifted and rotated points
+    std::vector<double> shifted;      // shifted points, before rotation
+    std::vector<double> accumulators; // per point partial sums
+    std::vector<double> fits;         // hybrid parts and composition fits
+    std::vector<float> single;        // mixed precision shifted points
+    /// When not null, the rotation rounded to float, rows rotate.stride()
+    /// apart (ProblemData::singleRotate): the batch is shifted and rotated in
+    /// single precision, twice the lanes and half the matrix bytes, then the
+    /// kernels run in double. Values are off by up to about 1e-5 relative.
+    const float* singleRotate = nullptr;
+};
+
+void zakharov_func(const std::vector<double>& points,
+                   std::vector<double>& values, Buffers& buffers,
+                   const std::vector<double>& shift, const Matrix& rotate,
+                   bool shift_flag, bool rotate_flag);
+
+void rosenbrock_func(const std::vector<double>& points,
+                     std::vector<double>& values, Buffers& buffers,
+                     const std::vector<double>& shift, const Matrix& rotate,
+                     bool shift_flag, bool rotate_flag);
+
+void schaffer_F7_func(const std::vector<double>& points,
+                      std::vector<double>& values, Buffers& buffers,
+                      const std::vector<double>& shift, const Matrix& rotate,
+                      bool shift_flag, bool rotate_flag);
+
+void rastrigin_func(const std::vector<double>& points,
+                    std::vector<double>& values, Buffers& buffers,
+                    const std::vector<double>& shift, const Matrix& rotate,
+                    bool shift_flag, bool rotate_flag);
+
+void levy_func(const std::vector<double>& points, std::vector<double>& values,
+               Buffers& buffers, const std::vector<double>& shift,
+               const Matrix& rotate, bool shift_flag,
+               bool rotate_flag);
+
+void hf01(const std::vector<double>& points, std::vector<double>& values,
+          Buffers& buffers, const std::vector<double>& shift,
+          const Matrix& rotate,
+          const std::vector<std::size_t>& indices, bool shift_flag,
+          bool rotate_flag);
+
+void hf02(const std::vector<double>& points, std::vector<double>& values,
+          Buffers& buffers, const std::vector<double>& shift,
+          const Matrix& rotate,
+          const std::vector<std::size_t>& indices, bool shift_flag,
+          bool rotate_flag);
+
+void hf03(const std::vector<double>& points, std::vector<double>& values,
+          Buffers& buffers, const std::vector<double>& shift,
+          const Matrix& rotate,
+          const std::vector<std::size_t>& indices, bool shift_flag,
+          bool rotate_flag);
+
+void cf01(const std::vector<double>& points, std::vector<double>& values,
+          Buffers& buffers, const std::vector<double>& shift,
+          const Matrix& rotate, bool rotate_flag);
+
+void cf02(const std::vector<double>& points, std::vector<double>& values,
+          Buffers& buffers, const std::vector<double>& shift,
+          const Matrix& rotate, bool rotate_flag);
+
+void cf03(const std::vector<double>& points, std::vector<double>& values,
+          Buffers& buffers, const std::vector<double>& shift,
+          const Matrix& rotate, bool rotate_flag);
 
+void cf04(const std::vector<double>& points, std::vector<double>& values,
+          Buffers& buffers, const std::vector<double>& shift,
+          const Matrix& rotate, bool rotate_flag);
+
+/// Compares every batched function against the single point version
 int sanity_check();
 
+} // namespace batch
+
+namespace fixed {
+
+// Same functions as above, for a dimension known at compile time, so every
+// loop has a constant trip count and the hybrid parts are constants. Only
+// D = 10 and D = 20 are instantiated, the sizes with shift and rotate data.
+// The sin, cos and pow loops run on the cec22::simd kernels, other operations
+// are done in the same order as in the runtime versions.
+
+template <std::size_t D>
+double zakharov_func(const std::vector<double>& x, std::vector<double>& aux,
+                     const std::vector<double>& shift, const Matrix& rotate,
+                     bool shift_flag, bool rotate_flag);
+
+template <std::size_t D>
+double rosenbrock_func(const std::vector<double>& x, std::vector<double>& aux,
+                       const std::vector<double>& shift, const Matrix& rotate,
+                       bool shift_flag, bool rotate_flag);
+
+template <std::size_t D>
+double schaffer_F7_func(const std::vector<double>& x, std::vector<double>& aux,
+                        const std::vector<double>& shift, const Matrix& rotate,
+                        bool shift_flag, bool rotate_flag);
+
+template <std::size_t D>
+double rastrigin_func(const std::vector<double>& x, std::vector<double>& aux,
+                      const std::vector<double>& shift, const Matrix& rotate,
+                      bool shift_flag, bool rotate_flag);
+
+template <std::size_t D>
+double levy_func(const std::vector<double>& x, std::vector<double>& aux,
+                 const std::vector<double>& shift, const Matrix& rotate,
+                 bool shift_flag, bool rotate_flag);
+
+template <std::size_t D>
+double hf01(const std::vector<double>& x, std::vector<double>& aux,
+            const std::vector<double>& shift, const Matrix& rotate,
+            const std::vector<std::size_t>& indices, bool shift_flag,
+            bool rotate_flag);
+
+template <std::size_t D>
+double hf02(const std::vector<double>& x, std::vector<double>& aux,
+            const std::vector<double>& shift, const Matrix& rotate,
+            const std::vector<std::size_t>& indices, bool shift_flag,
+            bool rotate_flag);
+
+template <std::size_t D>
+double hf03(const std::vector<double>& x, std::vector<double>& aux,
+            const std::vector<double>& shift, const Matrix& rotate,
+            const std::vector<std::size_t>& indices, bool shift_flag,
+            bool rotate_flag);
+
+template <std::size_t D>
+double cf01(const std::vector<double>& x, std::vector<double>& aux,
+            const std::vector<double>& shift, const Matrix& rotate,
+            bool rotate_flag);
+
+template <std::size_t D>
+double cf02(const std::vector<double>& x, std::vector<double>& aux,
+            const std::vector<double>& shift, const Matrix& rotate,
+            bool rotate_flag);
+
+template <std::size_t D>
+double cf03(const std::vector<double>& x, std::vector<double>& aux,
+            const std::vector<double>& shift, const Matrix& rotate,
+            bool rotate_flag);
+
+template <std::size_t D>
+double cf04(const std::vector<double>& x, std::vector<double>& aux,
+            const std::vector<double>& shift, const Matrix& rotate,
+            bool rotate_flag);
+
+/// Value of function from images, its components already shifted and rotated,
+/// D apart, but not scaled by their shift rates. x is the point itself, for
+/// the weights of the compositions. Used by DeltaEvaluator.
+template <std::size_t D>
+double transformed(DeltaEvaluator::Function function, const double* images,
+                   const std::vector<double>& x,
+                   const std::vector<double>& shift,
+                   const std::vector<std::size_t>& indices);
+
+/// Compares every fixed size function against the runtime version
+int sanity_check();
+
+} // namespace fixed
+
+namespace simd {
+
+// Vectorized versions of the loops calling sin, cos and pow, and of the
+// rotation, with sse2, avx2 + fma and avx512f + avx512dq builds of each kernel.
+// The build used is picked once at startup from the cpu features, or from the
+// CEC22_ISA environment variable (sse2, avx2 or avx512) to compare them.
+// Polynomial approximations come from Cephes. Errors against the standard
+// library, checked by test/transcendentals.cpp: sin, cos and exp at most 2 ulp,
+// log 1 ulp, pow(x, 0.2) 4 ulp. Cec22Simd.cpp must be built without
+// -fassociative-math (part of -Ofast), which breaks the argument reductions.
+
+enum class Isa
+{
+    Sse2,
+    Avx2,
+    Avx512,
+};
+
+/// Whether this cpu can run the kernels built for isa
+bool supported(Isa isa);
+/// Best instruction set of this cpu
+Isa detected();
+/// Instruction set the kernels run with: CEC22_ISA if this cpu supports it,
+/// detected() otherwise, unless set
+Isa active();
+/// Forces an instruction set, throws if the cpu does not support it
+void setActive(Isa isa);
+/// sse2, avx2 or avx512, as CEC22_ISA expects them
+const char* name(Isa isa);
+
+/// sum of x[i]^2 - 10 cos(2 pi x[i])
+double rastrigin(const double* x, std::size_t n);
+/// sum1 = sum of x[i]^2, sum2 = sum of cos(2 pi x[i])
+void ackley(const double* x, std::size_t n, double& sum1, double& sum2);
+/// s = sum of x[i]^2, p = product of cos(x[i] / sqrt(1 + i))
+void griewank(const double* x, std::size_t n, double& s, double& p);
+/// sum for i < n - 1 of (w - 1)^2 (1 + 10 sin^2(pi w + 1)), w = 1 + x[i] / 4
+double levy(const double* x, std::size_t n);
+/// sum for i < n - 1 of sqrt(s) (1 + sin^2(50 s^0.2)), s = |(x[i], x[i + 1])|
+double schaffer_F7(const double* x, std::size_t n);
+/// product for i < n of (1 + (i + 1) t(x[i]))^exponent, t(x) = sum for
+/// j = 1..32 of |2^j x - round(2^j x)| / 2^j
+double katsuura(const double* x, std::size_t n, double exponent);
+
+// out[i] = f(x[i]). sin and cos for |x| <= 1e5, exp for -708 <= x <= 709,
+// log for positive normal x, pow for x >= 0 and y > 0
+void sin(const double* x, double* out, std::size_t n);
+void cos(const double* x, double* out, std::size_t n);
+void exp(const double* x, double* out, std::size_t n);
+void log(const double* x, double* out, std::size_t n);
+void pow(const double* x, double y, double* out, std::size_t n);
+
+/// out = M * in, for the n x n matrix whose rows start stride doubles apart
+/// at matrix. in is padded with zeros up to the stride, a multiple of 4. When
+/// rows is not null, out[i] is computed with matrix row rows[i].
+void rotate(const double* in, double* out, const double* matrix,
+            std::size_t stride, std::size_t n, const std::size_t* rows);
+
+} // namespace simd
+
 } // namespace cec22
\ No newline at end of file
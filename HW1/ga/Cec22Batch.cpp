@@ -0,0 +1,938 @@
+#include "Cec22.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+namespace cec22::batch {
+namespace {
+
+constexpr double PI = 3.1415926535897932384626433832795029;
+constexpr double E = 2.7182818284590452353602874713526625;
+
+/// Structure-of-arrays view: row d holds coordinate d of every point. Loops
+/// over a row are independent between points, so they vectorize.
+struct Block {
+    double* data;
+    std::size_t dimensions;
+    std::size_t count;
+
+    double* row(std::size_t d) const
+    {
+        return data + d * count;
+    }
+
+    Block rows(std::size_t begin, std::size_t end) const
+    {
+        return {row(begin), end - begin, count};
+    }
+};
+
+/// Everything a batched call works on, carved out of Buffers
+struct Batch {
+    const double* x;
+    Block z;
+    Block shifted;
+    double* accumulators;
+    double* fits;
+    /// mixed precision only, see Buffers::singleRotate
+    const float* singleRotate;
+    float* single;
+    std::size_t dimensions;
+    std::size_t count;
+};
+
+template <typename T> void grow(std::vector<T>& v, std::size_t size)
+{
+    // never shrinking, so a steady batch size stops allocating after the first
+    // call
+    if (v.size() < size) {
+        v.resize(size);
+    }
+}
+
+Batch prepare(const std::vector<double>& points, std::vector<double>& values,
+              Buffers& buffers, std::size_t parts)
+{
+    const auto count = values.size();
+    const auto dimensions = points.size() / count;
+    // kernels need at most 3 partial sums, composition weights need parts
+    grow(buffers.transformed, dimensions * count);
+    grow(buffers.shifted, dimensions * count);
+    grow(buffers.accumulators, std::max<std::size_t>(3, parts) * count);
+    grow(buffers.fits, parts * count);
+    if (buffers.singleRotate) {
+        // shifted points and one rotated row
+        grow(buffers.single, (dimensions + 1) * count);
+    }
+    return {points.data(),
+            {buffers.transformed.data(), dimensions, count},
+            {buffers.shifted.data(), dimensions, count},
+            buffers.accumulators.data(),
+            buffers.fits.data(),
+            buffers.singleRotate,
+            buffers.single.data(),
+            dimensions,
+            count};
+}
+
+/// shiftRotateTransform in single precision, with the rotation rounded to
+/// float and stride floats between its rows. Only the output is double.
+void singleShiftRotate(const Batch& batch, const Block& out,
+                       const double* shift, std::size_t stride,
+                       std::size_t firstRow, const std::size_t* indices,
+                       double shiftRate, bool shiftFlag)
+{
+    const auto n = batch.dimensions;
+    const auto count = batch.count;
+    auto* shifted = batch.single;
+    auto* row = batch.single + n * count;
+    const auto rate = static_cast<float>(shiftRate);
+    for (std::size_t j = 0; j < n; ++j) {
+        const auto* x = batch.x + j * count;
+        const auto s = shiftFlag ? static_cast<float>(shift[j]) : 0.0f;
+        auto* to = shifted + j * count;
+        for (std::size_t p = 0; p < count; ++p) {
+            to[p] = (static_cast<float>(x[p]) - s) * rate;
+        }
+    }
+    for (std::size_t k = 0; k < n; ++k) {
+        const auto source = indices ? indices[k] : k;
+        const auto* m = batch.singleRotate + (firstRow + source) * stride;
+        std::fill_n(row, count, 0.0f);
+        for (std::size_t j = 0; j < n; ++j) {
+            const auto* s = shifted + j * count;
+            const auto coefficient = m[j];
+            for (std::size_t p = 0; p < count; ++p) {
+                row[p] += s[p] * coefficient;
+            }
+        }
+        std::copy_n(row, count, out.row(k));
+    }
+}
+
+/// Same operation order as the single point transform (shift, scale, rotate),
+/// so results match it up to the summation order of the rotation. The n x n
+/// rotation starts at row firstRow of rotate. When indices is not null, output
+/// row k is input row indices[k], which applies the hybrid permutation for
+/// free.
+void shiftRotateTransform(const Batch& batch, const Block& out,
+                          const double* shift, const Matrix& rotate,
+                          std::size_t firstRow, const std::size_t* indices,
+                          double shiftRate, bool shiftFlag, bool rotateFlag)
+{
+    const auto n = batch.dimensions;
+    const auto count = batch.count;
+    const auto source = [=](auto k) { return indices ? indices[k] : k; };
+    const auto shiftScale = [&](std::size_t j, double* to) {
+        const auto* x = batch.x + j * count;
+        const auto s = shiftFlag ? shift[j] : 0.0;
+        for (std::size_t p = 0; p < count; ++p) {
+            to[p] = (x[p] - s) * shiftRate;
+        }
+    };
+
+    if (not rotateFlag) {
+        for (std::size_t k = 0; k < n; ++k) {
+            shiftScale(source(k), out.row(k));
+        }
+        return;
+    }
+
+    if (batch.singleRotate) {
+        singleShiftRotate(batch, out, shift, rotate.stride(), firstRow,
+                          indices, shiftRate, shiftFlag);
+        return;
+    }
+
+    // shifting each coordinate once, instead of once per matrix row
+    for (std::size_t j = 0; j < n; ++j) {
+        shiftScale(j, batch.shifted.row(j));
+    }
+    for (std::size_t k = 0; k < n; ++k) {
+        auto* o = out.row(k);
+        const auto* m = rotate.row(firstRow + source(k));
+        std::fill_n(o, count, 0.0);
+        for (std::size_t j = 0; j < n; ++j) {
+            const auto* s = batch.shifted.row(j);
+            const auto coefficient = m[j];
+            for (std::size_t p = 0; p < count; ++p) {
+                o[p] += s[p] * coefficient;
+            }
+        }
+    }
+}
+
+void justShift(const Block& z, double shiftRate)
+{
+    std::transform(z.data, z.data + z.dimensions * z.count, z.data,
+                   [=](auto x) { return x * shiftRate; });
+}
+
+// Kernels work on already transformed points and write one value per point
+// to f. acc has room for 3 rows of partial sums.
+
+void do_ackley_func(const Block& z, double* f, double* acc)
+{
+    auto* sum1 = acc;
+    auto* sum2 = acc + z.count;
+    std::fill_n(sum1, 2 * z.count, 0.0);
+    for (std::size_t i = 0; i < z.dimensions; ++i) {
+        const auto* x = z.row(i);
+        for (std::size_t p = 0; p < z.count; ++p) {
+            sum1[p] += x[p] * x[p];
+            sum2[p] += std::cos(2.0 * PI * x[p]);
+        }
+    }
+    const auto n = static_cast<double>(z.dimensions);
+    for (std::size_t p = 0; p < z.count; ++p) {
+        const auto s1 = -0.2 * std::sqrt(sum1[p] / n);
+        const auto s2 = sum2[p] / n;
+        f[p] = E - 20.0 * std::exp(s1) - std::exp(s2) + 20.0;
+    }
+}
+
+void do_bent_cigar_func(const Block& z, double* f)
+{
+    const auto* first = z.row(0);
+    for (std::size_t p = 0; p < z.count; ++p) {
+        f[p] = first[p] * first[p];
+    }
+    for (std::size_t i = 1; i < z.dimensions; ++i) {
+        const auto* x = z.row(i);
+        for (std::size_t p = 0; p < z.count; ++p) {
+            f[p] = f[p] + x[p] * x[p] * 1000000.0;
+        }
+    }
+}
+
+void do_discus_func(const Block& z, double* f)
+{
+    const auto* first = z.row(0);
+    for (std::size_t p = 0; p < z.count; ++p) {
+        f[p] = first[p] * first[p] * 1000000.0;
+    }
+    for (std::size_t i = 1; i < z.dimensions; ++i) {
+        const auto* x = z.row(i);
+        for (std::size_t p = 0; p < z.count; ++p) {
+            f[p] = f[p] + x[p] * x[p];
+        }
+    }
+}
+
+void do_ellips_func(const Block& z, double* f)
+{
+    const auto n = z.dimensions - 1.0;
+    std::fill_n(f, z.count, 0.0);
+    for (std::size_t i = 0; i < z.dimensions; ++i) {
+        const auto* x = z.row(i);
+        const auto coefficient = std::pow(10.0, 6.0 * i / n);
+        for (std::size_t p = 0; p < z.count; ++p) {
+            f[p] = f[p] + coefficient * x[p] * x[p];
+        }
+    }
+}
+
+void escaffer6_pair(const double* a, const double* b, double* f,
+                    std::size_t count)
+{
+    for (std::size_t p = 0; p < count; ++p) {
+        const auto xi = a[p] * a[p];
+        const auto xinext = b[p] * b[p];
+        const auto temp1 = std::sin(std::sqrt(xi + xinext));
+        const auto temp2 = 1.0 + 0.001 * (xi + xinext);
+        f[p] += 0.5 + (temp1 * temp1 - 0.5) / (temp2 * temp2);
+    }
+}
+
+void do_escaffer6_func(const Block& z, double* f)
+{
+    std::fill_n(f, z.count, 0.0);
+    for (std::size_t i = 0; i + 1 < z.dimensions; ++i) {
+        escaffer6_pair(z.row(i), z.row(i + 1), f, z.count);
+    }
+    escaffer6_pair(z.row(z.dimensions - 1), z.row(0), f, z.count);
+}
+
+void do_griewank_func(const Block& z, double* f, double* acc)
+{
+    auto* s = acc;
+    auto* product = acc + z.count;
+    std::fill_n(s, z.count, 0.0);
+    std::fill_n(product, z.count, 1.0);
+    for (std::size_t i = 0; i < z.dimensions; ++i) {
+        const auto* x = z.row(i);
+        const auto divisor = std::sqrt(1.0 + i);
+        for (std::size_t p = 0; p < z.count; ++p) {
+            s[p] += x[p] * x[p];
+            product[p] *= std::cos(x[p] / divisor);
+        }
+    }
+    for (std::size_t p = 0; p < z.count; ++p) {
+        f[p] = 1.0 + s[p] / 4000.0 - product[p];
+    }
+}
+
+void grie_rosen_pair(const double* a, const double* b, double* f,
+                     std::size_t count)
+{
+    for (std::size_t p = 0; p < count; ++p) {
+        const auto current = a[p] + 1.0;
+        const auto next = b[p] + 1.0;
+        const auto temp1 = current * current - next;
+        const auto temp2 = current - 1.0;
+        const auto temp = 100.0 * temp1 * temp1 + temp2 * temp2;
+        f[p] += (temp * temp) / 4000.0 - std::cos(temp) + 1.0;
+    }
+}
+
+void do_grie_rosen_func(const Block& z, double* f)
+{
+    std::fill_n(f, z.count, 0.0);
+    for (std::size_t i = 0; i + 1 < z.dimensions; ++i) {
+        grie_rosen_pair(z.row(i), z.row(i + 1), f, z.count);
+    }
+    grie_rosen_pair(z.row(z.dimensions - 1), z.row(0), f, z.count);
+}
+
+/// sum of (x - 1) and of (x - 1)^2, shared by HappyCat and HGBat
+void shiftedSums(const Block& z, double* sum_y, double* r2)
+{
+    std::fill_n(sum_y, z.count, 0.0);
+    std::fill_n(r2, z.count, 0.0);
+    for (std::size_t i = 0; i < z.dimensions; ++i) {
+        const auto* x = z.row(i);
+        for (std::size_t p = 0; p < z.count; ++p) {
+            const auto aux = x[p] - 1.0;
+            sum_y[p] += aux;
+            r2[p] += aux * aux;
+        }
+    }
+}
+
+void do_happycat_func(const Block& z, double* f, double* acc)
+{
+    auto* sum_y = acc;
+    auto* r2 = acc + z.count;
+    shiftedSums(z, sum_y, r2);
+    const auto n = static_cast<double>(z.dimensions);
+    for (std::size_t p = 0; p < z.count; ++p) {
+        f[p] = std::pow(std::abs(r2[p] - n), 2 * 1.0 / 8.0) +
+               (0.5 * r2[p] + sum_y[p]) / n + 0.5;
+    }
+}
+
+void do_hgbat_func(const Block& z, double* f, double* acc)
+{
+    auto* sum_y = acc;
+    auto* r2 = acc + z.count;
+    shiftedSums(z, sum_y, r2);
+    const auto n = static_cast<double>(z.dimensions);
+    for (std::size_t p = 0; p < z.count; ++p) {
+        f[p] = std::pow(std::fabs(r2[p] * r2[p] - sum_y[p] * sum_y[p]),
+                        2.0 * 1.0 / 4.0) +
+               (0.5 * r2[p] + sum_y[p]) / n + 0.5;
+    }
+}
+
+void do_rosenbrock_func(const Block& z, double* f)
+{
+    std::fill_n(f, z.count, 0.0);
+    for (std::size_t i = 0; i + 1 < z.dimensions; ++i) {
+        const auto* x = z.row(i);
+        const auto* next = z.row(i + 1);
+        for (std::size_t p = 0; p < z.count; ++p) {
+            const auto temp = x[p] + 1.0;
+            const auto temp1 = temp * temp - next[p] - 1.0;
+            f[p] += 100.0 * temp1 * temp1 + x[p] * x[p];
+        }
+    }
+}
+
+void do_rastrigin_func(const Block& z, double* f)
+{
+    std::fill_n(f, z.count, z.dimensions * 10.0);
+    for (std::size_t i = 0; i < z.dimensions; ++i) {
+        const auto* x = z.row(i);
+        for (std::size_t p = 0; p < z.count; ++p) {
+            f[p] = f[p] + x[p] * x[p] - 10.0 * std::cos(2.0 * PI * x[p]);
+        }
+    }
+}
+
+void do_schwefel_func(const Block& z, double* f, double* acc)
+{
+    const auto n = static_cast<double>(z.dimensions);
+    std::fill_n(acc, z.count, 0.0);
+    for (std::size_t i = 0; i < z.dimensions; ++i) {
+        const auto* x = z.row(i);
+        for (std::size_t p = 0; p < z.count; ++p) {
+            const auto xi = x[p] + 4.209687462275036e+002;
+            if (xi > 500.0) {
+                const auto temp1 =
+                    (500.0 - std::fmod(xi, 500)) *
+                    std::sin(std::sqrt(500.0 - std::fmod(xi, 500)));
+                const auto temp2 = (xi - 500.0) / 100.0;
+                acc[p] = acc[p] - temp1 + temp2 * temp2 / n;
+            } else if (xi < -500.0) {
+                const auto temp1 =
+                    (-500.0 + std::fmod(std::fabs(xi), 500)) *
+                    std::sin(std::sqrt(500.0 - std::fmod(std::fabs(xi), 500)));
+                const auto temp2 = (xi + 500.0) / 100.0;
+                acc[p] = acc[p] - temp1 + temp2 * temp2 / n;
+            } else {
+                acc[p] = acc[p] - xi * std::sin(std::sqrt(std::fabs(xi)));
+            }
+        }
+    }
+    for (std::size_t p = 0; p < z.count; ++p) {
+        f[p] = 4.189828872724338e+002 * n + acc[p];
+    }
+}
+
+void do_schaffer_F7_func(const Block& z, double* f)
+{
+    std::fill_n(f, z.count, 0.0);
+    for (std::size_t i = 0; i + 1 < z.dimensions; ++i) {
+        const auto* x = z.row(i);
+        const auto* next = z.row(i + 1);
+        for (std::size_t p = 0; p < z.count; ++p) {
+            const auto si = std::sqrt(x[p] * x[p] + next[p] * next[p]);
+            const auto temp = std::sin(50.0 * std::pow(si, 0.2));
+            const auto sqrtsi = std::sqrt(si);
+            f[p] += sqrtsi + sqrtsi * temp * temp;
+        }
+    }
+    const auto n = z.dimensions - 1.0;
+    for (std::size_t p = 0; p < z.count; ++p) {
+        f[p] = f[p] * f[p] / n / n;
+    }
+}
+
+void do_levy_func(const Block& z, double* f, double* acc)
+{
+    const auto w = [](auto elem) { return 1.0 + (elem - 0.0) / 4.0; };
+    auto* term2 = acc;
+    std::fill_n(term2, z.count, 0.0);
+    for (std::size_t i = 0; i + 1 < z.dimensions; ++i) {
+        const auto* x = z.row(i);
+        for (std::size_t p = 0; p < z.count; ++p) {
+            const auto wi = w(x[p]);
+            const auto temp = std::sin(PI * wi + 1.0);
+            term2[p] = term2[p] +
+                       (wi - 1.0) * (wi - 1.0) * (1.0 + 10.0 * temp * temp);
+        }
+    }
+    const auto* first = z.row(0);
+    const auto* last = z.row(z.dimensions - 1);
+    for (std::size_t p = 0; p < z.count; ++p) {
+        const auto term1 = std::sin(PI * w(first[p]));
+        const auto wn = w(last[p]);
+        const auto temp = std::sin(2.0 * PI * wn);
+        const auto term3 = (wn - 1.0) * (wn - 1.0) * (1.0 + temp * temp);
+        f[p] = term1 * term1 + term2[p] + term3;
+    }
+}
+
+void do_zakharov_func(const Block& z, double* f, double* acc)
+{
+    auto* sum1 = acc;
+    auto* sum2 = acc + z.count;
+    std::fill_n(sum1, 2 * z.count, 0.0);
+    for (std::size_t i = 0; i < z.dimensions; ++i) {
+        const auto* x = z.row(i);
+        for (std::size_t p = 0; p < z.count; ++p) {
+            sum1[p] += x[p] * x[p];
+            sum2[p] += 0.5 * (i + 1) * x[p];
+        }
+    }
+    for (std::size_t p = 0; p < z.count; ++p) {
+        const auto s2 = sum2[p];
+        f[p] = sum1[p] + s2 * s2 + s2 * s2 * s2 * s2;
+    }
+}
+
+void do_katsuura_func(const Block& z, double* f, double* acc)
+{
+    const auto size = static_cast<double>(z.dimensions);
+    const auto temp3 = std::pow(size, 1.2);
+    auto* temp = acc;
+    std::fill_n(f, z.count, 1.0);
+    for (std::size_t i = 0; i < z.dimensions; ++i) {
+        const auto* x = z.row(i);
+        std::fill_n(temp, z.count, 0.0);
+        for (auto j = 0; j < 32; ++j) {
+            const auto up = katsuuraScales.up[j];
+            const auto down = katsuuraScales.down[j];
+            for (std::size_t p = 0; p < z.count; ++p) {
+                const auto temp2 = up * x[p];
+                temp[p] += std::fabs(temp2 - std::floor(temp2 + 0.5)) * down;
+            }
+        }
+        for (std::size_t p = 0; p < z.count; ++p) {
+            f[p] *= std::pow(1.0 + (i + 1) * temp[p], 10.0 / temp3);
+        }
+    }
+    const auto temp1 = 10.0 / size / size;
+    for (std::size_t p = 0; p < z.count; ++p) {
+        f[p] = f[p] * temp1 - temp1;
+    }
+}
+
+/// Kernels of the composition components, each with its own shift rate
+enum class Kernel
+{
+    BentCigar,
+    Discus,
+    Ellips,
+    Escaffer6,
+    Griewank,
+    HGBat,
+    Rastrigin,
+    Rosenbrock,
+    Schwefel,
+};
+
+struct Component {
+    Kernel kernel;
+    double lambda;
+    double bias;
+    int delta;
+    bool rotate;
+};
+
+double shiftRateOf(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Griewank:
+        return 600.0 / 100.0;
+    case Kernel::HGBat:
+        return 5.0 / 100.0;
+    case Kernel::Rastrigin:
+        return 5.12 / 100.0;
+    case Kernel::Rosenbrock:
+        return 2.048 / 100.0;
+    case Kernel::Schwefel:
+        return 1000.0 / 100.0;
+    default:
+        return 1.0;
+    }
+}
+
+void runKernel(Kernel kernel, const Block& z, double* f, double* acc)
+{
+    switch (kernel) {
+    case Kernel::BentCigar:
+        return do_bent_cigar_func(z, f);
+    case Kernel::Discus:
+        return do_discus_func(z, f);
+    case Kernel::Ellips:
+        return do_ellips_func(z, f);
+    case Kernel::Escaffer6:
+        return do_escaffer6_func(z, f);
+    case Kernel::Griewank:
+        return do_griewank_func(z, f, acc);
+    case Kernel::HGBat:
+        return do_hgbat_func(z, f, acc);
+    case Kernel::Rastrigin:
+        return do_rastrigin_func(z, f);
+    case Kernel::Rosenbrock:
+        return do_rosenbrock_func(z, f);
+    case Kernel::Schwefel:
+        return do_schwefel_func(z, f, acc);
+    }
+}
+
+template <std::size_t Size>
+void composition(const std::vector<double>& points,
+                 std::vector<double>& values, Buffers& buffers,
+                 const std::vector<double>& shift, const Matrix& rotate,
+                 bool rotateFlag, const std::array<Component, Size>& components)
+{
+    const auto batch = prepare(points, values, buffers, Size);
+    const auto n = batch.dimensions;
+    const auto count = batch.count;
+
+    for (std::size_t i = 0; i < Size; ++i) {
+        const auto& component = components[i];
+        auto* fit = batch.fits + i * count;
+        shiftRotateTransform(batch, batch.z, shift.data() + i * n, rotate,
+                             i * n, nullptr,
+                             shiftRateOf(component.kernel), true,
+                             component.rotate and rotateFlag);
+        runKernel(component.kernel, batch.z, fit, batch.accumulators);
+        for (std::size_t p = 0; p < count; ++p) {
+            fit[p] = fit[p] * component.lambda + component.bias;
+        }
+    }
+
+    // weights are computed from the unshifted points, for all components at
+    // once, after the kernels are done with the accumulators
+    auto* w = batch.accumulators;
+    for (std::size_t i = 0; i < Size; ++i) {
+        auto* wi = w + i * count;
+        const auto delta = components[i].delta;
+        std::fill_n(wi, count, 0.0);
+        for (std::size_t j = 0; j < n; ++j) {
+            const auto* x = batch.x + j * count;
+            const auto s = shift[i * n + j];
+            for (std::size_t p = 0; p < count; ++p) {
+                const auto temp = x[p] - s;
+                wi[p] += temp * temp;
+            }
+        }
+        for (std::size_t p = 0; p < count; ++p) {
+            // 1.0e99 (INF) only when x is the shift
+            wi[p] = wi[p] != 0.0 ? std::sqrt(1.0 / wi[p]) *
+                                       std::exp(-wi[p] / 2.0 / n / delta /
+                                                delta)
+                                 : 1.0e99;
+        }
+    }
+
+    for (std::size_t p = 0; p < count; ++p) {
+        auto w_max = 0.0;
+        auto w_sum = 0.0;
+        for (std::size_t i = 0; i < Size; ++i) {
+            w_max = std::max(w_max, w[i * count + p]);
+            w_sum += w[i * count + p];
+        }
+        auto value = 0.0;
+        if (w_max == 0.0) [[unlikely]] {
+            for (std::size_t i = 0; i < Size; ++i) {
+                value += batch.fits[i * count + p];
+            }
+            value /= Size;
+        } else [[likely]] {
+            for (std::size_t i = 0; i < Size; ++i) {
+                value += w[i * count + p] / w_sum * batch.fits[i * count + p];
+            }
+        }
+        values[p] = value;
+    }
+}
+
+/// Sums the count values of each of the first parts rows of fits into values
+void sumParts(const Batch& batch, std::vector<double>& values,
+              std::size_t parts)
+{
+    std::copy_n(batch.fits, batch.count, values.begin());
+    for (std::size_t i = 1; i < parts; ++i) {
+        const auto* part = batch.fits + i * batch.count;
+        for (std::size_t p = 0; p < batch.count; ++p) {
+            values[p] += part[p];
+        }
+    }
+}
+
+} // namespace
+
+void zakharov_func(const std::vector<double>& points,
+                   std::vector<double>& values, Buffers& buffers,
+                   const std::vector<double>& shift, const Matrix& rotate,
+                   bool shiftFlag, bool rotateFlag)
+{
+    const auto batch = prepare(points, values, buffers, 0);
+    shiftRotateTransform(batch, batch.z, shift.data(), rotate, 0, nullptr,
+                         1.0, shiftFlag, rotateFlag);
+    do_zakharov_func(batch.z, values.data(), batch.accumulators);
+}
+
+void rosenbrock_func(const std::vector<double>& points,
+                     std::vector<double>& values, Buffers& buffers,
+                     const std::vector<double>& shift, const Matrix& rotate,
+                     bool shiftFlag, bool rotateFlag)
+{
+    const auto batch = prepare(points, values, buffers, 0);
+    shiftRotateTransform(batch, batch.z, shift.data(), rotate, 0, nullptr,
+                         2.048 / 100.0, shiftFlag, rotateFlag);
+    do_rosenbrock_func(batch.z, values.data());
+}
+
+void schaffer_F7_func(const std::vector<double>& points,
+                      std::vector<double>& values, Buffers& buffers,
+                      const std::vector<double>& shift, const Matrix& rotate,
+                      bool shiftFlag, [[maybe_unused]] bool rotateFlag)
+{
+    // not rotated, same as the single point version
+    const auto batch = prepare(points, values, buffers, 0);
+    shiftRotateTransform(batch, batch.z, shift.data(), rotate, 0, nullptr,
+                         1.0, shiftFlag, false);
+    do_schaffer_F7_func(batch.z, values.data());
+}
+
+void rastrigin_func(const std::vector<double>& points,
+                    std::vector<double>& values, Buffers& buffers,
+                    const std::vector<double>& shift, const Matrix& rotate,
+                    bool shiftFlag, bool rotateFlag)
+{
+    const auto batch = prepare(points, values, buffers, 0);
+    shiftRotateTransform(batch, batch.z, shift.data(), rotate, 0, nullptr,
+                         5.12 / 100.0, shiftFlag, rotateFlag);
+    do_rastrigin_func(batch.z, values.data());
+}
+
+void levy_func(const std::vector<double>& points, std::vector<double>& values,
+               Buffers& buffers, const std::vector<double>& shift,
+               const Matrix& rotate, bool shiftFlag,
+               bool rotateFlag)
+{
+    const auto batch = prepare(points, values, buffers, 0);
+    shiftRotateTransform(batch, batch.z, shift.data(), rotate, 0, nullptr,
+                         1.0, shiftFlag, rotateFlag);
+    do_levy_func(batch.z, values.data(), batch.accumulators);
+}
+
+void hf01(const std::vector<double>& points, std::vector<double>& values,
+          Buffers& buffers, const std::vector<double>& shift,
+          const Matrix& rotate,
+          const std::vector<std::size_t>& indices, bool shiftFlag,
+          bool rotateFlag)
+{
+    // [0.4, 0.4, 0.2]
+    const auto batch = prepare(points, values, buffers, 3);
+    const auto& z = batch.z;
+    shiftRotateTransform(batch, z, shift.data(), rotate, 0,
+                         indices.data(), 1.0, shiftFlag, rotateFlag);
+
+    const auto limit = static_cast<std::size_t>(std::ceil(0.4 * z.dimensions));
+    const auto range2 = z.rows(limit, 2 * limit);
+    const auto range3 = z.rows(2 * limit, z.dimensions);
+    justShift(range2, 5.0 / 100.0);
+    justShift(range3, 5.12 / 100.0);
+
+    const auto count = batch.count;
+    do_bent_cigar_func(z.rows(0, limit), batch.fits);
+    do_hgbat_func(range2, batch.fits + count, batch.accumulators);
+    do_rastrigin_func(range3, batch.fits + 2 * count);
+    sumParts(batch, values, 3);
+}
+
+void hf02(const std::vector<double>& points, std::vector<double>& values,
+          Buffers& buffers, const std::vector<double>& shift,
+          const Matrix& rotate,
+          const std::vector<std::size_t>& indices, bool shiftFlag,
+          bool rotateFlag)
+{
+    // [0.1, 0.2, 0.2, 0.2, 0.1, 0.2]
+    const auto batch = prepare(points, values, buffers, 6);
+    const auto& z = batch.z;
+    shiftRotateTransform(batch, z, shift.data(), rotate, 0,
+                         indices.data(), 1.0, shiftFlag, rotateFlag);
+
+    const auto limit1 = static_cast<std::size_t>(std::ceil(0.1 * z.dimensions));
+    const auto limit2 = static_cast<std::size_t>(std::ceil(0.2 * z.dimensions));
+    const auto margin1 = limit1;
+    const auto margin2 = margin1 + limit2;
+    const auto margin3 = margin2 + limit2;
+    const auto margin4 = margin3 + limit2;
+    const auto margin5 = margin4 + limit1;
+
+    const auto count = batch.count;
+    // the single point version runs Schaffer F7 on a copy of the first
+    // (unscaled) values instead of the last 0.2, so it goes first
+    do_schaffer_F7_func(z.rows(0, z.dimensions - margin5),
+                        batch.fits + 5 * count);
+
+    const auto range1 = z.rows(0, margin1);
+    const auto range2 = z.rows(margin1, margin2);
+    const auto range4 = z.rows(margin3, margin4);
+    const auto range5 = z.rows(margin4, margin5);
+    justShift(range1, 5.0 / 100.0);
+    justShift(range2, 5.0 / 100.0);
+    justShift(range4, 5.12 / 100.0);
+    justShift(range5, 1000.0 / 100.0);
+
+    do_hgbat_func(range1, batch.fits, batch.accumulators);
+    do_katsuura_func(range2, batch.fits + count, batch.accumulators);
+    do_ackley_func(z.rows(margin2, margin3), batch.fits + 2 * count,
+                   batch.accumulators);
+    do_rastrigin_func(range4, batch.fits + 3 * count);
+    do_schwefel_func(range5, batch.fits + 4 * count, batch.accumulators);
+    sumParts(batch, values, 6);
+}
+
+void hf03(const std::vector<double>& points, std::vector<double>& values,
+          Buffers& buffers, const std::vector<double>& shift,
+          const Matrix& rotate,
+          const std::vector<std::size_t>& indices, bool shiftFlag,
+          bool rotateFlag)
+{
+    //  [0.3, 0.2, 0.2, 0.1, 0.2]
+    const auto batch = prepare(points, values, buffers, 5);
+    const auto& z = batch.z;
+    shiftRotateTransform(batch, z, shift.data(), rotate, 0,
+                         indices.data(), 1.0, shiftFlag, rotateFlag);
+
+    const auto limit1 = static_cast<std::size_t>(std::ceil(0.1 * z.dimensions));
+    const auto limit2 = static_cast<std::size_t>(std::ceil(0.2 * z.dimensions));
+    const auto limit3 = static_cast<std::size_t>(std::ceil(0.3 * z.dimensions));
+    const auto margin1 = limit3;
+    const auto margin2 = margin1 + limit2;
+    const auto margin3 = margin2 + limit2;
+    const auto margin4 = margin3 + limit1;
+
+    const auto range1 = z.rows(0, margin1);
+    const auto range2 = z.rows(margin1, margin2);
+    const auto range3 = z.rows(margin2, margin3);
+    const auto range4 = z.rows(margin3, margin4);
+    justShift(range1, 5.0 / 100.0);
+    justShift(range2, 5.0 / 100.0);
+    justShift(range3, 5.0 / 100.0);
+    justShift(range4, 1000.0 / 100.0);
+
+    const auto count = batch.count;
+    do_katsuura_func(range1, batch.fits, batch.accumulators);
+    do_happycat_func(range2, batch.fits + count, batch.accumulators);
+    do_grie_rosen_func(range3, batch.fits + 2 * count);
+    do_schwefel_func(range4, batch.fits + 3 * count, batch.accumulators);
+    do_ackley_func(z.rows(margin4, z.dimensions), batch.fits + 4 * count,
+                   batch.accumulators);
+    sumParts(batch, values, 5);
+}
+
+void cf01(const std::vector<double>& points, std::vector<double>& values,
+          Buffers& buffers, const std::vector<double>& shift,
+          const Matrix& rotate, bool rotateFlag)
+{
+    // lambda in their implementation is 1, 1e-6, 1e-26, 1e-6, 1e-6
+    composition<5>(points, values, buffers, shift, rotate, rotateFlag,
+                   {{
+                       {Kernel::Rosenbrock, 1.0, 0.0, 10, true},
+                       {Kernel::Ellips, 1e-6, 200, 20, true},
+                       {Kernel::BentCigar, 1e-26, 300, 30, true},
+                       {Kernel::Discus, 1e-6, 100, 40, true},
+                       {Kernel::Ellips, 1e-6, 400, 50, false}, // ?? why false
+                   }});
+}
+
+void cf02(const std::vector<double>& points, std::vector<double>& values,
+          Buffers& buffers, const std::vector<double>& shift,
+          const Matrix& rotate, bool rotateFlag)
+{
+    composition<3>(points, values, buffers, shift, rotate, rotateFlag,
+                   {{
+                       {Kernel::Schwefel, 1.0, 0.0, 20, false}, // ?? why false
+                       {Kernel::Rastrigin, 1.0, 200, 10, true},
+                       {Kernel::HGBat, 1.0, 100, 10, true},
+                   }});
+}
+
+void cf03(const std::vector<double>& points, std::vector<double>& values,
+          Buffers& buffers, const std::vector<double>& shift,
+          const Matrix& rotate, bool rotateFlag)
+{
+    composition<5>(points, values, buffers, shift, rotate, rotateFlag,
+                   {{
+                       {Kernel::Escaffer6, 10000.0 / 2e+7, 0.0, 20, true},
+                       {Kernel::Schwefel, 1.0, 200, 20, true},
+                       {Kernel::Griewank, 1000 / 100, 300, 30, true},
+                       {Kernel::Rosenbrock, 1, 400, 30, true},
+                       {Kernel::Rastrigin, 10000 / 1e+3, 200, 20, true},
+                   }});
+}
+
+void cf04(const std::vector<double>& points, std::vector<double>& values,
+          Buffers& buffers, const std::vector<double>& shift,
+          const Matrix& rotate, bool rotateFlag)
+{
+    composition<6>(points, values, buffers, shift, rotate, rotateFlag,
+                   {{
+                       {Kernel::HGBat, 10, 0.0, 10, true},
+                       {Kernel::Rastrigin, 10, 300, 20, true},
+                       {Kernel::Schwefel, 2.5, 500, 30, true},
+                       {Kernel::BentCigar, 1e-26, 100, 40, true},
+                       {Kernel::Ellips, 1e-6, 400, 50, true},
+                       {Kernel::Escaffer6, 5e-4, 200, 60, true},
+                   }});
+}
+
+int sanity_check()
+{
+    constexpr std::size_t dimensions = 10;
+    constexpr std::size_t count = 7;
+
+    std::mt19937_64 gen{42};
+    std::uniform_real_distribution<double> random{-100.0, 100.0};
+
+    auto shift = std::vector<double>(6 * dimensions);
+    std::generate(shift.begin(), shift.end(), [&]() { return random(gen); });
+    auto rotate = Matrix{6 * dimensions, dimensions};
+    for (std::size_t i = 0; i < rotate.rows(); ++i) {
+        std::generate_n(rotate.row(i), dimensions,
+                        [&]() { return random(gen) / 100.0; });
+    }
+    auto indices = std::vector<std::size_t>(dimensions);
+    std::iota(indices.begin(), indices.end(), 0);
+    std::shuffle(indices.begin(), indices.end(), gen);
+
+    auto points = std::vector<double>(dimensions * count);
+    std::generate(points.begin(), points.end(), [&]() { return random(gen); });
+    auto x = std::vector<double>(dimensions);
+    auto aux = std::vector<double>(dimensions);
+    auto values = std::vector<double>(count);
+    auto buffers = Buffers{};
+
+    auto ok = 1;
+    const auto check = [&](const char* name, auto&& single, auto&& batched) {
+        batched();
+        auto maxError = 0.0;
+        for (std::size_t p = 0; p < count; ++p) {
+            for (std::size_t d = 0; d < dimensions; ++d) {
+                x[d] = points[d * count + p];
+            }
+            const auto expected = single();
+            const auto error = std::fabs(expected - values[p]) /
+                               std::max(1.0, std::fabs(expected));
+            maxError = std::max(maxError, error);
+        }
+        std::cout << name << " max relative error = " << maxError << '\n';
+        if (maxError > 1e-12) {
+            ok = 0;
+        }
+    };
+
+    const auto checkBasic = [&](const char* name, auto single, auto batched) {
+        for (const auto flag : {false, true}) {
+            check(
+                name,
+                [&] { return single(x, aux, shift, rotate, flag, flag); },
+                [&] {
+                    batched(points, values, buffers, shift, rotate, flag, flag);
+                });
+        }
+    };
+    const auto checkHybrid = [&](const char* name, auto single, auto batched) {
+        check(
+            name,
+            [&] { return single(x, aux, shift, rotate, indices, true, true); },
+            [&] {
+                batched(points, values, buffers, shift, rotate, indices, true,
+                        true);
+            });
+    };
+    const auto checkComposition = [&](const char* name, auto single, auto batched) {
+        check(
+            name, [&] { return single(x, aux, shift, rotate, true); },
+            [&] { batched(points, values, buffers, shift, rotate, true); });
+    };
+
+    checkBasic("zakharov_func", cec22::zakharov_func, zakharov_func);
+    checkBasic("rosenbrock_func", cec22::rosenbrock_func, rosenbrock_func);
+    checkBasic("schaffer_F7_func", cec22::schaffer_F7_func, schaffer_F7_func);
+    checkBasic("rastrigin_func", cec22::rastrigin_func, rastrigin_func);
+    checkBasic("levy_func", cec22::levy_func, levy_func);
+    checkHybrid("hf01", cec22::hf01, hf01);
+    checkHybrid("hf02", cec22::hf02, hf02);
+    checkHybrid("hf03", cec22::hf03, hf03);
+    checkComposition("cf01", cec22::cf01, cf01);
+    checkComposition("cf02", cec22::cf02, cf02);
+    checkComposition("cf03", cec22::cf03, cf03);
+    checkComposition("cf04", cec22::cf04, cf04);
+    return ok;
+}
+
+} // namespace cec22::batch
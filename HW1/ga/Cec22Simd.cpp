@@ -0,0 +1,801 @@
+#include "Cec22.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace cec22::simd {
+namespace {
+
+constexpr double PI = 3.1415926535897932384626433832795029;
+
+// SSE2 is part of x86-64, so vec2 code runs everywhere. vec4 code is only
+// called from functions compiled for avx2 and fma, vec8 code from functions
+// compiled for avx512f and avx512dq. The rotation uses vec4 in the sse2 build
+// too, as the row stride of Matrix is a multiple of 4.
+using vec2 = double __attribute__((vector_size(2 * sizeof(double))));
+using vec4 = double __attribute__((vector_size(4 * sizeof(double))));
+using vec8 = double __attribute__((vector_size(8 * sizeof(double))));
+
+/// Integer types matching a vector of doubles: quadrants are 32 bit lanes,
+/// bit patterns are 64 bit lanes
+template <typename V> struct Lanes;
+template <> struct Lanes<vec2> {
+    static constexpr std::size_t count = 2;
+    using int32 = std::int32_t __attribute__((vector_size(2 * 4)));
+    using int64 = std::int64_t __attribute__((vector_size(2 * 8)));
+};
+template <> struct Lanes<vec4> {
+    static constexpr std::size_t count = 4;
+    using int32 = std::int32_t __attribute__((vector_size(4 * 4)));
+    using int64 = std::int64_t __attribute__((vector_size(4 * 8)));
+};
+template <> struct Lanes<vec8> {
+    static constexpr std::size_t count = 8;
+    using int32 = std::int32_t __attribute__((vector_size(8 * 4)));
+    using int64 = std::int64_t __attribute__((vector_size(8 * 8)));
+};
+
+// Vectors are passed by reference and results are written to out parameters:
+// passing 32 byte vectors by value to functions without avx changes the ABI.
+// Everything is always inlined into the callers compiled for each isa.
+
+template <typename V>
+[[gnu::always_inline]] inline void load(V& v, const double* p)
+{
+    std::memcpy(&v, p, sizeof(v));
+}
+
+/// Loads the first count values of p, the other lanes get fill
+template <typename V>
+[[gnu::always_inline]] inline void loadPartial(V& v, const double* p,
+                                               std::size_t count, double fill)
+{
+    double lanes[Lanes<V>::count];
+    for (std::size_t k = 0; k < Lanes<V>::count; ++k) {
+        lanes[k] = k < count ? p[k] : fill;
+    }
+    std::memcpy(&v, lanes, sizeof(v));
+}
+
+template <typename V> [[gnu::always_inline]] inline double sum(const V& v)
+{
+    auto s = 0.0;
+    for (std::size_t k = 0; k < Lanes<V>::count; ++k) {
+        s += v[k];
+    }
+    return s;
+}
+
+template <typename V> [[gnu::always_inline]] inline double product(const V& v)
+{
+    auto p = 1.0;
+    for (std::size_t k = 0; k < Lanes<V>::count; ++k) {
+        p *= v[k];
+    }
+    return p;
+}
+
+template <typename V> [[gnu::always_inline]] inline void sqrt(V& out, const V& x)
+{
+    for (std::size_t k = 0; k < Lanes<V>::count; ++k) {
+        out[k] = __builtin_sqrt(x[k]);
+    }
+}
+
+/// out = nearest integer of x (ties away from zero), for |x| < 2^31
+template <typename V>
+[[gnu::always_inline]] inline void round(typename Lanes<V>::int32& out,
+                                         const V& x)
+{
+    using int32 = typename Lanes<V>::int32;
+    const V half = x < 0.0 ? V{} - 0.5 : V{} + 0.5;
+    // conversion truncates
+    out = __builtin_convertvector(x + half, int32);
+}
+
+// sin and cos: Cephes sin.c. The argument is reduced by multiples of pi/2
+// with a 3 part Cody-Waite split of pi/2, then one of two minimax
+// polynomials is evaluated on [-pi/4, pi/4]. Valid for |x| <= 1e5.
+
+/// sin(z + q * pi/2), for |z| <= pi/4
+template <typename V>
+[[gnu::always_inline]] inline void sinQuadrant(V& out, const V& z,
+                                               const typename Lanes<V>::int32& q)
+{
+    const auto zz = z * z;
+    const auto s =
+        z + z * zz *
+                (((((1.58962301576546568060E-10 * zz -
+                     2.50507477628578072866E-8) *
+                        zz +
+                    2.75573136213857245213E-6) *
+                       zz -
+                   1.98412698295895385996E-4) *
+                      zz +
+                  8.33333333332211858878E-3) *
+                     zz -
+                 1.66666666666666307295E-1);
+    const auto c =
+        1.0 - 0.5 * zz +
+        zz * zz *
+            (((((-1.13585365213876817300E-11 * zz +
+                 2.08757008419747316778E-9) *
+                    zz -
+                2.75573141792967388112E-7) *
+                   zz +
+               2.48015872888517045348E-5) *
+                  zz -
+              1.38888888888730564116E-3) *
+                 zz +
+             4.16666666666665929218E-2);
+    // sin(z + pi/2) = cos(z), sin(z + pi) = -sin(z)
+    const auto odd = __builtin_convertvector(q & 1, V) != 0.0;
+    const auto negative = __builtin_convertvector(q & 2, V) != 0.0;
+    const V value = odd ? c : s;
+    out = negative ? -value : value;
+}
+
+/// z = x - q * pi/2 and q = nearest integer of x / (pi/2)
+template <typename V>
+[[gnu::always_inline]] inline void reduce(V& z, typename Lanes<V>::int32& q,
+                                          const V& x)
+{
+    round(q, x * (2.0 / PI));
+    const auto y = __builtin_convertvector(q, V);
+    z = ((x - y * 1.57079625129699707031E0) - y * 7.54978941586159635335E-8) -
+        y * 5.39030285815811905290E-15;
+}
+
+template <typename V> [[gnu::always_inline]] inline void sin(V& out, const V& x)
+{
+    V z;
+    typename Lanes<V>::int32 q;
+    reduce(z, q, x);
+    sinQuadrant(out, z, q);
+}
+
+template <typename V> [[gnu::always_inline]] inline void cos(V& out, const V& x)
+{
+    V z;
+    typename Lanes<V>::int32 q;
+    reduce(z, q, x);
+    // cos(x) = sin(x + pi/2)
+    sinQuadrant(out, z, q + 1);
+}
+
+// exp: Cephes exp.c. x = n ln2 + r with a 2 part split of ln2 and |r| <= ln2 / 2,
+// exp(r) from a Pade approximation, 2^n built in the exponent bits. Valid for
+// -708 <= x <= 709.
+template <typename V> [[gnu::always_inline]] inline void exp(V& out, const V& x)
+{
+    using int64 = typename Lanes<V>::int64;
+    typename Lanes<V>::int32 n;
+    round(n, x * 1.4426950408889634073599);
+    const auto px = __builtin_convertvector(n, V);
+    auto r = x - px * 6.93145751953125E-1;
+    r = r - px * 1.42860682030941723212E-6;
+    const auto rr = r * r;
+    const auto p =
+        r * ((1.26177193074810590878E-4 * rr + 3.02994407707441961300E-2) * rr +
+             9.99999999999999999910E-1);
+    const auto q = ((3.00198505138664455042E-6 * rr + 2.52448340349684104192E-3) *
+                        rr +
+                    2.27265548208155028766E-1) *
+                       rr +
+                   2.00000000000000000009E0;
+    const auto e = 1.0 + 2.0 * (p / (q - p));
+    // 2^n, n + 1023 is the biased exponent
+    const auto biased = __builtin_convertvector(n, int64) + 1023;
+    out = e * __builtin_bit_cast(V, biased << 52);
+}
+
+// log: Cephes log.c. x = m 2^e with sqrt(1/2) <= m < sqrt(2), log(m) from a
+// rational approximation in m - 1, e ln2 added in 2 parts. Valid for positive
+// normal numbers.
+template <typename V> [[gnu::always_inline]] inline void log(V& out, const V& x)
+{
+    using int64 = typename Lanes<V>::int64;
+    const auto bits = __builtin_bit_cast(int64, x);
+    // m in [0.5, 1) and exponent + 1022, like frexp
+    const int64 mantissa = (bits & 0x000fffffffffffff) | 0x3fe0000000000000;
+    const int64 exponent = ((bits >> 52) & 0x7ff) | 0x4330000000000000;
+    const auto m = __builtin_bit_cast(V, mantissa);
+    // 2^52 + (biased exponent) - 2^52
+    auto e = __builtin_bit_cast(V, exponent) - 4503599627370496.0 - 1022.0;
+
+    const auto small = m < 0.70710678118654752440;
+    e = small ? e - 1.0 : e;
+    const V y = small ? m + m - 1.0 : m - 1.0;
+
+    const auto z = y * y;
+    const auto p =
+        ((((1.01875663804580931796E-4 * y + 4.97494994976747001425E-1) * y +
+           4.70579119878881725854E0) *
+              y +
+          1.44989225341610930846E1) *
+             y +
+         1.79368678507819816313E1) *
+            y +
+        7.70838733755885391666E0;
+    const auto q =
+        ((((y + 1.12873587189167450590E1) * y + 4.52279145837532221105E1) * y +
+          8.29875266912776603211E1) *
+             y +
+         7.11544750618563894466E1) *
+            y +
+        2.31251620126765340583E1;
+    auto r = y * (z * p / q);
+    r = r - e * 2.121944400546905827679E-4;
+    r = r - 0.5 * z;
+    out = (y + r) + e * 0.693359375;
+}
+
+/// x^y = exp(y log(x)) for x >= 0, 0^y is 0 (y > 0)
+template <typename V>
+[[gnu::always_inline]] inline void pow(V& out, const V& x, double y)
+{
+    V l;
+    log(l, x);
+    V p;
+    exp(p, l * y);
+    out = x == 0.0 ? V{} : p;
+}
+
+// Kernels. Each loop goes over full vectors, then one partial vector whose
+// padding lanes are neutral for the reduction.
+
+template <typename V>
+[[gnu::always_inline]] inline double rastriginSum(const double* x,
+                                                  std::size_t n)
+{
+    constexpr auto L = Lanes<V>::count;
+    V s{};
+    V v, c;
+    std::size_t i = 0;
+    for (; i + L <= n; i += L) {
+        load(v, x + i);
+        cos(c, (2.0 * PI) * v);
+        s += v * v - 10.0 * c;
+    }
+    if (i < n) {
+        // x = 0 gives -10, added back below
+        loadPartial(v, x + i, n - i, 0.0);
+        cos(c, (2.0 * PI) * v);
+        s += v * v - 10.0 * c;
+        return sum(s) + 10.0 * (L - (n - i));
+    }
+    return sum(s);
+}
+
+template <typename V>
+[[gnu::always_inline]] inline void ackleySums(const double* x, std::size_t n,
+                                              double& sum1, double& sum2)
+{
+    constexpr auto L = Lanes<V>::count;
+    V s1{}, s2{};
+    V v, c;
+    std::size_t i = 0;
+    for (; i + L <= n; i += L) {
+        load(v, x + i);
+        cos(c, (2.0 * PI) * v);
+        s1 += v * v;
+        s2 += c;
+    }
+    auto padding = 0.0;
+    if (i < n) {
+        // x = 0 adds cos(0) = 1 to sum2
+        loadPartial(v, x + i, n - i, 0.0);
+        cos(c, (2.0 * PI) * v);
+        s1 += v * v;
+        s2 += c;
+        padding = static_cast<double>(L - (n - i));
+    }
+    sum1 = sum(s1);
+    sum2 = sum(s2) - padding;
+}
+
+template <typename V>
+[[gnu::always_inline]] inline void griewankTerms(const double* x,
+                                                 std::size_t n, double& s,
+                                                 double& p)
+{
+    constexpr auto L = Lanes<V>::count;
+    V sv{};
+    V pv = V{} + 1.0;
+    V index;
+    for (std::size_t k = 0; k < L; ++k) {
+        index[k] = 1.0 + k;
+    }
+    V v, c, root{};
+    std::size_t i = 0;
+    for (; i + L <= n; i += L, index += L) {
+        load(v, x + i);
+        sqrt(root, index);
+        cos(c, v / root);
+        sv += v * v;
+        pv *= c;
+    }
+    if (i < n) {
+        // x = 0 multiplies by cos(0) = 1
+        loadPartial(v, x + i, n - i, 0.0);
+        sqrt(root, index);
+        cos(c, v / root);
+        sv += v * v;
+        pv *= c;
+    }
+    s = sum(sv);
+    p = product(pv);
+}
+
+template <typename V>
+[[gnu::always_inline]] inline void levyTerm(V& t, const V& v)
+{
+    const auto w = 1.0 + v / 4.0;
+    V s;
+    sin(s, PI * w + 1.0);
+    t = (w - 1.0) * (w - 1.0) * (1.0 + 10.0 * s * s);
+}
+
+template <typename V>
+[[gnu::always_inline]] inline double levySum(const double* x, std::size_t n)
+{
+    constexpr auto L = Lanes<V>::count;
+    // the last value only appears in term3
+    const auto count = n - 1;
+    V s{};
+    V v, t;
+    std::size_t i = 0;
+    for (; i + L <= count; i += L) {
+        load(v, x + i);
+        levyTerm(t, v);
+        s += t;
+    }
+    if (i < count) {
+        // w = 1 gives 0
+        loadPartial(v, x + i, count - i, 0.0);
+        levyTerm(t, v);
+        s += t;
+    }
+    return sum(s);
+}
+
+template <typename V>
+[[gnu::always_inline]] inline void schafferTerm(V& t, const V& a, const V& b)
+{
+    V si;
+    sqrt(si, a * a + b * b);
+    V p;
+    pow(p, si, 0.2);
+    V s;
+    sin(s, 50.0 * p);
+    V sqrtsi;
+    sqrt(sqrtsi, si);
+    t = sqrtsi + sqrtsi * s * s;
+}
+
+template <typename V>
+[[gnu::always_inline]] inline double schafferSum(const double* x,
+                                                 std::size_t n)
+{
+    constexpr auto L = Lanes<V>::count;
+    // pairs (x[i], x[i + 1])
+    const auto count = n - 1;
+    V s{};
+    V a, b, t;
+    std::size_t i = 0;
+    for (; i + L <= count; i += L) {
+        load(a, x + i);
+        load(b, x + i + 1);
+        schafferTerm(t, a, b);
+        s += t;
+    }
+    if (i < count) {
+        // (0, 0) gives 0
+        loadPartial(a, x + i, count - i, 0.0);
+        loadPartial(b, x + i + 1, count - i, 0.0);
+        schafferTerm(t, a, b);
+        s += t;
+    }
+    return sum(s);
+}
+
+/// sum for j = 1..32 of the distance of 2^j x to the nearest integer, / 2^j
+template <typename V>
+[[gnu::always_inline]] inline void katsuuraTerm(V& t, const V& v)
+{
+    // adding and removing 2^52 rounds to an integer, |x| >= 2^52 already is
+    // one. Ties give the same distance whichever way they round.
+    constexpr auto magic = 4503599627370496.0;
+    const V a = v < 0.0 ? -v : v;
+    t = V{};
+    for (std::size_t j = 0; j < 32; ++j) {
+        const auto scaled = katsuuraScales.up[j] * a;
+        const auto distance = scaled - ((scaled + magic) - magic);
+        const V d = scaled < magic ? distance : V{};
+        t += (d < 0.0 ? -d : d) * katsuuraScales.down[j];
+    }
+}
+
+template <typename V>
+[[gnu::always_inline]] inline double katsuuraProduct(const double* x,
+                                                     std::size_t n,
+                                                     double exponent)
+{
+    constexpr auto L = Lanes<V>::count;
+    V f = V{} + 1.0;
+    V index;
+    for (std::size_t k = 0; k < L; ++k) {
+        index[k] = 1.0 + k;
+    }
+    V v, t, p;
+    std::size_t i = 0;
+    for (; i + L <= n; i += L, index += L) {
+        load(v, x + i);
+        katsuuraTerm(t, v);
+        pow(p, 1.0 + index * t, exponent);
+        f *= p;
+    }
+    if (i < n) {
+        // x = 0 gives 1^exponent = 1
+        loadPartial(v, x + i, n - i, 0.0);
+        katsuuraTerm(t, v);
+        pow(p, 1.0 + index * t, exponent);
+        f *= p;
+    }
+    return product(f);
+}
+
+template <typename V, void (*F)(V&, const V&)>
+[[gnu::always_inline]] inline void apply(const double* x, double* out,
+                                         std::size_t n)
+{
+    constexpr auto L = Lanes<V>::count;
+    V v, r;
+    std::size_t i = 0;
+    for (; i + L <= n; i += L) {
+        load(v, x + i);
+        F(r, v);
+        std::memcpy(out + i, &r, sizeof(r));
+    }
+    if (i < n) {
+        loadPartial(v, x + i, n - i, 1.0);
+        F(r, v);
+        for (std::size_t k = 0; i + k < n; ++k) {
+            out[i + k] = r[k];
+        }
+    }
+}
+
+template <typename V>
+[[gnu::always_inline]] inline void powArray(const double* x, double y,
+                                            double* out, std::size_t n)
+{
+    constexpr auto L = Lanes<V>::count;
+    V v, r;
+    std::size_t i = 0;
+    for (; i + L <= n; i += L) {
+        load(v, x + i);
+        pow(r, v, y);
+        std::memcpy(out + i, &r, sizeof(r));
+    }
+    if (i < n) {
+        loadPartial(v, x + i, n - i, 1.0);
+        pow(r, v, y);
+        for (std::size_t k = 0; i + k < n; ++k) {
+            out[i + k] = r[k];
+        }
+    }
+}
+
+/// (v[0] + v[1]) + (v[2] + v[3]), the order of the fixed size rotation
+[[gnu::always_inline]] inline double rowSum(const vec4& v)
+{
+    return (v[0] + v[1]) + (v[2] + v[3]);
+}
+
+/// vec8 adds its halves and the 4 wide tail first
+[[gnu::always_inline]] inline double rowSum(const vec8& v, const vec4& tail)
+{
+    const vec4 low{v[0], v[1], v[2], v[3]};
+    const vec4 high{v[4], v[5], v[6], v[7]};
+    return rowSum(low + high + tail);
+}
+
+[[gnu::always_inline]] inline double rowSum(const vec4& v, const vec4&)
+{
+    return rowSum(v);
+}
+
+/// s[k] += r[k] * in over the stride, full vectors of V then, the stride being
+/// a multiple of 4, one vec4 into tail[k] for vec8
+template <typename V, std::size_t R>
+[[gnu::always_inline]] inline void
+rowProducts(V (&s)[R], vec4 (&tail)[R], const double* in,
+            const double* const (&r)[R], std::size_t stride)
+{
+    constexpr auto L = Lanes<V>::count;
+    V x, m;
+    std::size_t j = 0;
+    for (; j + L <= stride; j += L) {
+        load(x, in + j);
+        for (std::size_t k = 0; k < R; ++k) {
+            load(m, r[k] + j);
+            s[k] += m * x;
+        }
+    }
+    if constexpr (L > 4) {
+        if (j < stride) {
+            vec4 x4, m4;
+            load(x4, in + j);
+            for (std::size_t k = 0; k < R; ++k) {
+                load(m4, r[k] + j);
+                tail[k] = m4 * x4;
+            }
+        }
+    }
+}
+
+/// out = M * in, see simd::rotate. Rows are processed 4 at a time, with one
+/// vector accumulator each, so every load of in is shared by 4 rows.
+template <typename V>
+[[gnu::always_inline]] inline void rotateRows(const double* in, double* out,
+                                              const double* matrix,
+                                              std::size_t stride, std::size_t n,
+                                              const std::size_t* rows)
+{
+    const auto row = [=](std::size_t i) {
+        return matrix + (rows ? rows[i] : i) * stride;
+    };
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const double* const r[4] = {row(i), row(i + 1), row(i + 2),
+                                    row(i + 3)};
+        V s[4]{};
+        vec4 tail[4]{};
+        rowProducts(s, tail, in, r, stride);
+        for (std::size_t k = 0; k < 4; ++k) {
+            out[i + k] = rowSum(s[k], tail[k]);
+        }
+    }
+    for (; i < n; ++i) {
+        const double* const r[1] = {row(i)};
+        V s[1]{};
+        vec4 tail[1]{};
+        rowProducts(s, tail, in, r, stride);
+        out[i] = rowSum(s[0], tail[0]);
+    }
+}
+
+/// One entry per kernel, filled with the functions compiled for an isa
+struct Kernels {
+    double (*rastrigin)(const double*, std::size_t);
+    void (*ackley)(const double*, std::size_t, double&, double&);
+    void (*griewank)(const double*, std::size_t, double&, double&);
+    double (*levy)(const double*, std::size_t);
+    double (*schaffer_F7)(const double*, std::size_t);
+    double (*katsuura)(const double*, std::size_t, double);
+    void (*sin)(const double*, double*, std::size_t);
+    void (*cos)(const double*, double*, std::size_t);
+    void (*exp)(const double*, double*, std::size_t);
+    void (*log)(const double*, double*, std::size_t);
+    void (*pow)(const double*, double, double*, std::size_t);
+    void (*rotate)(const double*, double*, const double*, std::size_t,
+                   std::size_t, const std::size_t*);
+};
+
+// clang-format off
+double rastriginSse2(const double* x, std::size_t n) { return rastriginSum<vec2>(x, n); }
+void ackleySse2(const double* x, std::size_t n, double& s1, double& s2) { ackleySums<vec2>(x, n, s1, s2); }
+void griewankSse2(const double* x, std::size_t n, double& s, double& p) { griewankTerms<vec2>(x, n, s, p); }
+double levySse2(const double* x, std::size_t n) { return levySum<vec2>(x, n); }
+double schafferSse2(const double* x, std::size_t n) { return schafferSum<vec2>(x, n); }
+double katsuuraSse2(const double* x, std::size_t n, double e) { return katsuuraProduct<vec2>(x, n, e); }
+void sinSse2(const double* x, double* out, std::size_t n) { apply<vec2, sin<vec2>>(x, out, n); }
+void cosSse2(const double* x, double* out, std::size_t n) { apply<vec2, cos<vec2>>(x, out, n); }
+void expSse2(const double* x, double* out, std::size_t n) { apply<vec2, exp<vec2>>(x, out, n); }
+void logSse2(const double* x, double* out, std::size_t n) { apply<vec2, log<vec2>>(x, out, n); }
+void powSse2(const double* x, double y, double* out, std::size_t n) { powArray<vec2>(x, y, out, n); }
+void rotateSse2(const double* in, double* out, const double* m, std::size_t stride, std::size_t n, const std::size_t* rows) { rotateRows<vec4>(in, out, m, stride, n, rows); }
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+double rastriginAvx2(const double* x, std::size_t n) { return rastriginSum<vec4>(x, n); }
+void ackleyAvx2(const double* x, std::size_t n, double& s1, double& s2) { ackleySums<vec4>(x, n, s1, s2); }
+void griewankAvx2(const double* x, std::size_t n, double& s, double& p) { griewankTerms<vec4>(x, n, s, p); }
+double levyAvx2(const double* x, std::size_t n) { return levySum<vec4>(x, n); }
+double schafferAvx2(const double* x, std::size_t n) { return schafferSum<vec4>(x, n); }
+double katsuuraAvx2(const double* x, std::size_t n, double e) { return katsuuraProduct<vec4>(x, n, e); }
+void sinAvx2(const double* x, double* out, std::size_t n) { apply<vec4, sin<vec4>>(x, out, n); }
+void cosAvx2(const double* x, double* out, std::size_t n) { apply<vec4, cos<vec4>>(x, out, n); }
+void expAvx2(const double* x, double* out, std::size_t n) { apply<vec4, exp<vec4>>(x, out, n); }
+void logAvx2(const double* x, double* out, std::size_t n) { apply<vec4, log<vec4>>(x, out, n); }
+void powAvx2(const double* x, double y, double* out, std::size_t n) { powArray<vec4>(x, y, out, n); }
+void rotateAvx2(const double* in, double* out, const double* m, std::size_t stride, std::size_t n, const std::size_t* rows) { rotateRows<vec4>(in, out, m, stride, n, rows); }
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512dq,avx2,fma")
+double rastriginAvx512(const double* x, std::size_t n) { return rastriginSum<vec8>(x, n); }
+void ackleyAvx512(const double* x, std::size_t n, double& s1, double& s2) { ackleySums<vec8>(x, n, s1, s2); }
+void griewankAvx512(const double* x, std::size_t n, double& s, double& p) { griewankTerms<vec8>(x, n, s, p); }
+double levyAvx512(const double* x, std::size_t n) { return levySum<vec8>(x, n); }
+double schafferAvx512(const double* x, std::size_t n) { return schafferSum<vec8>(x, n); }
+double katsuuraAvx512(const double* x, std::size_t n, double e) { return katsuuraProduct<vec8>(x, n, e); }
+void sinAvx512(const double* x, double* out, std::size_t n) { apply<vec8, sin<vec8>>(x, out, n); }
+void cosAvx512(const double* x, double* out, std::size_t n) { apply<vec8, cos<vec8>>(x, out, n); }
+void expAvx512(const double* x, double* out, std::size_t n) { apply<vec8, exp<vec8>>(x, out, n); }
+void logAvx512(const double* x, double* out, std::size_t n) { apply<vec8, log<vec8>>(x, out, n); }
+void powAvx512(const double* x, double y, double* out, std::size_t n) { powArray<vec8>(x, y, out, n); }
+void rotateAvx512(const double* in, double* out, const double* m, std::size_t stride, std::size_t n, const std::size_t* rows) { rotateRows<vec8>(in, out, m, stride, n, rows); }
+#pragma GCC pop_options
+
+constexpr Kernels sse2{rastriginSse2, ackleySse2, griewankSse2, levySse2, schafferSse2, katsuuraSse2,
+                       sinSse2, cosSse2, expSse2, logSse2, powSse2, rotateSse2};
+constexpr Kernels avx2{rastriginAvx2, ackleyAvx2, griewankAvx2, levyAvx2, schafferAvx2, katsuuraAvx2,
+                       sinAvx2, cosAvx2, expAvx2, logAvx2, powAvx2, rotateAvx2};
+constexpr Kernels avx512{rastriginAvx512, ackleyAvx512, griewankAvx512, levyAvx512, schafferAvx512, katsuuraAvx512,
+                         sinAvx512, cosAvx512, expAvx512, logAvx512, powAvx512, rotateAvx512};
+// clang-format on
+
+constexpr Isa isas[] = {Isa::Sse2, Isa::Avx2, Isa::Avx512};
+
+const Kernels* kernelsOf(Isa isa)
+{
+    if (isa == Isa::Avx512) {
+        return &avx512;
+    }
+    return isa == Isa::Avx2 ? &avx2 : &sse2;
+}
+
+/// The instruction set named by CEC22_ISA when this cpu supports it, the
+/// detected one otherwise
+Isa initial()
+{
+    const auto* requested = std::getenv("CEC22_ISA");
+    if (requested == nullptr) {
+        return detected();
+    }
+    for (const auto isa : isas) {
+        if (std::strcmp(requested, name(isa)) != 0) {
+            continue;
+        }
+        if (supported(isa)) {
+            return isa;
+        }
+        std::cerr << "CEC22_ISA=" << requested
+                  << " is not supported by this cpu, using "
+                  << name(detected()) << '\n';
+        return detected();
+    }
+    std::cerr << "Unknown CEC22_ISA=" << requested
+              << ", expected sse2, avx2 or avx512, using " << name(detected())
+              << '\n';
+    return detected();
+}
+
+// chosen on first use rather than during static initialization, which other
+// files' static objects evaluating functions could run before
+Isa& current()
+{
+    static auto isa = initial();
+    return isa;
+}
+
+const Kernels*& table()
+{
+    static auto* kernels = kernelsOf(current());
+    return kernels;
+}
+
+} // namespace
+
+bool supported(Isa isa)
+{
+    __builtin_cpu_init();
+    if (isa == Isa::Avx512) {
+        return __builtin_cpu_supports("avx512f") and
+               __builtin_cpu_supports("avx512dq") and supported(Isa::Avx2);
+    }
+    if (isa == Isa::Avx2) {
+        return __builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma");
+    }
+    return true;
+}
+
+Isa detected()
+{
+    if (supported(Isa::Avx512)) {
+        return Isa::Avx512;
+    }
+    return supported(Isa::Avx2) ? Isa::Avx2 : Isa::Sse2;
+}
+
+Isa active()
+{
+    return current();
+}
+
+void setActive(Isa isa)
+{
+    if (not supported(isa)) {
+        throw std::runtime_error{std::string{name(isa)} +
+                                 " is not supported by this cpu"};
+    }
+    current() = isa;
+    table() = kernelsOf(isa);
+}
+
+const char* name(Isa isa)
+{
+    if (isa == Isa::Avx512) {
+        return "avx512";
+    }
+    return isa == Isa::Avx2 ? "avx2" : "sse2";
+}
+
+double rastrigin(const double* x, std::size_t n)
+{
+    return table()->rastrigin(x, n);
+}
+
+void ackley(const double* x, std::size_t n, double& sum1, double& sum2)
+{
+    table()->ackley(x, n, sum1, sum2);
+}
+
+void griewank(const double* x, std::size_t n, double& s, double& p)
+{
+    table()->griewank(x, n, s, p);
+}
+
+double levy(const double* x, std::size_t n)
+{
+    return table()->levy(x, n);
+}
+
+double schaffer_F7(const double* x, std::size_t n)
+{
+    return table()->schaffer_F7(x, n);
+}
+
+double katsuura(const double* x, std::size_t n, double exponent)
+{
+    return table()->katsuura(x, n, exponent);
+}
+
+void sin(const double* x, double* out, std::size_t n)
+{
+    table()->sin(x, out, n);
+}
+
+void cos(const double* x, double* out, std::size_t n)
+{
+    table()->cos(x, out, n);
+}
+
+void exp(const double* x, double* out, std::size_t n)
+{
+    table()->exp(x, out, n);
+}
+
+void log(const double* x, double* out, std::size_t n)
+{
+    table()->log(x, out, n);
+}
+
+void pow(const double* x, double y, double* out, std::size_t n)
+{
+    table()->pow(x, y, out, n);
+}
+
+void rotate(const double* in, double* out, const double* matrix,
+            std::size_t stride, std::size_t n, const std::size_t* rows)
+{
+    table()->rotate(in, out, matrix, stride, n, rows);
+}
+
+} // namespace cec22::simd
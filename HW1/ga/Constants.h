@@ -7,6 +7,11 @@ namespace ga::constants {
 // changeable
 inline constexpr auto precision = 8;
 inline constexpr auto populationSize = 100;
+/// suggested slots of the fitness cache, see GeneticAlgorithm::useFitnessCache
+inline constexpr auto cacheCapacity = 1 << 12;
+/// suggested share of the calls spent hillclimbing, see
+/// GeneticAlgorithm::useHillclimbing
+inline constexpr auto hillclimbingShare = 0.2;
 
 // problem specific
 inline constexpr auto minimum = -100.0;
@@ -0,0 +1,401 @@
+#include "DataBundle.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__unix__) or defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CEC22_HAS_MMAP 1
+#endif
+
+namespace fs = std::filesystem;
+
+namespace cec22 {
+
+namespace {
+
+constexpr char magic[8] = {'C', 'E', 'C', '2', '2', 'B', 'I', 'N'};
+constexpr std::size_t blockSize = 64;
+
+enum Kind : std::uint32_t
+{
+    MatrixKind = 1,
+    LinesKind = 2,
+    PermutationKind = 3,
+};
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t entries;
+    std::uint64_t size;
+    std::uint64_t checksum;
+    std::byte padding[32];
+};
+static_assert(sizeof(Header) == blockSize);
+
+std::uint64_t fnv1a(const std::byte* data, std::size_t size)
+{
+    auto hash = std::uint64_t{14695981039346656037ull};
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<std::uint64_t>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::size_t alignUp(std::size_t size)
+{
+    return (size + blockSize - 1) / blockSize * blockSize;
+}
+
+std::size_t strideOf(std::size_t columns)
+{
+    return (columns + Matrix::lanes - 1) / Matrix::lanes * Matrix::lanes;
+}
+
+/// Lines of doubles of a text file, split like std::getline does
+std::vector<std::vector<double>> readLines(const fs::path& file)
+{
+    std::ifstream in{file};
+    std::vector<std::vector<double>> lines;
+    for (std::string str; std::getline(in, str);) {
+        std::istringstream ss{str};
+        lines.push_back({std::istream_iterator<double>{ss},
+                         std::istream_iterator<double>{}});
+    }
+    return lines;
+}
+
+} // namespace
+
+/// Fixed size record of the entry table
+struct DataBundle::Entry {
+    char name[40];
+    std::uint32_t kind;
+    /// Matrix and Lines: rows and lines, Permutation: size
+    std::uint32_t rows;
+    /// Matrix: columns, Lines: count of all values
+    std::uint32_t columns;
+    std::uint32_t reserved;
+    /// from the beginning of the file, aligned to 64 bytes
+    std::uint64_t offset;
+};
+
+DataBundle::~DataBundle()
+{
+#ifdef CEC22_HAS_MMAP
+    if (mapped) {
+        munmap(const_cast<std::byte*>(data), size);
+    }
+#endif
+}
+
+const DataBundle* DataBundle::find(const std::string& directory,
+                                   std::string_view file)
+{
+    static std::mutex mutex;
+    static std::map<fs::path, std::unique_ptr<DataBundle>, std::less<>>
+        bundles;
+
+    std::lock_guard lock{mutex};
+    const auto path = fs::path{directory} / file;
+    auto it = bundles.find(path);
+    if (it == bundles.end()) {
+        // a missing bundle is not an error, the text files are read instead
+        auto bundle = fs::exists(path) ? open(path.string()) : nullptr;
+        it = bundles.emplace(path, std::move(bundle)).first;
+    }
+    return it->second.get();
+}
+
+std::unique_ptr<DataBundle> DataBundle::open(const std::string& file)
+{
+    auto bundle = std::unique_ptr<DataBundle>{new DataBundle};
+    const auto size = fs::file_size(file);
+    if (size < sizeof(Header)) {
+        std::cerr << file << " is too small, reading the text files\n";
+        return nullptr;
+    }
+
+#ifdef CEC22_HAS_MMAP
+    const auto fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Cannot open " << file << ", reading the text files\n";
+        return nullptr;
+    }
+    auto* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "Cannot map " << file << ", reading the text files\n";
+        return nullptr;
+    }
+    bundle->data = static_cast<const std::byte*>(p);
+    bundle->mapped = true;
+#else
+    bundle->buffer.resize((size + sizeof(double) - 1) / sizeof(double));
+    std::ifstream in{file, std::ios::binary};
+    in.read(reinterpret_cast<char*>(bundle->buffer.data()),
+            static_cast<std::streamsize>(size));
+    bundle->data = reinterpret_cast<const std::byte*>(bundle->buffer.data());
+#endif
+    bundle->size = size;
+
+    Header header;
+    std::memcpy(&header, bundle->data, sizeof(header));
+    const auto* what = std::memcmp(header.magic, magic, sizeof(magic)) != 0
+                           ? "is not a data bundle"
+                       : header.version != version ? "has another version"
+                       : header.size != size       ? "is truncated"
+                       : header.entries * sizeof(Entry) + sizeof(Header) > size
+                           ? "has a broken entry table"
+                       : fnv1a(bundle->data + sizeof(Header),
+                               size - sizeof(Header)) != header.checksum
+                           ? "has a wrong checksum"
+                           : nullptr;
+    if (what) {
+        std::cerr << file << ' ' << what << ", reading the text files\n";
+        return nullptr;
+    }
+    return bundle;
+}
+
+const DataBundle::Entry* DataBundle::entry(std::string_view name,
+                                           std::uint32_t kind) const
+{
+    static_assert(sizeof(Entry) == blockSize);
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    const auto* entries =
+        reinterpret_cast<const Entry*>(data + sizeof(Header));
+    for (std::uint32_t i = 0; i < header.entries; ++i) {
+        if (entries[i].kind == kind and name == entries[i].name) {
+            return entries + i;
+        }
+    }
+    return nullptr;
+}
+
+std::optional<std::vector<std::span<const double>>>
+DataBundle::lines(std::string_view name) const
+{
+    const auto* e = entry(name, LinesKind);
+    if (not e) {
+        return std::nullopt;
+    }
+    // line starts (rows + 1 of them), then the values
+    const auto* starts =
+        reinterpret_cast<const std::uint64_t*>(data + e->offset);
+    const auto* values = reinterpret_cast<const double*>(starts + e->rows + 1);
+    auto result = std::vector<std::span<const double>>{};
+    result.reserve(e->rows);
+    for (std::uint32_t i = 0; i < e->rows; ++i) {
+        result.emplace_back(values + starts[i], values + starts[i + 1]);
+    }
+    return result;
+}
+
+std::optional<Matrix> DataBundle::matrix(std::string_view name,
+                                         std::size_t rows,
+                                         std::size_t columns) const
+{
+    const auto* e = entry(name, MatrixKind);
+    if (not e) {
+        return std::nullopt;
+    }
+    if (e->rows < rows or e->columns < columns) {
+        std::cerr << name << " has " << e->rows << " x " << e->columns
+                  << " values, expected " << rows << " x " << columns << "\n";
+        throw std::runtime_error{"Read error"};
+    }
+    const auto* values = reinterpret_cast<const double*>(data + e->offset);
+    if (e->columns == columns) {
+        return Matrix::view(rows, columns, values);
+    }
+    auto copy = Matrix{rows, columns};
+    const auto stride = strideOf(e->columns);
+    for (std::size_t i = 0; i < rows; ++i) {
+        std::copy_n(values + i * stride, columns, copy.row(i));
+    }
+    return copy;
+}
+
+std::optional<std::span<const std::uint64_t>>
+DataBundle::permutation(std::string_view name) const
+{
+    const auto* e = entry(name, PermutationKind);
+    if (not e) {
+        return std::nullopt;
+    }
+    const auto* values =
+        reinterpret_cast<const std::uint64_t*>(data + e->offset);
+    return std::span<const std::uint64_t>{values, e->rows};
+}
+
+void DataBundle::write(const std::string& directory)
+{
+    // sorted, so the same directory always gives the same file
+    std::set<fs::path> files;
+    for (const auto& file : fs::directory_iterator{directory}) {
+        if (file.path().extension() == ".txt") {
+            files.insert(file.path());
+        }
+    }
+
+    auto contents = Contents{};
+    for (const auto& file : files) {
+        const auto name = file.stem().string();
+        const auto lines = readLines(file);
+
+        if (name.starts_with("M_")) {
+            // rows of a rotation all have the same size
+            const auto columns = lines.empty() ? 0 : lines.front().size();
+            auto matrix = Matrix{lines.size(), columns};
+            for (std::size_t i = 0; i < lines.size(); ++i) {
+                if (lines[i].size() != columns) {
+                    std::cerr << name << " has rows of " << lines[i].size()
+                              << " and " << columns << " values\n";
+                    throw std::runtime_error{"Read error"};
+                }
+                std::copy(lines[i].begin(), lines[i].end(), matrix.row(i));
+            }
+            contents.matrices.emplace(name, std::move(matrix));
+        } else if (name.starts_with("shift_data_")) {
+            contents.lines.emplace(name, lines);
+        } else if (name.starts_with("shuffle_data_")) {
+            // shuffle_data_<index>_D<dimensions>
+            const auto dimensions =
+                std::stoul(name.substr(name.rfind("_D") + 2));
+            auto permutation = std::vector<std::uint64_t>{};
+            auto seen = std::vector<bool>(dimensions, false);
+            for (const auto& line : lines) {
+                for (const auto value : line) {
+                    // checked as a double first, converting one out of
+                    // range is undefined. NaN fails the check too.
+                    const auto valid = value >= 1 and value <= dimensions;
+                    const auto i =
+                        valid ? static_cast<std::uint64_t>(value) - 1 : 0;
+                    if (not valid or seen[i]) {
+                        std::cerr << name << " is not a permutation of 1 to "
+                                  << dimensions << '\n';
+                        throw std::runtime_error{"Read error"};
+                    }
+                    seen[i] = true;
+                    permutation.push_back(i);
+                }
+            }
+            if (permutation.size() != dimensions) {
+                std::cerr << name << " has " << permutation.size()
+                          << " indices, expected " << dimensions << '\n';
+                throw std::runtime_error{"Read error"};
+            }
+            contents.permutations.emplace(name, std::move(permutation));
+        }
+        // other files, e.g. Rand_Seeds.txt, are not read by the function
+        // managers
+    }
+    write((fs::path{directory} / fileName).string(), contents);
+}
+
+void DataBundle::write(const std::string& file, const Contents& contents)
+{
+    struct Item {
+        Entry entry;
+        std::vector<std::byte> payload;
+    };
+    std::vector<Item> items;
+
+    const auto append = [](std::vector<std::byte>& payload, const void* p,
+                           std::size_t size) {
+        const auto* bytes = static_cast<const std::byte*>(p);
+        payload.insert(payload.end(), bytes, bytes + size);
+    };
+    const auto item = [&](const std::string& name, std::uint32_t kind) {
+        auto& item = items.emplace_back();
+        if (name.size() >= sizeof(item.entry.name)) {
+            throw std::runtime_error{"Entry name too long: " + name};
+        }
+        std::copy(name.begin(), name.end(), item.entry.name);
+        item.entry.kind = kind;
+        return &item;
+    };
+
+    for (const auto& [name, matrix] : contents.matrices) {
+        // stored with the row stride, so the data can be viewed in place
+        auto* i = item(name, MatrixKind);
+        append(i->payload, matrix.row(0),
+               matrix.rows() * matrix.stride() * sizeof(double));
+        i->entry.rows = matrix.rows();
+        i->entry.columns = matrix.columns();
+    }
+    for (const auto& [name, lines] : contents.lines) {
+        auto* i = item(name, LinesKind);
+        auto starts = std::vector<std::uint64_t>{0};
+        for (const auto& line : lines) {
+            starts.push_back(starts.back() + line.size());
+        }
+        append(i->payload, starts.data(),
+               starts.size() * sizeof(std::uint64_t));
+        for (const auto& line : lines) {
+            append(i->payload, line.data(), line.size() * sizeof(double));
+        }
+        i->entry.rows = lines.size();
+        i->entry.columns = starts.back();
+    }
+    for (const auto& [name, permutation] : contents.permutations) {
+        auto* i = item(name, PermutationKind);
+        append(i->payload, permutation.data(),
+               permutation.size() * sizeof(std::uint64_t));
+        i->entry.rows = permutation.size();
+    }
+
+    // header, entry table, then the payloads, each aligned to 64 bytes
+    auto offset = alignUp(sizeof(Header) + items.size() * sizeof(Entry));
+    for (auto& item : items) {
+        item.entry.offset = offset;
+        offset = alignUp(offset + item.payload.size());
+    }
+    auto bytes = std::vector<std::byte>(offset);
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        std::memcpy(bytes.data() + sizeof(Header) + i * sizeof(Entry),
+                    &items[i].entry, sizeof(Entry));
+        std::copy(items[i].payload.begin(), items[i].payload.end(),
+                  bytes.begin() + items[i].entry.offset);
+    }
+    auto header = Header{};
+    std::copy(std::begin(magic), std::end(magic), header.magic);
+    header.version = version;
+    header.entries = items.size();
+    header.size = bytes.size();
+    header.checksum =
+        fnv1a(bytes.data() + sizeof(Header), bytes.size() - sizeof(Header));
+    std::memcpy(bytes.data(), &header, sizeof(header));
+
+    // written next to the bundle and renamed, so readers never see half a file
+    const auto temporary = fs::path{file}.concat(".tmp");
+    {
+        std::ofstream out{temporary, std::ios::binary};
+        out.write(reinterpret_cast<const char*>(bytes.data()),
+                  static_cast<std::streamsize>(bytes.size()));
+        if (not out) {
+            throw std::runtime_error{"Cannot write " + temporary.string()};
+        }
+    }
+    fs::rename(temporary, file);
+    std::cout << "Wrote " << items.size() << " entries, " << bytes.size()
+              << " bytes to " << file << '\n';
+}
+
+} // namespace cec22
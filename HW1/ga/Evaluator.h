@@ -0,0 +1,159 @@
+#pragma once
+#include "Cec22.h"
+#include "ProblemData.h"
+
+#include <memory>
+#include <variant>
+#include <vector>
+
+namespace cec22 {
+
+// Statically typed evaluators, one type per kernel. The kernels are template
+// arguments, so a visit of Evaluator calls them directly, with one jump on the
+// variant index instead of the two std::function calls of a type erased
+// wrapper. Batched calls dispatch once per batch.
+
+/// Precision of the shift and rotation of batched calls, the kernels always
+/// run in double
+enum class Precision {
+    Double,
+    /// see batch::Buffers::singleRotate
+    Mixed,
+};
+
+/// What batch::Buffers::singleRotate is set to for precision
+inline const float* singleRotate(const ProblemData& data, Precision precision)
+{
+    const auto mixed =
+        precision == Precision::Mixed and not data.singleRotate.empty();
+    return mixed ? data.singleRotate.data() : nullptr;
+}
+
+/// Basic functions, Kernel and BatchKernel as zakharov_func
+template <auto Kernel, auto BatchKernel> struct BasicEvaluator {
+    std::shared_ptr<const ProblemData> data;
+    bool shiftFlag;
+    bool rotateFlag;
+
+    double operator()(const std::vector<double>& x,
+                      std::vector<double>& aux) const
+    {
+        return Kernel(x, aux, data->shift, data->rotate, shiftFlag, rotateFlag);
+    }
+
+    void batch(const std::vector<double>& points, std::vector<double>& values,
+               batch::Buffers& buffers,
+               Precision precision = Precision::Double) const
+    {
+        buffers.singleRotate = singleRotate(*data, precision);
+        BatchKernel(points, values, buffers, data->shift, data->rotate,
+                    shiftFlag, rotateFlag);
+    }
+};
+
+/// Hybrid functions, Kernel and BatchKernel as hf01
+template <auto Kernel, auto BatchKernel> struct HybridEvaluator {
+    std::shared_ptr<const ProblemData> data;
+    bool shiftFlag;
+    bool rotateFlag;
+
+    double operator()(const std::vector<double>& x,
+                      std::vector<double>& aux) const
+    {
+        return Kernel(x, aux, data->shift, data->rotate, data->indices,
+                      shiftFlag, rotateFlag);
+    }
+
+    void batch(const std::vector<double>& points, std::vector<double>& values,
+               batch::Buffers& buffers,
+               Precision precision = Precision::Double) const
+    {
+        buffers.singleRotate = singleRotate(*data, precision);
+        BatchKernel(points, values, buffers, data->shift, data->rotate,
+                    data->indices, shiftFlag, rotateFlag);
+    }
+};
+
+/// Composition functions, always shifted and rotated, Kernel and BatchKernel
+/// as cf01
+template <auto Kernel, auto BatchKernel> struct CompositionEvaluator {
+    std::shared_ptr<const ProblemData> data;
+    bool shiftFlag;
+    bool rotateFlag;
+
+    double operator()(const std::vector<double>& x,
+                      std::vector<double>& aux) const
+    {
+        return Kernel(x, aux, data->shift, data->rotate, true);
+    }
+
+    void batch(const std::vector<double>& points, std::vector<double>& values,
+               batch::Buffers& buffers,
+               Precision precision = Precision::Double) const
+    {
+        buffers.singleRotate = singleRotate(*data, precision);
+        BatchKernel(points, values, buffers, data->shift, data->rotate, true);
+    }
+};
+
+/// Every function, for the runtime size and the fixed D=10 and D=20 kernels
+using Evaluator = std::variant<
+    BasicEvaluator<zakharov_func, batch::zakharov_func>,
+    BasicEvaluator<fixed::zakharov_func<10>, batch::zakharov_func>,
+    BasicEvaluator<fixed::zakharov_func<20>, batch::zakharov_func>,
+    BasicEvaluator<rosenbrock_func, batch::rosenbrock_func>,
+    BasicEvaluator<fixed::rosenbrock_func<10>, batch::rosenbrock_func>,
+    BasicEvaluator<fixed::rosenbrock_func<20>, batch::rosenbrock_func>,
+    BasicEvaluator<schaffer_F7_func, batch::schaffer_F7_func>,
+    BasicEvaluator<fixed::schaffer_F7_func<10>, batch::schaffer_F7_func>,
+    BasicEvaluator<fixed::schaffer_F7_func<20>, batch::schaffer_F7_func>,
+    BasicEvaluator<rastrigin_func, batch::rastrigin_func>,
+    BasicEvaluator<fixed::rastrigin_func<10>, batch::rastrigin_func>,
+    BasicEvaluator<fixed::rastrigin_func<20>, batch::rastrigin_func>,
+    BasicEvaluator<levy_func, batch::levy_func>,
+    BasicEvaluator<fixed::levy_func<10>, batch::levy_func>,
+    BasicEvaluator<fixed::levy_func<20>, batch::levy_func>,
+    HybridEvaluator<hf01, batch::hf01>,
+    HybridEvaluator<fixed::hf01<10>, batch::hf01>,
+    HybridEvaluator<fixed::hf01<20>, batch::hf01>,
+    HybridEvaluator<hf02, batch::hf02>,
+    HybridEvaluator<fixed::hf02<10>, batch::hf02>,
+    HybridEvaluator<fixed::hf02<20>, batch::hf02>,
+    HybridEvaluator<hf03, batch::hf03>,
+    HybridEvaluator<fixed::hf03<10>, batch::hf03>,
+    HybridEvaluator<fixed::hf03<20>, batch::hf03>,
+    CompositionEvaluator<cf01, batch::cf01>,
+    CompositionEvaluator<fixed::cf01<10>, batch::cf01>,
+    CompositionEvaluator<fixed::cf01<20>, batch::cf01>,
+    CompositionEvaluator<cf02, batch::cf02>,
+    CompositionEvaluator<fixed::cf02<10>, batch::cf02>,
+    CompositionEvaluator<fixed::cf02<20>, batch::cf02>,
+    CompositionEvaluator<cf03, batch::cf03>,
+    CompositionEvaluator<fixed::cf03<10>, batch::cf03>,
+    CompositionEvaluator<fixed::cf03<20>, batch::cf03>,
+    CompositionEvaluator<cf04, batch::cf04>,
+    CompositionEvaluator<fixed::cf04<10>, batch::cf04>,
+    CompositionEvaluator<fixed::cf04<20>, batch::cf04>>;
+
+/// Builds the evaluator of one function
+using EvaluatorFactory = Evaluator (*)(int dimensions,
+                                       std::shared_ptr<const ProblemData> data,
+                                       bool shiftFlag, bool rotateFlag);
+
+/// Factory of the Kind evaluator using the kernel compiled for the dimensions
+/// when there is one, the runtime one otherwise
+template <template <auto, auto> class Kind, auto Runtime, auto D10, auto D20,
+          auto Batch>
+Evaluator bySize(int dimensions, std::shared_ptr<const ProblemData> data,
+                 bool shiftFlag, bool rotateFlag)
+{
+    if (dimensions == 10) {
+        return Kind<D10, Batch>{std::move(data), shiftFlag, rotateFlag};
+    }
+    if (dimensions == 20) {
+        return Kind<D20, Batch>{std::move(data), shiftFlag, rotateFlag};
+    }
+    return Kind<Runtime, Batch>{std::move(data), shiftFlag, rotateFlag};
+}
+
+} // namespace cec22
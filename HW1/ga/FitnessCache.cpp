@@ -0,0 +1,109 @@
+#include "FitnessCache.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace ga {
+namespace {
+
+/// Slots looked at after the home slot of a key
+constexpr std::size_t probes = 8;
+
+/// splitmix64 finalizer
+std::uint64_t mix(std::uint64_t x)
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+} // namespace
+
+FitnessCache::FitnessCache(std::size_t capacity, std::size_t words)
+    // clang-format off
+    : slots(capacity ? std::bit_ceil(capacity) : 0)
+    , keys(slots.size() * words)
+    , words{words}
+// clang-format on
+{
+}
+
+std::uint64_t FitnessCache::hashOf(const std::uint64_t* key, bool gray) const
+{
+    auto hash = mix(gray);
+    for (std::size_t i = 0; i < words; ++i) {
+        hash = mix(hash ^ key[i]);
+    }
+    return hash;
+}
+
+bool FitnessCache::matches(std::size_t slot, std::uint64_t hash,
+                           const std::uint64_t* key, bool gray) const
+{
+    const auto& s = slots[slot];
+    return s.used and s.hash == hash and s.gray == gray and
+           std::equal(key, key + words, keys.begin() + slot * words);
+}
+
+std::optional<double> FitnessCache::find(const std::uint64_t* key, bool gray)
+{
+    if (slots.empty()) {
+        return std::nullopt;
+    }
+    const auto hash = hashOf(key, gray);
+    const auto mask = slots.size() - 1;
+    for (std::size_t i = 0; i <= probes; ++i) {
+        const auto slot = (hash + i) & mask;
+        if (not slots[slot].used) {
+            break;
+        }
+        if (matches(slot, hash, key, gray)) {
+            ++hits_;
+            return slots[slot].value;
+        }
+    }
+    ++misses_;
+    return std::nullopt;
+}
+
+void FitnessCache::insert(const std::uint64_t* key, bool gray, double value)
+{
+    if (slots.empty()) {
+        return;
+    }
+    const auto hash = hashOf(key, gray);
+    const auto mask = slots.size() - 1;
+    // the first free or equal slot of the window, the home slot when full
+    auto target = hash & mask;
+    for (std::size_t i = 0; i <= probes; ++i) {
+        const auto slot = (hash + i) & mask;
+        if (not slots[slot].used or matches(slot, hash, key, gray)) {
+            target = slot;
+            break;
+        }
+    }
+    slots[target] = {hash, value, true, gray};
+    std::copy_n(key, words, keys.begin() + target * words);
+}
+
+void FitnessCache::clear()
+{
+    std::fill(slots.begin(), slots.end(), Slot{});
+}
+
+std::size_t FitnessCache::capacity() const
+{
+    return slots.size();
+}
+
+std::size_t FitnessCache::hits() const
+{
+    return hits_;
+}
+
+std::size_t FitnessCache::misses() const
+{
+    return misses_;
+}
+
+} // namespace ga
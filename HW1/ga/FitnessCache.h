@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace ga {
+
+/// Bounded memo of the values of exact chromosome repeats, keyed by the packed
+/// bits of a chromosome and whether they are decoded as gray codes. Open
+/// addressing with linear probing over a power of two number of slots. A key
+/// whose probe window is full replaces the entry at its home slot, so the
+/// memory never grows after construction.
+class FitnessCache
+{
+  public:
+    /// Disabled, every lookup misses without being counted
+    FitnessCache() = default;
+    /// capacity slots, rounded up to a power of two, for keys of words words
+    FitnessCache(std::size_t capacity, std::size_t words);
+
+    /// The value stored for key, counted as a hit or a miss
+    std::optional<double> find(const std::uint64_t* key, bool gray);
+    void insert(const std::uint64_t* key, bool gray, double value);
+    /// Forgets the entries, keeps the counters
+    void clear();
+
+    /// 0 when disabled
+    std::size_t capacity() const;
+    std::size_t hits() const;
+    std::size_t misses() const;
+
+  private:
+    struct Slot {
+        std::uint64_t hash = 0;
+        double value = 0.0;
+        bool used = false;
+        bool gray = false;
+    };
+
+    std::uint64_t hashOf(const std::uint64_t* key, bool gray) const;
+    bool matches(std::size_t slot, std::uint64_t hash, const std::uint64_t* key,
+                 bool gray) const;
+
+    std::vector<Slot> slots;
+    /// key of slot i at [i * words, (i + 1) * words)
+    std::vector<std::uint64_t> keys;
+    std::size_t words = 0;
+    std::size_t hits_ = 0;
+    std::size_t misses_ = 0;
+};
+
+} // namespace ga
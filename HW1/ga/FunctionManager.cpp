@@ -1,7 +1,13 @@
 #include "FunctionManager.h"
 
 #include "Cec22.h"
+#include "DataBundle.h"
+#include "Evaluator.h"
+#include "GeneratedData.h"
+#include "ProblemData.h"
 
+#include <algorithm>
+#include <atomic>
 #include <exception>
 // #include <format> // ;( format is not available yet
 #include <filesystem>
@@ -10,6 +16,7 @@
 #include <ranges>
 #include <set>
 #include <sstream>
+#include <tuple>
 #include <unordered_map>
 
 using namespace cec22;
@@ -28,23 +35,92 @@ std::string getInputDir()
     // TODO: implement recursive search
 }
 
-std::vector<double> readShift(std::size_t dimensions, int index, bool shiftFlag)
+/// The bundle holding the data of function index: the converted shipped data
+/// for 10 and 20 dimensions, generated data for the others
+const DataBundle* findBundle(int index, std::size_t dimensions)
+{
+    if (dimensions == 10 or dimensions == 20) {
+        return DataBundle::find(getInputDir());
+    }
+    return generatedData(getInputDir(), index, dimensions);
+}
+
+/// The first dimensions values of the first rows lines, one line per component
+std::vector<double>
+readCompositeShift(const DataBundle* bundle, std::size_t dimensions,
+                   std::size_t rows, int index, bool shiftFlag)
 {
     if (not shiftFlag) {
         return {};
     }
 
-    // std format is not available yet
-    const auto file =
-        getInputDir() + "shift_data_" + std::to_string(index) + ".txt";
-    if (not fs::exists(file)) {
-        throw std::runtime_error{"File " + file + " does not exist"};
+    const auto name = "shift_data_" + std::to_string(index);
+    std::vector<std::vector<double>> shift;
+    if (const auto lines = bundle ? bundle->lines(name) : std::nullopt) {
+        for (const auto line : *lines) {
+            shift.emplace_back(line.begin(), line.end());
+        }
+    } else {
+        const auto file = getInputDir() + name + ".txt";
+        if (not fs::exists(file)) {
+            throw std::runtime_error{"File " + file + " does not exist"};
+        }
+
+        std::ifstream in{file};
+        for (std::string str; std::getline(in, str);) {
+            std::istringstream ss{str};
+            shift.push_back({std::istream_iterator<double>{ss},
+                             std::istream_iterator<double>{}});
+        }
     }
 
-    // std::cout << "Reading file " << file << '\n';
-    std::ifstream in{file};
-    std::vector<double> x(std::istream_iterator<double>{in},
-                          std::istream_iterator<double>{});
+    if (shift.size() < rows) {
+        std::cerr << "Shift has " << shift.size() << " rows, expected " << rows
+                  << "\n";
+        throw std::runtime_error{"Read error"};
+    }
+    shift.resize(rows);
+    for (auto& row : shift) {
+        if (row.size() < dimensions) {
+            std::cerr << "Row has " << row.size() << " columns, expected "
+                      << dimensions << "\n";
+            throw std::runtime_error{"Read error"};
+        }
+        row.resize(dimensions);
+    }
+    auto ret = std::vector<double>{};
+    for (auto& row : shift) {
+        ret.insert(ret.end(), row.begin(), row.end());
+    }
+    return ret;
+}
+
+std::vector<double> readShift(const DataBundle* bundle, std::size_t dimensions,
+                              int index, bool shiftFlag)
+{
+    if (not shiftFlag) {
+        return {};
+    }
+
+    // std format is not available yet
+    const auto name = "shift_data_" + std::to_string(index);
+    std::vector<double> x;
+    if (const auto lines = bundle ? bundle->lines(name) : std::nullopt) {
+        // all values, in file order
+        for (const auto line : *lines) {
+            x.insert(x.end(), line.begin(), line.end());
+        }
+    } else {
+        const auto file = getInputDir() + name + ".txt";
+        if (not fs::exists(file)) {
+            throw std::runtime_error{"File " + file + " does not exist"};
+        }
+
+        // std::cout << "Reading file " << file << '\n';
+        std::ifstream in{file};
+        x.assign(std::istream_iterator<double>{in},
+                 std::istream_iterator<double>{});
+    }
 
     if (x.size() < dimensions) {
         std::cerr << "Read " << x.size() << " doubles, expected " << dimensions
@@ -55,49 +131,60 @@ std::vector<double> readShift(std::size_t dimensions, int index, bool shiftFlag)
     return x;
 }
 
-std::vector<std::vector<double>>
-readRotate(std::size_t rows, std::size_t columns, int index, bool rotateFlag)
+Matrix readRotate(const DataBundle* bundle, std::size_t rows,
+                  std::size_t columns, int index, bool rotateFlag)
 {
     if (not rotateFlag) {
-        return {{}};
+        return {};
+    }
+
+    const auto name =
+        "M_" + std::to_string(index) + "_D" + std::to_string(columns);
+    if (auto rotate = bundle ? bundle->matrix(name, rows, columns)
+                             : std::nullopt) {
+        return std::move(*rotate);
     }
 
-    const auto file = getInputDir() + "M_" + std::to_string(index) + "_D" +
-                      std::to_string(columns) + ".txt";
+    const auto file = getInputDir() + name + ".txt";
     if (not fs::exists(file)) {
         throw std::runtime_error{"File " + file + " does not exist"};
     }
 
     // std::cout << "Reading file " << file << '\n';
     std::ifstream in{file};
-    std::vector<std::vector<double>> rotate;
-    for (std::string str; std::getline(in, str);) {
+    auto rotate = Matrix{rows, columns};
+    std::size_t i = 0;
+    for (std::string str; i < rows and std::getline(in, str); ++i) {
         std::istringstream ss{str};
-        rotate.push_back({std::istream_iterator<double>{ss},
-                          std::istream_iterator<double>{}});
-    }
-
-    if (rotate.size() < rows) {
-        std::cerr << "Rotate has " << rotate.size() << " rows, expected "
-                  << rows << "\n";
-        throw std::runtime_error{"Read error"};
-    }
-    rotate.resize(rows);
-    for (auto& row : rotate) {
+        const std::vector<double> row{std::istream_iterator<double>{ss},
+                                      std::istream_iterator<double>{}};
         if (row.size() < columns) {
             std::cerr << "Row has " << row.size() << " columns, expected "
                       << columns << "\n";
             throw std::runtime_error{"Read error"};
         }
-        row.resize(columns);
+        std::copy_n(row.begin(), columns, rotate.row(i));
+    }
+
+    if (i < rows) {
+        std::cerr << "Rotate has " << i << " rows, expected " << rows << "\n";
+        throw std::runtime_error{"Read error"};
     }
     return rotate;
 }
 
-std::vector<std::size_t> readShuffle(std::size_t dimensions, int index)
+std::vector<std::size_t>
+readShuffle(const DataBundle* bundle, std::size_t dimensions, int index)
 {
-    const auto file = getInputDir() + "shuffle_data_" + std::to_string(index) +
-                      "_D" + std::to_string(dimensions) + ".txt";
+    const auto name = "shuffle_data_" + std::to_string(index) + "_D" +
+                      std::to_string(dimensions);
+    if (const auto permutation =
+            bundle ? bundle->permutation(name) : std::nullopt) {
+        // validated by the converter
+        return {permutation->begin(), permutation->end()};
+    }
+
+    const auto file = getInputDir() + name + ".txt";
     if (not fs::exists(file)) {
         throw std::runtime_error{"File " + file + " does not exist"};
     }
@@ -133,18 +220,18 @@ std::vector<std::size_t> readShuffle(std::size_t dimensions, int index)
 
 } // namespace
 
+void convertInputData()
+{
+    DataBundle::write(getInputDir());
+}
+
 FunctionManager::FunctionManager(const std::string& functionName,
                                  int dimensions, bool shiftFlag,
                                  bool rotateFlag)
     : functionName{functionName}, maxFes{dimensions == 10 ? 200'000 : 1'000'000}
 {
-
-    if ((shiftFlag or rotateFlag) and dimensions != 10 and dimensions != 20) {
-        // not very flexible...
-        throw std::runtime_error{"This Function Manager accepts only 10 or 20 "
-                                 "dimensions when shifting or rotating"};
-    }
-    function = initFunction(dimensions, shiftFlag, rotateFlag);
+    std::tie(function, neighbours) =
+        initFunction(dimensions, shiftFlag, rotateFlag);
 }
 
 std::string FunctionManager::toString() const
@@ -161,12 +248,12 @@ std::string FunctionManager::toString() const
 double
 FunctionManager::f(std::vector<double>& x, std::vector<double>& aux) const
 {
-    return function(x, aux);
+    return std::visit([&](const auto& f) { return f(x, aux); }, function);
 }
 
 int FunctionManager::count() const
 {
-    return functionCalls;
+    return std::atomic_ref{functionCalls}.load(std::memory_order_relaxed);
 }
 
 double
@@ -180,92 +267,165 @@ FunctionManager::operator()(std::vector<double>& x, std::vector<double>& aux)
     // if (functionCalls % 2000) {
     //     values.push_back(ret);
     // }
-    ++functionCalls;
+    std::atomic_ref{functionCalls}.fetch_add(1, std::memory_order_relaxed);
     return ret;
 }
 
-std::function<double(std::vector<double>&, std::vector<double>&)>
+void FunctionManager::evaluateBatch(const std::vector<double>& points,
+                                    std::vector<double>& values)
+{
+    // one dispatch for the whole batch
+    std::visit(
+        [&](const auto& f) { f.batch(points, values, buffers, precision); },
+        function);
+    if (precision == Precision::Mixed and
+        *std::min_element(values.begin(), values.end()) < singleThreshold) {
+        // values this close to the optimum are only reported in double
+        precision = Precision::Double;
+        std::visit([&](const auto& f) { f.batch(points, values, buffers); },
+                   function);
+    }
+    functionCalls += values.size();
+}
+
+void FunctionManager::useSinglePrecision(double threshold)
+{
+    precision = Precision::Mixed;
+    singleThreshold = threshold;
+}
+
+DeltaEvaluator FunctionManager::deltaEvaluator() const
+{
+    return neighbours;
+}
+
+double FunctionManager::operator()(DeltaEvaluator& neighbours,
+                                   std::size_t dimension, double value)
+{
+    std::atomic_ref{functionCalls}.fetch_add(1, std::memory_order_relaxed);
+    return neighbours.evaluateWithCoordinateChange(dimension, value);
+}
+
+std::pair<Evaluator, DeltaEvaluator>
 FunctionManager::initFunction(int dimensions, bool shiftFlag, bool rotateFlag)
 {
     using namespace std::string_literals;
-    const std::unordered_map<
-        std::string,
-        std::tuple<int,
-                   std::function<double(
-                       std::vector<double>&, std::vector<double>&,
-                       const std::vector<double>&,
-                       const std::vector<std::vector<double>>&, bool, bool)>,
-                   double>>
+    const std::unordered_map<std::string,
+                             std::tuple<int, double, EvaluatorFactory>>
         basicFunctions = {
             // TODO: find what 300.0 and the likes are and if we even need to
             // add them
-            {"zakharov_func"s, {1, zakharov_func, 300.0}},
-            {"rosenbrock_func"s, {2, rosenbrock_func, 400.0}},
-            {"schaffer_F7_func"s, {3, schaffer_F7_func, 600.0}},
-            {"rastrigin_func"s, {4, rastrigin_func, 800.0}},
-            {"levy_func"s, {5, levy_func, 900.0}},
+            {"zakharov_func"s,
+             {1, 300.0,
+              bySize<BasicEvaluator, zakharov_func, fixed::zakharov_func<10>,
+                     fixed::zakharov_func<20>, batch::zakharov_func>}},
+            {"rosenbrock_func"s,
+             {2, 400.0,
+              bySize<BasicEvaluator, rosenbrock_func,
+                     fixed::rosenbrock_func<10>, fixed::rosenbrock_func<20>,
+                     batch::rosenbrock_func>}},
+            {"schaffer_F7_func"s,
+             {3, 600.0,
+              bySize<BasicEvaluator, schaffer_F7_func,
+                     fixed::schaffer_F7_func<10>, fixed::schaffer_F7_func<20>,
+                     batch::schaffer_F7_func>}},
+            {"rastrigin_func"s,
+             {4, 800.0,
+              bySize<BasicEvaluator, rastrigin_func, fixed::rastrigin_func<10>,
+                     fixed::rastrigin_func<20>, batch::rastrigin_func>}},
+            {"levy_func"s,
+             {5, 900.0,
+              bySize<BasicEvaluator, levy_func, fixed::levy_func<10>,
+                     fixed::levy_func<20>, batch::levy_func>}},
         };
-    const std::unordered_map<
-        std::string,
-        std::tuple<
-            int,
-            std::function<double(std::vector<double>&, std::vector<double>&,
-                                 const std::vector<double>&,
-                                 const std::vector<std::vector<double>>&,
-                                 const std::vector<std::size_t>&, bool, bool)>,
-            double>>
+    const std::unordered_map<std::string,
+                             std::tuple<int, double, EvaluatorFactory>>
         hybridFunctions = {
-            {"hf01"s, {6, hf01, 1800.0}},
-            {"hf02"s, {7, hf02, 2000.0}},
-            {"hf03"s, {8, hf03, 2200.0}},
+            {"hf01"s,
+             {6, 1800.0,
+              bySize<HybridEvaluator, hf01, fixed::hf01<10>, fixed::hf01<20>,
+                     batch::hf01>}},
+            {"hf02"s,
+             {7, 2000.0,
+              bySize<HybridEvaluator, hf02, fixed::hf02<10>, fixed::hf02<20>,
+                     batch::hf02>}},
+            {"hf03"s,
+             {8, 2200.0,
+              bySize<HybridEvaluator, hf03, fixed::hf03<10>, fixed::hf03<20>,
+                     batch::hf03>}},
         };
-    const std::unordered_map<
-        std::string,
-        std::tuple<int,
-                   std::function<double(
-                       std::vector<double>&, std::vector<double>&,
-                       const std::vector<double>&,
-                       const std::vector<std::vector<double>>&, bool)>,
-                   double, int>>
+    const std::unordered_map<std::string,
+                             std::tuple<int, double, int, EvaluatorFactory>>
         compositionFunctions = {
-            {"cf01"s, {9, cf01, 2300.0, 5}},
-            {"cf02"s, {10, cf02, 2400.0, 3}},
-            {"cf03"s, {11, cf03, 2600.0, 5}},
-            {"cf04"s, {12, cf04, 2700.0, 6}},
+            {"cf01"s,
+             {9, 2300.0, 5,
+              bySize<CompositionEvaluator, cf01, fixed::cf01<10>,
+                     fixed::cf01<20>, batch::cf01>}},
+            {"cf02"s,
+             {10, 2400.0, 3,
+              bySize<CompositionEvaluator, cf02, fixed::cf02<10>,
+                     fixed::cf02<20>, batch::cf02>}},
+            {"cf03"s,
+             {11, 2600.0, 5,
+              bySize<CompositionEvaluator, cf03, fixed::cf03<10>,
+                     fixed::cf03<20>, batch::cf03>}},
+            {"cf04"s,
+             {12, 2700.0, 6,
+              bySize<CompositionEvaluator, cf04, fixed::cf04<10>,
+                     fixed::cf04<20>, batch::cf04>}},
         };
 
     if (basicFunctions.find(functionName) != basicFunctions.end()) {
-        const auto [index, f, fStar] = basicFunctions.at(functionName);
-        return [=, f = std::move(f),
-                shift = readShift(dimensions, index, shiftFlag),
-                rotate = readRotate(dimensions, dimensions, index, rotateFlag)](
-                   std::vector<double>& x, std::vector<double>& aux) {
-            return f(x, aux, shift, rotate, shiftFlag, rotateFlag);
-            // + fStar;
-        };
+        const auto [index, fStar, make] = basicFunctions.at(functionName);
+        const auto data = problemData(
+            {getInputDir(), index, dimensions, shiftFlag, rotateFlag}, [&] {
+                const auto* bundle = shiftFlag or rotateFlag
+                                         ? findBundle(index, dimensions)
+                                         : nullptr;
+                return ProblemData{readShift(bundle, dimensions, index,
+                                             shiftFlag),
+                                   readRotate(bundle, dimensions, dimensions,
+                                              index, rotateFlag),
+                                   {}};
+            });
+        // + fStar is not added
+        return {make(dimensions, data, shiftFlag, rotateFlag),
+                DeltaEvaluator{static_cast<DeltaEvaluator::Function>(index),
+                               data, shiftFlag, rotateFlag}};
     }
 
     if (hybridFunctions.find(functionName) != hybridFunctions.end()) {
-        const auto [index, f, fStar] = hybridFunctions.at(functionName);
-        return [=, f = std::move(f),
-                shift = readShift(dimensions, index, shiftFlag),
-                rotate = readRotate(dimensions, dimensions, index, rotateFlag),
-                indices = readShuffle(dimensions, index)](
-                   std::vector<double>& x, std::vector<double>& aux) {
-            return f(x, aux, shift, rotate, indices, shiftFlag, rotateFlag);
-            // + fStar;
-        };
+        const auto [index, fStar, make] = hybridFunctions.at(functionName);
+        const auto data = problemData(
+            {getInputDir(), index, dimensions, shiftFlag, rotateFlag}, [&] {
+                // the shuffle is always read
+                const auto* bundle = findBundle(index, dimensions);
+                return ProblemData{readShift(bundle, dimensions, index,
+                                             shiftFlag),
+                                   readRotate(bundle, dimensions, dimensions,
+                                              index, rotateFlag),
+                                   readShuffle(bundle, dimensions, index)};
+            });
+        return {make(dimensions, data, shiftFlag, rotateFlag),
+                DeltaEvaluator{static_cast<DeltaEvaluator::Function>(index),
+                               data, shiftFlag, rotateFlag}};
     }
 
     if (compositionFunctions.find(functionName) != compositionFunctions.end()) {
-        const auto [index, f, fStar, n] = compositionFunctions.at(functionName);
-        return [=, f = std::move(f),
-                shift = readShift(dimensions * n, index, true),
-                rotate = readRotate(dimensions * n, dimensions, index, true)](
-                   std::vector<double>& x, std::vector<double>& aux) {
-            return f(x, aux, shift, rotate, true); // always rotate
-            // + fStar;
-        };
+        const auto [index, fStar, n, make] =
+            compositionFunctions.at(functionName);
+        // always shift and rotate
+        const auto data = problemData(
+            {getInputDir(), index, dimensions, true, true}, [&] {
+                const auto* bundle = findBundle(index, dimensions);
+                return ProblemData{
+                    readCompositeShift(bundle, dimensions, n, index, true),
+                    readRotate(bundle, dimensions * n, dimensions, index, true),
+                    {}};
+            });
+        return {make(dimensions, data, true, true),
+                DeltaEvaluator{static_cast<DeltaEvaluator::Function>(index),
+                               data, true, true}};
     }
 
     // No function found
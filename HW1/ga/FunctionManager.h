@@ -1,30 +1,62 @@
 #pragma once
-#include <functional>
+#include "Cec22.h"
+#include "Evaluator.h"
+
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace ga {
 
+/// Writes the binary bundle of the input data directory, read instead of the
+/// text files from then on
+void convertInputData();
+
 class FunctionManager
 {
   public:
     FunctionManager(const std::string& functionName, int dimensions,
                     bool shiftFlag, bool rotateFlag);
 
+    /// Counted evaluation. The single point ones may run on several threads at
+    /// once, their count is atomic and may be read while they run.
     double operator()(std::vector<double>& x, std::vector<double>& aux);
     double f(std::vector<double>& x, std::vector<double>& aux) const;
+    /// Evaluates values.size() points at once. points is a structure-of-arrays
+    /// block, see cec22::batch
+    void evaluateBatch(const std::vector<double>& points,
+                       std::vector<double>& values);
+    /// Opt-in mixed precision for exploring: batches are shifted and rotated
+    /// in single precision until one has a value below threshold. That batch
+    /// is evaluated again in double, and so is everything after it. Single
+    /// point calls are always double.
+    void useSinglePrecision(double threshold);
+    /// Evaluator of the neighbours of a point differing in one coordinate,
+    /// sharing this function's data
+    cec22::DeltaEvaluator deltaEvaluator() const;
+    /// neighbours.evaluateWithCoordinateChange(dimension, value), counted
+    /// like the other evaluations
+    double operator()(cec22::DeltaEvaluator& neighbours, std::size_t dimension,
+                      double value);
 
     std::string toString() const;
     int count() const;
 
   private:
-    std::function<double(std::vector<double>&, std::vector<double>&)>
+    std::pair<cec22::Evaluator, cec22::DeltaEvaluator>
     initFunction(int dimensions, bool shiftFlag, bool rotateFlag);
 
     std::string functionName;
-    std::function<double(std::vector<double>&, std::vector<double>&)> function;
+    /// The concrete evaluator, dispatched by std::visit
+    cec22::Evaluator function;
+    cec22::DeltaEvaluator neighbours;
+    cec22::batch::Buffers buffers;
+
+    cec22::Precision precision = cec22::Precision::Double;
+    double singleThreshold = 0.0;
 
-    int functionCalls = 0;
+    // mutable for the atomic load of count
+    mutable int functionCalls = 0;
     int maxFes;
     std::vector<double> values;
 };
@@ -0,0 +1,187 @@
+#include "GeneratedData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace cec22 {
+
+namespace {
+
+/// Rotations and shifts of function index, as read by the function managers
+std::size_t componentsOf(int index)
+{
+    switch (index) {
+    case 9:
+    case 11:
+        return 5;
+    case 10:
+        return 3;
+    case 12:
+        return 6;
+    default:
+        return 1;
+    }
+}
+
+bool isHybrid(int index)
+{
+    return index >= 6 and index <= 8;
+}
+
+DataBundle::Contents generate(int index, std::size_t dimensions)
+{
+    // one seed per function and size, so sizes can be added independently
+    std::seed_seq seed{2022, index, static_cast<int>(dimensions)};
+    std::mt19937_64 gen{seed};
+    const auto components = componentsOf(index);
+    const auto suffix = std::to_string(index);
+    const auto size = "_D" + std::to_string(dimensions);
+
+    auto contents = DataBundle::Contents{};
+    auto rotate = Matrix{components * dimensions, dimensions};
+    for (std::size_t k = 0; k < components; ++k) {
+        const auto rotation = randomRotation(dimensions, gen);
+        for (std::size_t i = 0; i < dimensions; ++i) {
+            std::copy_n(rotation.row(i), dimensions,
+                        rotate.row(k * dimensions + i));
+        }
+    }
+    contents.matrices.emplace("M_" + suffix + size, std::move(rotate));
+
+    // the range of the shipped shifts
+    std::uniform_real_distribution<double> uniform{-80.0, 80.0};
+    auto& shift = contents.lines["shift_data_" + suffix];
+    for (std::size_t k = 0; k < components; ++k) {
+        auto& line = shift.emplace_back(dimensions);
+        std::generate(line.begin(), line.end(), [&] { return uniform(gen); });
+    }
+
+    if (isHybrid(index)) {
+        auto& permutation =
+            contents.permutations["shuffle_data_" + suffix + size];
+        permutation.resize(dimensions);
+        std::iota(permutation.begin(), permutation.end(), 0);
+        std::shuffle(permutation.begin(), permutation.end(), gen);
+    }
+    return contents;
+}
+
+} // namespace
+
+std::string generatedFile(int index, std::size_t dimensions)
+{
+    return "generated_" + std::to_string(index) + "_D" +
+           std::to_string(dimensions) + ".bin";
+}
+
+const DataBundle*
+generatedData(const std::string& directory, int index, std::size_t dimensions)
+{
+    // generating takes seconds for the largest sizes, holding the lock keeps
+    // concurrent managers from generating the same file twice
+    static std::mutex mutex;
+    std::lock_guard lock{mutex};
+
+    const auto file = generatedFile(index, dimensions);
+    const auto path = fs::path{directory} / file;
+    if (not fs::exists(path)) {
+        std::cout << "Generating the data of function " << index << " for "
+                  << dimensions << " dimensions\n";
+        DataBundle::write(path.string(), generate(index, dimensions));
+    }
+    const auto* bundle = DataBundle::find(directory, file);
+    if (not bundle) {
+        // find keeps the answer, a new file would not be opened until exit
+        throw std::runtime_error{"Generated data " + path.string() +
+                                 " is not valid, delete it to generate it "
+                                 "again"};
+    }
+    return bundle;
+}
+
+Matrix randomRotation(std::size_t dimensions, std::mt19937_64& gen)
+{
+    const auto n = dimensions;
+    std::normal_distribution<double> normal;
+    // column major, so the reflections run over contiguous columns
+    auto a = std::vector<double>(n * n);
+    std::generate(a.begin(), a.end(), [&] { return normal(gen); });
+    auto q = std::vector<double>(n * n, 0.0);
+    auto signs = std::vector<double>(n);
+
+    // reflects rows [k, n) of column by v, which is unit length
+    const auto reflect = [n](double* column, const std::vector<double>& v,
+                             std::size_t k) {
+        auto dot = 0.0;
+        for (std::size_t i = k; i < n; ++i) {
+            dot += v[i] * column[i];
+        }
+        for (std::size_t i = k; i < n; ++i) {
+            column[i] -= 2.0 * dot * v[i];
+        }
+    };
+
+    // Householder QR: a becomes R, the reflections are kept in vs
+    auto vs = std::vector<std::vector<double>>(n, std::vector<double>(n));
+    for (std::size_t k = 0; k < n; ++k) {
+        auto* column = a.data() + k * n;
+        auto& v = vs[k];
+        auto norm = 0.0;
+        for (std::size_t i = k; i < n; ++i) {
+            norm += column[i] * column[i];
+        }
+        norm = std::sqrt(norm);
+        // R[k][k] = alpha, of the sign avoiding cancellation
+        const auto alpha = column[k] > 0.0 ? -norm : norm;
+        signs[k] = alpha < 0.0 ? -1.0 : 1.0;
+        std::copy(column + k, column + n, v.begin() + k);
+        v[k] -= alpha;
+        auto length = 0.0;
+        for (std::size_t i = k; i < n; ++i) {
+            length += v[i] * v[i];
+        }
+        length = std::sqrt(length);
+        if (length == 0.0) {
+            // already triangular, the reflection is the identity
+            continue;
+        }
+        for (std::size_t i = k; i < n; ++i) {
+            v[i] /= length;
+        }
+        for (std::size_t j = k; j < n; ++j) {
+            reflect(a.data() + j * n, v, k);
+        }
+    }
+
+    // Q = H0 H1 ... H(n-1), applied right to left to the identity
+    for (std::size_t i = 0; i < n; ++i) {
+        q[i * n + i] = 1.0;
+    }
+    for (std::size_t k = n; k-- > 0;) {
+        if (std::all_of(vs[k].begin() + k, vs[k].end(),
+                        [](double x) { return x == 0.0; })) {
+            continue;
+        }
+        for (std::size_t j = k; j < n; ++j) {
+            reflect(q.data() + j * n, vs[k], k);
+        }
+    }
+
+    auto rotation = Matrix{n, n};
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            rotation(i, j) = q[j * n + i] * signs[j];
+        }
+    }
+    return rotation;
+}
+
+} // namespace cec22
@@ -1,38 +1,125 @@
 #include "GeneticAlgorithm.h"
 #include "Constants.h"
 
+#include <atomic>
 #include <cmath>
-#include <execution>
 #include <fstream>
 #include <iostream>
 #include <ranges>
+#include <thread>
 
 namespace ranges = std::ranges;
-namespace exec = std::execution;
 namespace cst = ga::constants;
 
 namespace ga {
 
 namespace {
 
-long long
-decodeBinaryVariable(const chromosome_cit begin, const chromosome_cit end)
+/// Bits of variable dimension of chromosome, the first one most significant
+std::uint64_t variableBits(ConstBitsRef chromosome, int dimension)
 {
-    return std::accumulate(begin, end, 0LL,
-                           [](auto f, auto elem) { return f * 2 + elem; });
+    return chromosome.field(dimension * cst::bitsPerVariable,
+                            cst::bitsPerVariable);
 }
 
-long long
-decodeGrayVariable(const chromosome_cit begin, const chromosome_cit end)
+[[gnu::always_inline]] inline std::uint64_t toGray(std::uint64_t bits)
 {
-    auto prev = *begin;
-    auto f = 0LL + prev;
-    for (auto it = std::next(begin); it != end; ++it) {
-        const auto temp = (*it ? not prev : prev);
-        f = f * 2 + temp;
-        prev = temp;
+    return bits ^ (bits >> 1);
+}
+
+/// Prefix xor of the bits, from the most significant one, in log steps
+[[gnu::always_inline]] inline std::uint64_t fromGray(std::uint64_t bits)
+{
+    for (auto shift = 1; shift < 64; shift *= 2) {
+        bits ^= bits >> shift;
+    }
+    return bits;
+}
+
+/// Applies convert to the bits of every variable of the chromosomes, one
+/// variable of all of them at a time so the position of its field is shared
+template <typename Convert>
+void convertVariables(PackedBitsArray& chromosomes, int dimensions,
+                      Convert convert)
+{
+    for (auto i = 0; i < dimensions; ++i) {
+        const auto begin = i * cst::bitsPerVariable;
+        for (std::size_t index = 0; index < chromosomes.size(); ++index) {
+            const auto chromosome = chromosomes[index];
+            const auto bits = chromosome.field(begin, cst::bitsPerVariable);
+            chromosome.setField(begin, cst::bitsPerVariable, convert(bits));
+        }
+    }
+}
+
+/// Bits of the variables of chromosome, variable i at words[i]
+void packVariables(ConstBitsRef chromosome, std::uint64_t* words,
+                   int dimensions)
+{
+    for (auto i = 0; i < dimensions; ++i) {
+        words[i] = variableBits(chromosome, i);
+    }
+}
+
+/// out[i] = value of the variable with the bits words[i], read as a gray code
+/// when gray. A gray code is decoded with the prefix xor of its bits, from the
+/// most significant one.
+[[gnu::always_inline]] inline void
+decodeWords(const std::uint64_t* words, double* out, std::size_t n, bool gray)
+{
+    // signed, which converts to double in vectors
+    static_assert(cst::bitsPerVariable <= 63);
+    const auto value = [](std::uint64_t bits) {
+        return static_cast<long long>(bits) / cst::discriminator *
+                   (cst::maximum - cst::minimum) +
+               cst::minimum;
+    };
+    if (gray) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = value(fromGray(words[i]));
+        }
+    } else {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = value(words[i]);
+        }
+    }
+}
+
+using Decoder = void (*)(const std::uint64_t*, double*, std::size_t, bool);
+
+// Builds of decodeWords for each instruction set of cec22::simd, picked with
+// its active one. avx512dq converts 64 bit integers to doubles in vectors.
+// clang-format off
+void decodeWordsSse2(const std::uint64_t* words, double* out, std::size_t n, bool gray) { decodeWords(words, out, n, gray); }
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+void decodeWordsAvx2(const std::uint64_t* words, double* out, std::size_t n, bool gray) { decodeWords(words, out, n, gray); }
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512dq,avx2,fma")
+void decodeWordsAvx512(const std::uint64_t* words, double* out, std::size_t n, bool gray) { decodeWords(words, out, n, gray); }
+#pragma GCC pop_options
+// clang-format on
+
+Decoder decoder()
+{
+    const auto isa = cec22::simd::active();
+    if (isa == cec22::simd::Isa::Avx512) {
+        return decodeWordsAvx512;
+    }
+    return isa == cec22::simd::Isa::Avx2 ? decodeWordsAvx2 : decodeWordsSse2;
+}
+
+/// Scratch words of the chromosomes decoded one at a time
+std::vector<std::uint64_t>& threadWords(std::size_t size)
+{
+    thread_local auto words = std::vector<std::uint64_t>{};
+    if (words.size() < size) {
+        words.resize(size);
     }
-    return f;
+    return words;
 }
 
 } // namespace
@@ -74,6 +161,7 @@ GeneticAlgorithm::GeneticAlgorithm(
     , populationSize{populationSize}
     , dimensions{dimensions}
     , bitsPerChromosome{dimensions * cst::bitsPerVariable}
+    , wordsPerChromosome{static_cast<int>(wordsFor(bitsPerChromosome))}
     , stepsToHypermutation{stepsToHypermutation}
     , encodingChangeRate{encodingChangeRate}
     , maxNoImprovementSteps{maxNoImprovementSteps}
@@ -95,20 +183,20 @@ GeneticAlgorithm::GeneticAlgorithm(
 void GeneticAlgorithm::sanityCheck()
 {
     std::cout << "GeneticAlgorithm::sanityCheck" << '\n';
-    population[0][2] = 0;
-    population[0][3] = 1;
+    population[0].set(2, false);
+    population[0].set(3, true);
     auto firstVal = evaluateChromosome(0);
     std::cout << firstVal << '\n';
-    binaryToGray(population[0], newPopulation[0]);
+    binaryToGray(population[0]);
 
-    decodingStrategy = decodeGrayVariable;
+    grayDecoding = true;
     auto secondVal = evaluateChromosome(0);
     if (secondVal != firstVal) {
         throw std::runtime_error{"Gray code conversion is not equivalent"};
     }
 
-    grayToBinary(population[0], newPopulation[0]);
-    decodingStrategy = decodeBinaryVariable;
+    grayToBinary(population[0]);
+    grayDecoding = false;
     if (firstVal != evaluateChromosome(0)) {
         throw std::runtime_error{"Binary to gray not working"};
     }
@@ -120,10 +208,11 @@ void GeneticAlgorithm::sanityCheck()
 
 void GeneticAlgorithm::randomizePopulationAndInitBest()
 {
-    for (auto& chromosome : population) {
-        for (auto bit : chromosome) {
-            bit = randomBool(gen); // bit is ref
-        }
+    // 64 random bits at a time, the whole buffer at once
+    auto words = population.words();
+    std::generate(words.begin(), words.end(), std::ref(gen));
+    for (auto i = 0; i < populationSize; ++i) {
+        population[i].clearFrom(bitsPerChromosome);
     }
     bestChromosome = population[0];
     bestValue = evaluateChromosome(0);
@@ -135,140 +224,106 @@ std::vector<double>& GeneticAlgorithm::decodeChromosome(std::size_t index)
 }
 
 std::vector<double>&
-GeneticAlgorithm::decodeChromosome(const chromosome& chromosome,
+GeneticAlgorithm::decodeChromosome(ConstBitsRef chromosome,
                                    std::size_t index)
 {
-    auto it = chromosome.cbegin();
-    for (auto i = 0; i < dimensions; ++i) {
-        const auto end = std::next(it, cst::bitsPerVariable);
-        decodings[index][i] = decodeDimension(it, end);
-        it = end;
-    }
+    decodeChromosome(chromosome, decodings[index]);
     return decodings[index];
 }
 
 std::vector<double>
-GeneticAlgorithm::decodeChromosome(const chromosome& chromosome) const
+GeneticAlgorithm::decodeChromosome(ConstBitsRef chromosome) const
 {
-    std::vector<double> x;
-    x.reserve(dimensions);
-    auto it = chromosome.cbegin();
-    for (auto i = 0; i < dimensions; ++i) {
-        const auto end = std::next(it, cst::bitsPerVariable);
-        x.push_back(decodeDimension(it, end));
-        it = end;
-    }
+    std::vector<double> x(dimensions);
+    decodeChromosome(chromosome, x);
     return x;
 }
 
-double GeneticAlgorithm::decodeDimension(const chromosome_cit begin,
-                                         const chromosome_cit end) const
+void GeneticAlgorithm::decodeChromosome(ConstBitsRef chromosome,
+                                        std::vector<double>& x) const
 {
-    return decodingStrategy(begin, end) / cst::discriminator *
-               (cst::maximum - cst::minimum) +
-           cst::minimum;
+    auto& words = threadWords(dimensions);
+    packVariables(chromosome, words.data(), dimensions);
+    decoder()(words.data(), x.data(), dimensions, grayDecoding);
 }
 
-void GeneticAlgorithm::binaryToGray(chromosome& binary, chromosome& gray)
+void GeneticAlgorithm::decodePopulation()
 {
-    // test this against the method bellow
-
-    // this has the advantage of doing std::vector::swap (3 * std::move), and
-    // only once, while the one bellow uses swap_ranges which actually iterates
-    // trough given range dimensions time, therefore O(chromosome.size())
+    // same layout as points, so all of it is decoded by one call. One
+    // variable of all chromosomes at a time, its field is in the same place.
     for (auto i = 0; i < dimensions; ++i) {
-        const auto begin = i * cst::bitsPerVariable;
-        const auto end = begin + cst::bitsPerVariable;
-
-        gray[begin] = binary[begin];
-        for (auto j = begin + 1; j < end; ++j) {
-            gray[j] = (binary[j - 1] != binary[j]); // xor
+        auto* variable = words.data() + i * populationSize;
+        for (auto index = 0; index < populationSize; ++index) {
+            variable[index] = variableBits(population[index], i);
         }
     }
-    std::swap(binary, gray);
+    decoder()(words.data(), points.data(), points.size(), grayDecoding);
 }
 
-void GeneticAlgorithm::binaryToGray(chromosome& binary)
+double GeneticAlgorithm::decodeDimension(ConstBitsRef chromosome,
+                                         int dimension) const
 {
-    std::array<gene, cst::bitsPerVariable> aux;
-    for (auto i = 0; i < dimensions; ++i) {
-        const auto begin = i * cst::bitsPerVariable;
-        const auto end = begin + cst::bitsPerVariable;
-
-        aux[0] = binary[begin];
-        for (auto j = begin + 1; j < end; ++j) {
-            aux[j - begin] = (binary[j - 1] != binary[j]);
-        }
-        std::swap_ranges(aux.begin(), aux.end(), binary.begin() + begin);
-    }
-    // doesn't seem to be used
+    const auto bits = variableBits(chromosome, dimension);
+    auto value = 0.0;
+    decoder()(&bits, &value, 1, grayDecoding);
+    return value;
 }
 
-void GeneticAlgorithm::grayToBinary(chromosome& gray, chromosome& binary)
+void GeneticAlgorithm::binaryToGray(BitsRef binary)
 {
     for (auto i = 0; i < dimensions; ++i) {
         const auto begin = i * cst::bitsPerVariable;
-        const auto end = begin + cst::bitsPerVariable;
-
-        binary[begin] = gray[begin];
-        for (auto j = begin + 1; j < end; ++j) {
-            binary[j] = gray[j] ? not binary[j - 1] : binary[j - 1];
-        }
+        const auto bits = binary.field(begin, cst::bitsPerVariable);
+        binary.setField(begin, cst::bitsPerVariable, toGray(bits));
     }
-    std::swap(binary, gray);
 }
 
-void GeneticAlgorithm::grayToBinary(chromosome& gray)
+void GeneticAlgorithm::grayToBinary(BitsRef gray)
 {
-    std::array<gene, cst::bitsPerVariable> aux;
     for (auto i = 0; i < dimensions; ++i) {
         const auto begin = i * cst::bitsPerVariable;
-        const auto end = begin + cst::bitsPerVariable;
-
-        aux[0] = gray[begin];
-        for (auto j = begin + 1; j < end; ++j) {
-            const auto auxIndex = j - begin;
-            aux[auxIndex] = gray[j] ? not aux[auxIndex - 1] : aux[auxIndex - 1];
-        }
-        std::swap_ranges(aux.begin(), aux.end(), gray.begin() + begin);
+        const auto bits = gray.field(begin, cst::bitsPerVariable);
+        gray.setField(begin, cst::bitsPerVariable, fromGray(bits));
     }
 }
 
 void GeneticAlgorithm::binaryToGreyPopulation()
 {
-    // Test
-    std::for_each(exec::unseq, indices.begin(), indices.end(),
-                  [this](auto index) {
-                      binaryToGray(population[index], newPopulation[index]);
-                  });
+    convertVariables(population, dimensions, toGray);
 }
 
 void GeneticAlgorithm::grayToBinaryPopulation()
 {
-    // Test
-    std::for_each(exec::unseq, indices.begin(), indices.end(),
-                  [this](auto index) {
-                      grayToBinary(population[index], newPopulation[index]);
-                  });
+    convertVariables(population, dimensions, fromGray);
 }
 
-double GeneticAlgorithm::evaluateChromosome(const chromosome& chromosome)
+double GeneticAlgorithm::evaluate(ConstBitsRef chromosome,
+                                  std::vector<double>& x,
+                                  std::vector<double>& aux)
 {
-    auto decoded = decodeChromosome(chromosome);
-    // copy used to cache result of rotate operation
-    // doesn't bring any benefit for this method, however it does for the index
-    // case
-    auto aux = decoded;
-    return function(decoded, aux);
+    decodeChromosome(chromosome, x);
+    if (climbing) {
+        // the cache is not shared between threads
+        return function(x, aux);
+    }
+    const auto* key = chromosome.words().data();
+    if (const auto value = cache.find(key, grayDecoding)) {
+        return *value;
+    }
+    const auto value = function(x, aux);
+    cache.insert(key, grayDecoding, value);
+    return value;
+}
+
+double GeneticAlgorithm::evaluateChromosome(ConstBitsRef chromosome)
+{
+    return evaluate(chromosome, decoded, decodedAux);
 }
 
 double
-GeneticAlgorithm::evaluateChromosomeAndUpdateBest(const chromosome& chromosome)
+GeneticAlgorithm::evaluateChromosomeAndUpdateBest(ConstBitsRef chromosome)
 {
-    auto decoded = decodeChromosome(chromosome);
-    auto aux = decoded;
-    // copy used to cache result of rotate operation
-    auto ret = function(decoded, aux);
+    const auto ret = evaluateChromosome(chromosome);
 
     if (ret < bestValue) {
         updateBestChromosome(ret, chromosome);
@@ -278,13 +333,13 @@ GeneticAlgorithm::evaluateChromosomeAndUpdateBest(const chromosome& chromosome)
 
 double GeneticAlgorithm::evaluateChromosome(std::size_t index)
 {
-    return function(decodeChromosome(index), auxiliars[index]);
+    return evaluate(population[index], decodings[index], auxiliars[index]);
 }
 
-double GeneticAlgorithm::evaluateChromosome(const chromosome& chromosome,
+double GeneticAlgorithm::evaluateChromosome(ConstBitsRef chromosome,
                                             std::size_t index)
 {
-    return function(decodeChromosome(chromosome, index), auxiliars[index]);
+    return evaluate(chromosome, decodings[index], auxiliars[index]);
 }
 
 double GeneticAlgorithm::evaluateChromosomeAndUpdateBest(std::size_t index)
@@ -302,13 +357,13 @@ void GeneticAlgorithm::updateBestChromosome(double newValue, std::size_t index)
     bestValue = newValue;
     bestChromosome = population[index];
     if (not isBinary) {
-        grayToBinary(bestChromosome, newPopulation[index]);
+        grayToBinary(bestChromosome);
     }
     lastImprovement = epoch;
 }
 
 void GeneticAlgorithm::updateBestChromosome(double newValue,
-                                            const chromosome& newBest)
+                                            ConstBitsRef newBest)
 {
     bestValue = newValue;
     bestChromosome = newBest;
@@ -320,25 +375,19 @@ void GeneticAlgorithm::updateBestChromosome(double newValue,
 
 void GeneticAlgorithm::evaluatePopulation()
 {
-    fitnesses[0] = evaluateChromosome(0);
-    auto minIndex = 0;
-    auto min = fitnesses[0];
-    auto max = fitnesses[0];
-
-    // TODO: Check what execution context can support these side effects
-    // (setting min, max, index)
-    std::transform(std::next(indices.begin()), indices.end(),
-                   std::next(fitnesses.begin()), [&](auto i) {
-                       auto value = evaluateChromosome(i);
-                       if (value < min) {
-                           minIndex = i;
-                           min = value;
-                       }
-                       if (value > max) {
-                           max = value;
-                       }
-                       return value;
-                   });
+    // evaluating the whole population in a single batched call
+    decodePopulation();
+    if (cache.capacity() == 0) {
+        function.evaluateBatch(points, fitnesses);
+    } else {
+        evaluatePopulationCached();
+    }
+
+    const auto [minIt, maxIt] =
+        std::minmax_element(fitnesses.begin(), fitnesses.end());
+    const auto minIndex = std::distance(fitnesses.begin(), minIt);
+    const auto min = *minIt;
+    const auto max = *maxIt;
 
     // update best
     if (min < bestValue) {
@@ -348,6 +397,52 @@ void GeneticAlgorithm::evaluatePopulation()
     computeSelectionProbabilities(normalizeFitness(min, max));
 }
 
+void GeneticAlgorithm::evaluatePopulationCached()
+{
+    // converged populations are mostly copies of a few chromosomes, so
+    // repeats within the population are looked up in pending. An eviction
+    // from pending only evaluates a repeat twice.
+    constexpr auto cached = static_cast<std::size_t>(-1);
+    pending.clear();
+    misses.clear();
+    for (auto index = 0; index < populationSize; ++index) {
+        const auto* key = population[index].words().data();
+        if (const auto value = cache.find(key, grayDecoding)) {
+            fitnesses[index] = *value;
+            positions[index] = cached;
+        } else if (const auto k = pending.find(key, grayDecoding)) {
+            positions[index] = static_cast<std::size_t>(*k);
+        } else {
+            positions[index] = misses.size();
+            pending.insert(key, grayDecoding, misses.size());
+            misses.push_back(index);
+        }
+    }
+    if (misses.empty()) {
+        return;
+    }
+
+    // the batch of misses, in the layout of points
+    const auto count = misses.size();
+    missPoints.resize(dimensions * count);
+    missValues.resize(count);
+    for (auto d = 0; d < dimensions; ++d) {
+        for (std::size_t k = 0; k < count; ++k) {
+            missPoints[d * count + k] = points[d * populationSize + misses[k]];
+        }
+    }
+    function.evaluateBatch(missPoints, missValues);
+    for (std::size_t k = 0; k < count; ++k) {
+        cache.insert(population[misses[k]].words().data(), grayDecoding,
+                     missValues[k]);
+    }
+    for (auto index = 0; index < populationSize; ++index) {
+        if (positions[index] != cached) {
+            fitnesses[index] = missValues[positions[index]];
+        }
+    }
+}
+
 void GeneticAlgorithm::updateBestFromPopulation()
 {
     std::for_each(indices.begin(), indices.end(),
@@ -379,43 +474,39 @@ void GeneticAlgorithm::computeSelectionProbabilities(double total)
                    });
 }
 
-chromosome GeneticAlgorithm::selectChromosome()
+std::size_t GeneticAlgorithm::selectChromosome()
 {
+    // first chromosome whose cumulative probability reaches random
     const auto random = randomDouble(gen);
-    for (auto i = 0; i < populationSize; ++i) {
-        if (random <= selectionProbabilities[i]) {
-            return population[i];
-        }
-    }
-    // this is returned by value hoping for RVO
-    // TODO: test
-    return population[populationSize - 1];
+    const auto it = std::lower_bound(selectionProbabilities.begin(),
+                                     selectionProbabilities.end(), random);
+    // rounding can leave the last cumulative probability below 1
+    return std::min<std::size_t>(
+        std::distance(selectionProbabilities.begin(), it), populationSize - 1);
 }
 
 void GeneticAlgorithm::selectNewPopulation()
 {
-
+    // the next population is chosen as indices, elites first
     if (elitesNumber > 0) {
-        // using indices for partial sorting
+        // using indices for partial sorting, by selection weight
         const auto elitesEnd = std::next(indices.begin(), elitesNumber);
-        std::nth_element(
-            indices.begin(), elitesEnd, indices.end(), [this](auto i, auto j) {
-                return selectionProbabilities[i] > selectionProbabilities[j];
-            });
-
-        // moving best elitesNumber chromosomes to elites
-        std::transform(indices.begin(), elitesEnd, newPopulation.begin(),
-                       [this](auto i) { return population[i]; });
+        std::nth_element(indices.begin(), elitesEnd, indices.end(),
+                         [this](auto i, auto j) {
+                             return fitnesses[i] > fitnesses[j];
+                         });
+        std::copy(indices.begin(), elitesEnd, selected.begin());
 
         // reseting indices
         std::iota(indices.begin(), indices.end(), 0);
     }
-    // skipping elites number for both iterators
-    std::transform(
-        std::next(population.begin(), elitesNumber), population.end(),
-        std::next(newPopulation.begin(), elitesNumber),
-        [this]([[maybe_unused]] auto& elem) { return selectChromosome(); });
-    // Swapping back
+    std::generate(std::next(selected.begin(), elitesNumber), selected.end(),
+                  [this]() { return selectChromosome(); });
+
+    // then gathered in one pass into the other buffer, and swapped back
+    for (auto k = 0; k < populationSize; ++k) {
+        newPopulation[k].assign(population[selected[k]]);
+    }
     population.swap(newPopulation);
 }
 
@@ -433,29 +524,47 @@ bool GeneticAlgorithm::stop() const
 
 void GeneticAlgorithm::mutatePopulation()
 {
-    // skipping half the elites
-    std::for_each(std::next(population.begin(), elitesNumber / 2),
-                  population.end(), [&](auto& x) { mutateChromosome(x); });
-    // This can be vectorized (std::execution::unseq), and tested if it brings
-    // any benefit for such a small population. Might do in the long run.
-    // Side effects due to using generator in multiple threads?
-}
-
-void GeneticAlgorithm::mutateChromosome(chromosome& chromosome)
-{
-    // TODO: maybe a faster solution would be to generate x indices to flip
-    for (auto bit : chromosome) {
-        if (randomDouble(gen) < mutationProbability) {
-            bit.flip();
+    // skipping half the elites, the rest of the population is one string of
+    // bits. Each bit flips with mutationProbability, so the gaps between flips
+    // are geometric and only the flips cost random numbers.
+    if (mutationProbability <= 0.0) {
+        return;
+    }
+    const auto first = elitesNumber / 2;
+    if (mutationProbability >= 1.0) {
+        // every bit flips. Hypermutation can get here, and
+        // std::geometric_distribution needs p < 1.
+        for (auto i = first; i < populationSize; ++i) {
+            const auto chromosome = population[i];
+            for (auto& word : chromosome.words()) {
+                word = ~word;
+            }
+            chromosome.clearFrom(bitsPerChromosome);
         }
+        return;
+    }
+    const auto bits = static_cast<long long>(populationSize - first) *
+                      bitsPerChromosome;
+    std::geometric_distribution<long long> gap{mutationProbability};
+    for (auto bit = gap(gen); bit < bits; bit += gap(gen) + 1) {
+        population[first + bit / bitsPerChromosome].flip(bit %
+                                                         bitsPerChromosome);
     }
-    // This solution would not work if using vector of char
-    // TODO: Add template specialization for bool and char for these kind of
-    // methods
 }
 
 // TODO: Try Omax vs Ofast vs O3 vs O2
 
+template <CrossoverType type> void GeneticAlgorithm::crossoverPopulation()
+{
+    if constexpr (type == CrossoverType::Chaotic) {
+        crossoverPopulationChaotic();
+    } else if constexpr (type == CrossoverType::Classic) {
+        crossoverPopulationClassic();
+    } else {
+        crossoverPopulationSorted();
+    }
+}
+
 void GeneticAlgorithm::crossoverPopulationChaotic()
 {
     // TODO: A crossover strategy in which we reverse the order of crossed over
@@ -509,44 +618,74 @@ void GeneticAlgorithm::crossoverPopulationSorted()
 
 void GeneticAlgorithm::crossoverChromosomes(std::size_t i, std::size_t j)
 {
-    // TODO: Maybe we could do crossover by using different operations,
-    // for example xor and or nor
-    // Try to add crossover strategies and use them
-
-    const auto slicePosition = randomBitIndex(gen);
-    for (auto k = 0; k < slicePosition; ++k) {
-        population[i].swap(population[i][k], population[j][k]);
+    // whole words are swapped, only the words cut by a point are masked
+    if (crossoverOperator == CrossoverOperator::SinglePoint) {
+        const auto slicePosition = randomBitIndex(gen);
+        population[i].swapPrefix(population[j], slicePosition);
+        return;
     }
-
-    // TODO: should be a template specialization
-    // Swap version for vector of char, might not work for bool because
-    // iterator is not LegacyForwardIterator
-    //
-    // const auto end = std::next(population[i].begin(), randomBitIndex(gen));
-    // std::swap_ranges(population[i].begin(), end, population[j].begin());
-    //
-    // this can and might be worth vectorizing for char, because char has
-    // LegacyContiguousIterator and each chromosome has 350 bits
+    if (crossoverOperator == CrossoverOperator::TwoPoint) {
+        const auto first = randomBitIndex(gen);
+        const auto second = randomBitIndex(gen);
+        population[i].swapRange(population[j], std::min(first, second),
+                                std::max(first, second));
+        return;
+    }
+    // each bit swapped with probability 1/2. The bits past bitsPerChromosome
+    // are 0 in both, so they need no clearing.
+    auto mask = crossoverMask.words();
+    std::generate(mask.begin(), mask.end(), std::ref(gen));
+    population[i].swapMasked(population[j], crossoverMask);
 }
 
-void GeneticAlgorithm::hillclimbPopulation()
+void GeneticAlgorithm::hillclimbPopulation(int calls)
 {
-    // unsequential execution
-    std::for_each(exec::unseq, indices.begin(), indices.end(),
-                  [this](auto index) { hillclimbChromosome(index); });
-    // TODO: test all execution contexts to check if there is any improvement
+    const auto before = count();
+    climbLimit = before + calls;
+    // the budget may run out before every member is climbed, so after a
+    // generation the best ones go first. Before, the members are random.
+    const auto order = epoch > 0 ? rankPopulation() : indices;
+    std::visit(
+        [&](auto policy) {
+            hillclimbPopulation<decltype(policy)::value>(order);
+        },
+        hillclimbingStrategy);
+    climbCalls += count() - before;
 }
 
-void GeneticAlgorithm::hillclimbChromosome(std::size_t index)
+template <HillclimbingType type>
+void GeneticAlgorithm::hillclimbPopulation(
+    const std::vector<std::size_t>& order)
 {
-    hillclimbChromosome(population[index], index);
+    // the workers claim members one at a time. A member has its own
+    // decodings, auxiliars, neighbours and streams, so what workers share is
+    // only next and the function call count.
+    std::atomic<int> next{0};
+    const auto work = [&]() {
+        for (auto k = next++; k < populationSize and climbBudgetLeft();
+             k = next++) {
+            applyHillclimbing<type>(population[order[k]], order[k]);
+        }
+    };
+    climbing = true;
+    {
+        std::vector<std::jthread> workers;
+        const auto threads = std::min(hillclimbThreads, populationSize);
+        for (auto i = 1; i < threads; ++i) {
+            workers.emplace_back(work);
+        }
+        work();
+    }
+    climbing = false;
 }
 
 void GeneticAlgorithm::hillclimbBest()
 {
+    // up to the budget of the run
+    climbLimit = maxSteps;
     auto previousBest = bestValue;
     isBinary = true;
-    decodingStrategy = decodeBinaryVariable;
+    grayDecoding = false;
     // default encoding and values for current best
 
     auto isFirst = true;
@@ -554,11 +693,11 @@ void GeneticAlgorithm::hillclimbBest()
 
     while (true) {
         if (isBinary) {
-            decodingStrategy = decodeGrayVariable;
-            binaryToGray(best, newPopulation[0]);
+            grayDecoding = true;
+            binaryToGray(best);
         } else {
-            decodingStrategy = decodeBinaryVariable;
-            grayToBinary(best, newPopulation[0]);
+            grayDecoding = false;
+            grayToBinary(best);
         }
         isBinary = not isBinary;
 
@@ -571,9 +710,8 @@ void GeneticAlgorithm::hillclimbBest()
             hillclimbChromosome(best, 0);
             // using 1st index because its free
         } catch (const std::exception& exception) {
-            auto decoded = decodeChromosome(best);
-            auto aux = decoded;
-            auto ret = function.f(decoded, aux);
+            decodeChromosome(best, decoded);
+            auto ret = function.f(decoded, decodedAux);
             if (ret < bestValue) {
                 bestValue = ret;
             }
@@ -581,10 +719,8 @@ void GeneticAlgorithm::hillclimbBest()
             return;
         }
 
-        auto decoded = decodeChromosome(best);
-        auto aux = decoded;
-        // copy used to cache result of rotate operation
-        auto ret = function.f(decoded, aux);
+        decodeChromosome(best, decoded);
+        auto ret = function.f(decoded, decodedAux);
         if (ret < bestValue) {
             bestValue = ret;
         }
@@ -598,89 +734,148 @@ void GeneticAlgorithm::hillclimbBest()
     }
 }
 
-void GeneticAlgorithm::hillclimbChromosome(chromosome& chromosome,
+void GeneticAlgorithm::hillclimbChromosome(BitsRef chromosome,
                                            std::size_t index)
 {
-    auto best = std::move(chromosome); // moving from chromosome
-    applyHillclimbing(best, index);    // doing complex operations in here
-    chromosome = std::move(best);      // moving back to chromosome
+    std::visit(
+        [&](auto policy) {
+            applyHillclimbing<decltype(policy)::value>(chromosome, index);
+        },
+        hillclimbingStrategy);
 }
 
-void GeneticAlgorithm::applyHillclimbing(chromosome& chromosome,
+template <HillclimbingType type>
+void GeneticAlgorithm::applyHillclimbing(BitsRef chromosome,
                                          std::size_t index)
 {
-    for (auto progress = true; progress;) {
-        progress = hillclimbingStrategy(chromosome, index);
+    // the only full evaluation of the start, each step goes on from the value
+    // improves confirmed, with decodings[index] holding its point
+    auto value = evaluateChromosome(chromosome, index);
+    for (auto progress = true; progress and climbBudgetLeft();) {
+        progress = hillclimbingStep<type>(chromosome, index, value);
     }
 }
 
-bool GeneticAlgorithm::firstImprovementHillclimbing(chromosome& chromosome,
-                                                    std::size_t index)
+template <HillclimbingType type>
+bool GeneticAlgorithm::hillclimbingStep(BitsRef chromosome,
+                                        std::size_t index, double& value)
 {
-    const auto bestValue = evaluateChromosome(chromosome, index);
+    if constexpr (type == HillclimbingType::FirstImprovement) {
+        return firstImprovementHillclimbing(chromosome, index, value);
+    } else if constexpr (type == HillclimbingType::FirstImprovementRandom) {
+        return firstImprovementRandomHillclimbing(chromosome, index, value);
+    } else {
+        return bestImprovementHillclimbing(chromosome, index, value);
+    }
+}
 
-    // this is a std::_Bit_iterator::reference
-    for (auto bit : chromosome) {
-        bit.flip();
-        const auto value = evaluateChromosome(chromosome, index);
-        if (value < bestValue) {
+bool GeneticAlgorithm::firstImprovementHillclimbing(BitsRef chromosome,
+                                                    std::size_t index,
+                                                    double& value)
+{
+    neighbours[index].reset(decodings[index]);
+
+    for (auto i = 0; i < bitsPerChromosome and climbBudgetLeft(); ++i) {
+        chromosome.flip(i);
+        if (evaluateNeighbour(chromosome, index, i) < value and
+            improves(chromosome, index, value)) {
             return true;
             // returning before flipping back
         }
-        bit.flip();
+        chromosome.flip(i);
     }
     return false; // no improvement could be done
 }
 
 bool GeneticAlgorithm::firstImprovementRandomHillclimbing(
-    chromosome& chromosome, std::size_t index)
+    BitsRef chromosome, std::size_t index, double& value)
 {
-    // cannot use member indices to sort them because of concurrency issues
-    const auto bestValue = evaluateChromosome(chromosome, index);
+    // cannot use member indices to sort them because of concurrency issues,
+    // nor gen, the bits come from the stream of index
+    auto randomBit = randomBitIndex;
+    neighbours[index].reset(decodings[index]);
 
     // should we do more or less tries?
-    for (std::size_t tries = 0; tries < chromosome.size(); ++tries) {
-        const auto i = randomBitIndex(gen);
-        chromosome[i].flip();
+    for (auto tries = 0; tries < bitsPerChromosome and climbBudgetLeft();
+         ++tries) {
+        const auto i = randomBit(streams[index]);
+        chromosome.flip(i);
 
-        const auto value = evaluateChromosome(chromosome, index);
-        if (value < bestValue) {
+        if (evaluateNeighbour(chromosome, index, i) < value and
+            improves(chromosome, index, value)) {
             return true;
             // returning before flipping back
         }
-        chromosome[i].flip();
+        chromosome.flip(i);
     }
     return false;
 }
 
-bool GeneticAlgorithm::bestImprovementHillclimbing(chromosome& chromosome,
-                                                   std::size_t index)
+bool GeneticAlgorithm::bestImprovementHillclimbing(BitsRef chromosome,
+                                                   std::size_t index,
+                                                   double& value)
 {
     // cannot use member indices because of concurrency issues
-    auto bestValue = evaluateChromosome(chromosome, index);
+    neighbours[index].reset(decodings[index]);
+    auto bestValue = value;
     auto bestIndex = 0;
     auto updated = false;
 
-    for (std::size_t i = 0; i < chromosome.size(); ++i) {
-        chromosome[i].flip();
+    for (auto i = 0; i < bitsPerChromosome and climbBudgetLeft(); ++i) {
+        chromosome.flip(i);
 
-        const auto value = evaluateChromosome(chromosome, index);
+        const auto value = evaluateNeighbour(chromosome, index, i);
         if (value < bestValue) {
             updated = true;
             bestIndex = i;
             bestValue = value;
         }
 
-        chromosome[i].flip();
+        chromosome.flip(i);
     }
 
     if (not updated) {
         return false;
     }
-    chromosome[bestIndex].flip();
+    chromosome.flip(bestIndex);
+    if (not improves(chromosome, index, value)) {
+        chromosome.flip(bestIndex);
+        return false;
+    }
     return true;
 }
 
+double GeneticAlgorithm::evaluateNeighbour(ConstBitsRef chromosome,
+                                           std::size_t index, std::size_t bit)
+{
+    // a bit flip changes only the variable holding the bit
+    const auto dimension = bit / cst::bitsPerVariable;
+    const auto value = decodeDimension(chromosome, dimension);
+    return function(neighbours[index], dimension, value);
+}
+
+bool GeneticAlgorithm::climbBudgetLeft() const
+{
+    return count() < climbLimit;
+}
+
+int GeneticAlgorithm::hillclimbBudget() const
+{
+    return hillclimbThreads > 0 ? static_cast<int>(hillclimbShare * maxSteps)
+                                : 0;
+}
+
+bool GeneticAlgorithm::improves(ConstBitsRef chromosome,
+                                std::size_t index, double& value)
+{
+    const auto confirmed = evaluateChromosome(chromosome, index);
+    if (confirmed < value) {
+        value = confirmed;
+        return true;
+    }
+    return false;
+}
+
 void GeneticAlgorithm::adapt()
 {
     // hypermutation
@@ -692,10 +887,10 @@ void GeneticAlgorithm::adapt()
     // changing encodings is good to go over hamming walls
     if (epoch % encodingChangeRate == 0) {
         if (isBinary) {
-            decodingStrategy = decodeGrayVariable;
+            grayDecoding = true;
             binaryToGreyPopulation();
         } else {
-            decodingStrategy = decodeBinaryVariable;
+            grayDecoding = false;
             grayToBinaryPopulation();
         }
         isBinary = not isBinary;
@@ -707,6 +902,43 @@ int GeneticAlgorithm::count() const
     return function.count();
 }
 
+void GeneticAlgorithm::useSinglePrecision(double threshold)
+{
+    function.useSinglePrecision(threshold);
+}
+
+void GeneticAlgorithm::useFitnessCache(std::size_t capacity)
+{
+    cache = FitnessCache{capacity,
+                         static_cast<std::size_t>(wordsPerChromosome)};
+}
+
+const FitnessCache& GeneticAlgorithm::fitnessCache() const
+{
+    return cache;
+}
+
+void GeneticAlgorithm::useHillclimbing(int threads, double share)
+{
+    hillclimbThreads = threads;
+    hillclimbShare = share;
+}
+
+int GeneticAlgorithm::hillclimbingCount() const
+{
+    return climbCalls;
+}
+
+int GeneticAlgorithm::hillclimbingThreads() const
+{
+    return hillclimbThreads;
+}
+
+void GeneticAlgorithm::useCrossoverOperator(CrossoverOperator type)
+{
+    crossoverOperator = type;
+}
+
 std::string GeneticAlgorithm::toString() const
 {
     return function.toString() + "Best: " + std::to_string(bestValue) + '\n';
@@ -718,7 +950,7 @@ void GeneticAlgorithm::printBest() const
     printChromosome(bestChromosome);
 }
 
-void GeneticAlgorithm::printChromosome(const chromosome& chromosome) const
+void GeneticAlgorithm::printChromosome(ConstBitsRef chromosome) const
 {
     // TODO: make template for bool
     const auto decoded = decodeChromosome(chromosome);
@@ -728,45 +960,85 @@ void GeneticAlgorithm::printChromosome(const chromosome& chromosome) const
     std::cout << '\n';
 }
 
-void GeneticAlgorithm::printChromosomeRepr(const chromosome& chromosome) const
+void GeneticAlgorithm::printChromosomeRepr(ConstBitsRef chromosome) const
 {
     const auto decoded = decodeChromosome(chromosome);
-    int i = 0;
-    for (const auto bit : chromosome) {
-        if (i++ % cst::bitsPerVariable == 0) {
+    for (auto i = 0; i < bitsPerChromosome; ++i) {
+        if (i % cst::bitsPerVariable == 0) {
             std::cout << '\n';
-            std::cout << decoded[(i - 1) / cst::bitsPerVariable] << '\n';
+            std::cout << decoded[i / cst::bitsPerVariable] << '\n';
         }
-        std::cout << bit;
+        std::cout << chromosome[i];
     }
     std::cout << '\n';
 }
 
 void GeneticAlgorithm::printPopulation() const
 {
-    std::for_each(
-        population.begin(), population.end(),
-        [this](const auto& chromosome) { printChromosome(chromosome); });
+    for (auto i = 0; i < populationSize; ++i) {
+        printChromosome(population[i]);
+    }
 }
 
 double GeneticAlgorithm::run()
 {
+    start();
+    // a generation costs populationSize calls, finish evaluates the
+    // population once and climbs on what start left of the hillclimbing
+    const auto finishCalls =
+        populationSize + hillclimbBudget() - hillclimbBudget() / 2;
+    const auto last = maxSteps - finishCalls - populationSize;
+    while (count() <= last and step()) {
+    }
+    return finish();
+}
+
+void GeneticAlgorithm::start()
+{
+    start(hillclimbBudget() / 2);
+}
+
+void GeneticAlgorithm::start(int calls)
+{
+    epoch = 0;
+    climbCalls = 0;
     randomizePopulationAndInitBest();
-    // hillclimbPopulation();
+    if (hillclimbThreads > 0) {
+        hillclimbPopulation(calls);
+    }
     updateBestFromPopulation();
+}
 
-    for (epoch = 0; epoch < maxSteps / populationSize - 1; ++epoch) {
-        // std::cout << "Epoch: " << epoch << ' ' << function.count() << '\n';
-        if (stop()) {
-            break;
-        }
-        adapt();
+bool GeneticAlgorithm::step()
+{
+    // std::cout << "Epoch: " << epoch << ' ' << function.count() << '\n';
+    if (stop()) {
+        return false;
+    }
+    adapt();
+
+    mutatePopulation();
+    std::visit(
+        [this](auto policy) {
+            crossoverPopulation<decltype(policy)::value>();
+        },
+        crossoverStrategy);
+    evaluateAndSelect();
+    ++epoch;
+    return true;
+}
 
-        mutatePopulation();
-        crossoverPopulationStrategy();
-        evaluateAndSelect();
+double GeneticAlgorithm::finish()
+{
+    // all but the last evaluation of the population
+    return finish(maxSteps - populationSize - count());
+}
+
+double GeneticAlgorithm::finish(int calls)
+{
+    if (hillclimbThreads > 0) {
+        hillclimbPopulation(calls);
     }
-    // hillclimbPopulation();
     // printPopulation();
     updateBestFromPopulation();
     // hillclimbBest();
@@ -774,18 +1046,88 @@ double GeneticAlgorithm::run()
     return bestValue;
 }
 
+std::vector<std::size_t> GeneticAlgorithm::rankPopulation() const
+{
+    // the population was selected from the last evaluated one, so the weight
+    // of member k is the one of selected[k]
+    auto ranks = std::vector<std::size_t>(populationSize);
+    std::iota(ranks.begin(), ranks.end(), 0);
+    std::stable_sort(ranks.begin(), ranks.end(), [this](auto i, auto j) {
+        return fitnesses[selected[i]] > fitnesses[selected[j]];
+    });
+    return ranks;
+}
+
+std::vector<chromosome> GeneticAlgorithm::emigrants(int count)
+{
+    const auto ranks = rankPopulation();
+    count = std::min(count, populationSize);
+    auto migrants = std::vector<chromosome>{};
+    migrants.reserve(count);
+    for (auto k = 0; k < count; ++k) {
+        migrants.push_back(population[ranks[k]]);
+        if (not isBinary) {
+            grayToBinary(migrants.back());
+        }
+    }
+    return migrants;
+}
+
+void GeneticAlgorithm::immigrate(const std::vector<chromosome>& migrants,
+                                 Replacement replacement)
+{
+    const auto ranks = rankPopulation();
+    const auto count = std::min<std::size_t>(migrants.size(), populationSize);
+    for (std::size_t k = 0; k < count; ++k) {
+        const auto index = replacement == Replacement::Worst
+                               ? ranks[populationSize - 1 - k]
+                               : radomChromosome(gen);
+        population[index].assign(migrants[k]);
+        if (not isBinary) {
+            binaryToGray(population[index]);
+        }
+    }
+}
+
+int GeneticAlgorithm::maxCalls() const
+{
+    return maxSteps;
+}
+
+int GeneticAlgorithm::size() const
+{
+    return populationSize;
+}
+
 void GeneticAlgorithm::initContainers()
 {
+    // population will be randomized at each run call
+    population = PackedBitsArray{static_cast<std::size_t>(populationSize),
+                                 static_cast<std::size_t>(wordsPerChromosome)};
+    newPopulation = population;
+    bestChromosome = chromosome{static_cast<std::size_t>(wordsPerChromosome)};
+    crossoverMask = bestChromosome;
     for (auto i = 0; i < populationSize; ++i) {
-        population.push_back(chromosome(bitsPerChromosome, true));
-        // population will be randomized at each run call
-        newPopulation.push_back(chromosome(bitsPerChromosome, true));
         decodings.push_back(std::vector<double>(dimensions, 0.0));
         auxiliars.push_back(std::vector<double>(dimensions, 0.0));
+        neighbours.push_back(function.deltaEvaluator());
+        streams.push_back(RandomStream{gen()});
     }
 
+    decoded.resize(dimensions);
+    decodedAux.resize(dimensions);
+    points.resize(dimensions * populationSize);
+    words.resize(dimensions * populationSize);
+    // the cache is off until useFitnessCache
+    pending = FitnessCache{2 * static_cast<std::size_t>(populationSize),
+                           static_cast<std::size_t>(wordsPerChromosome)};
+    misses.reserve(populationSize);
+    positions.resize(populationSize);
+    missPoints.reserve(dimensions * populationSize);
+    missValues.reserve(populationSize);
     fitnesses.resize(populationSize);
     selectionProbabilities.resize(populationSize);
+    selected.resize(populationSize);
     indices.resize(populationSize);
     std::iota(indices.begin(), indices.end(), 0);
 }
@@ -793,37 +1135,31 @@ void GeneticAlgorithm::initContainers()
 void GeneticAlgorithm::initStrategies(CrossoverType crossoverType,
                                       HillclimbingType hillclimbingType)
 {
-    decodingStrategy = decodeBinaryVariable;
+    grayDecoding = false;
 
-    crossoverPopulationStrategy = [&]() -> std::function<void()> {
+    crossoverStrategy = [&]() -> CrossoverStrategy {
         if (crossoverType == CrossoverType::Chaotic) {
-            return [this]() { crossoverPopulationChaotic(); };
+            return CrossoverPolicy<CrossoverType::Chaotic>{};
         }
         if (crossoverType == CrossoverType::Classic) {
-            return [this]() { crossoverPopulationClassic(); };
+            return CrossoverPolicy<CrossoverType::Classic>{};
         }
         if (crossoverType == CrossoverType::Sorted) {
-            return [this]() { crossoverPopulationSorted(); };
+            return CrossoverPolicy<CrossoverType::Sorted>{};
         }
         throw std::runtime_error{"Unknown CrossoverType"};
     }();
 
-    hillclimbingStrategy =
-        [&]() -> std::function<bool(chromosome&, std::size_t)> {
+    hillclimbingStrategy = [&]() -> HillclimbingStrategy {
         if (hillclimbingType == HillclimbingType::FirstImprovement) {
-            return [this](chromosome& chromosome, std::size_t index) {
-                return firstImprovementHillclimbing(chromosome, index);
-            };
+            return HillclimbingPolicy<HillclimbingType::FirstImprovement>{};
         }
         if (hillclimbingType == HillclimbingType::FirstImprovementRandom) {
-            return [this](chromosome& chromosome, std::size_t index) {
-                return firstImprovementRandomHillclimbing(chromosome, index);
-            };
+            return HillclimbingPolicy<
+                HillclimbingType::FirstImprovementRandom>{};
         }
         if (hillclimbingType == HillclimbingType::BestImprovement) {
-            return [this](chromosome& chromosome, std::size_t index) {
-                return bestImprovementHillclimbing(chromosome, index);
-            };
+            return HillclimbingPolicy<HillclimbingType::BestImprovement>{};
         }
         throw std::runtime_error{"Implement the others"};
     }();
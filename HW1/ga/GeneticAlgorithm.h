@@ -1,15 +1,21 @@
 #pragma once
+#include "Constants.h"
+#include "FitnessCache.h"
 #include "FunctionManager.h"
+#include "PackedBits.h"
+#include "RandomStream.h"
 
-#include <functional>
+#include <cstdint>
 #include <random>
 #include <string>
+#include <type_traits>
+#include <variant>
 
 namespace ga {
 
-using gene = bool;
-using chromosome = std::vector<gene>;
-using chromosome_cit = chromosome::const_iterator; // rename?, or remove?
+/// A copy of a member of the population, the members themselves are spans of
+/// one buffer, see PackedBitsArray
+using chromosome = PackedBits;
 
 enum class CrossoverType
 {
@@ -18,6 +24,21 @@ enum class CrossoverType
     Sorted,
 };
 
+/// How the bits of a pair are exchanged, see PackedBits
+enum class CrossoverOperator
+{
+    SinglePoint,
+    TwoPoint,
+    Uniform,
+};
+
+/// Members replaced by migrants, see GeneticAlgorithm::immigrate
+enum class Replacement
+{
+    Worst,
+    Random,
+};
+
 enum class HillclimbingType
 {
     BestImprovement,
@@ -25,7 +46,27 @@ enum class HillclimbingType
     FirstImprovementRandom,
 };
 
-// TODO: Maybe use template for population size
+// Statically typed strategies, one type per CrossoverType and
+// HillclimbingType. The strategy is a template argument of the loops running
+// it, so a visit of the variant picks the loop once per generation or
+// hillclimbing pass, and the steps inside call the strategy directly.
+template <CrossoverType Type>
+using CrossoverPolicy = std::integral_constant<CrossoverType, Type>;
+template <HillclimbingType Type>
+using HillclimbingPolicy = std::integral_constant<HillclimbingType, Type>;
+
+using CrossoverStrategy =
+    std::variant<CrossoverPolicy<CrossoverType::Chaotic>,
+                 CrossoverPolicy<CrossoverType::Classic>,
+                 CrossoverPolicy<CrossoverType::Sorted>>;
+using HillclimbingStrategy =
+    std::variant<HillclimbingPolicy<HillclimbingType::BestImprovement>,
+                 HillclimbingPolicy<HillclimbingType::FirstImprovement>,
+                 HillclimbingPolicy<HillclimbingType::FirstImprovementRandom>>;
+
+// Population size and dimensions stay runtime parameters: the experiments
+// sweep them, and chromosomes are sized for dimensions when the algorithm is
+// built. Only the strategies are static.
 class GeneticAlgorithm
 {
   public:
@@ -40,11 +81,58 @@ class GeneticAlgorithm
                      bool applyRotation);
     void sanityCheck();
     double run();
+    /// run in parts, for drivers interleaving several algorithms: start, step
+    /// while it returns true and the budget allows, then finish, which returns
+    /// the best value. A step is one generation, populationSize calls.
+    void start();
+    bool step();
+    double finish();
+    /// start and finish for drivers that budget the hillclimbing themselves,
+    /// climbing at most calls calls. The others climb their part of
+    /// hillclimbBudget().
+    void start(int calls);
+    double finish(int calls);
+    /// Copies of the count best members, binary encoded. Valid after a step.
+    std::vector<chromosome> emigrants(int count);
+    /// Replaces the worst or random members with migrants, binary encoded.
+    /// They are evaluated with the next step.
+    void immigrate(const std::vector<chromosome>& migrants,
+                   Replacement replacement);
+    /// Function calls of a run
+    int maxCalls() const;
+    int size() const;
     void printBest() const; // TODO: also add stream to print to
     std::string toString() const;
     int count() const;
+    /// Population evaluations in mixed precision until the best value falls
+    /// below threshold, see FunctionManager::useSinglePrecision
+    void useSinglePrecision(double threshold);
+    /// Memoizes the values of exact chromosome repeats in capacity slots, 0
+    /// turns it off, which is the default. Repeats are not function calls, so
+    /// count() leaves them out. Values come from whichever precision evaluated
+    /// them first. Pays off when function calls cost more than hashing.
+    void useFitnessCache(std::size_t capacity);
+    const FitnessCache& fitnessCache() const;
+    /// The exchange used by every CrossoverType, SinglePoint by default
+    void useCrossoverOperator(CrossoverOperator type);
+    /// Hillclimbs the population at the start and at the end of run, on
+    /// threads threads counting the calling one. 0, the default, turns it off.
+    /// Climbing takes share of maxCalls(), half at the start and the rest at
+    /// the end, and the generations get what is left. Workers stop once the
+    /// share is spent, which may go over it by a few calls per thread.
+    void useHillclimbing(int threads,
+                         double share = constants::hillclimbingShare);
+    /// Function calls useHillclimbing sets aside for the climbing of a run
+    int hillclimbBudget() const;
+    /// Function calls of the hillclimbing of the last run
+    int hillclimbingCount() const;
+    /// Threads of useHillclimbing, 0 when it is off
+    int hillclimbingThreads() const;
 
   private:
+    /// reaches the operators from the tests, see test/operators.cpp
+    friend struct GeneticAlgorithmProbe;
+
     void randomizePopulationAndInitBest();
 
     /// Decoding chromosome and returning reference to vector to avoid
@@ -52,35 +140,44 @@ class GeneticAlgorithm
     std::vector<double>& decodeChromosome(std::size_t index);
     /// uses decodings[index]
     std::vector<double>&
-    decodeChromosome(const chromosome& chromosome, std::size_t index);
+    decodeChromosome(ConstBitsRef chromosome, std::size_t index);
     /// Decoding version for chromosome which creates new vector
-    std::vector<double> decodeChromosome(const chromosome& chromosome) const;
-
-    /// decodes one dimension from the chromosome, given by bounds
-    double
-    decodeDimension(const chromosome_cit begin, const chromosome_cit end) const;
-
-    /// convert from one encoding to another using an auxiliar
-    void binaryToGray(chromosome& binary, chromosome& gray);
-    void grayToBinary(chromosome& gray, chromosome& binary);
-    /// convert from one encoding to another without an auxiliar
-    void binaryToGray(chromosome& binary);
-    void grayToBinary(chromosome& gray);
+    std::vector<double> decodeChromosome(ConstBitsRef chromosome) const;
+    /// Decoding into x, which has dimensions elements, without allocating
+    void decodeChromosome(ConstBitsRef chromosome,
+                          std::vector<double>& x) const;
+
+    /// Decodes all population into points, as a structure-of-arrays block
+    void decodePopulation();
+
+    /// decodes one dimension from the chromosome
+    double decodeDimension(ConstBitsRef chromosome, int dimension) const;
+
+    /// convert from one encoding to another in place, a variable at a time
+    void binaryToGray(BitsRef binary);
+    void grayToBinary(BitsRef gray);
     void binaryToGreyPopulation();
     void grayToBinaryPopulation();
 
+    /// decodes chromosome into x and evaluates it, with the cache
+    double evaluate(ConstBitsRef chromosome, std::vector<double>& x,
+                    std::vector<double>& aux);
+    /// fitnesses of the decoded population: repeats from the cache, the
+    /// others evaluated once each in one batch
+    void evaluatePopulationCached();
+
     /// evaluating chromosomes outside of population
     /// uses decodeChromosome 2nd overload
-    double evaluateChromosome(const chromosome& chromosome);
-    double evaluateChromosomeAndUpdateBest(const chromosome& chromosome);
+    double evaluateChromosome(ConstBitsRef chromosome);
+    double evaluateChromosomeAndUpdateBest(ConstBitsRef chromosome);
     /// evaluating population members by index
     double evaluateChromosome(std::size_t index);
     /// evaluates chromosome outside of population, but uses decodings[index]
     /// for decoding
-    double evaluateChromosome(const chromosome& chromosome, std::size_t index);
+    double evaluateChromosome(ConstBitsRef chromosome, std::size_t index);
     double evaluateChromosomeAndUpdateBest(std::size_t index);
 
-    void updateBestChromosome(double newValue, const chromosome& newBest);
+    void updateBestChromosome(double newValue, ConstBitsRef newBest);
     void updateBestChromosome(double newValue, std::size_t index);
 
     /// this has to be done sequentially
@@ -95,9 +192,11 @@ class GeneticAlgorithm
     /// dividing by the total sum
     void computeSelectionProbabilities(double total);
 
-    // TODO: return by value then assign, or return by reference then assign?
-    chromosome selectChromosome();
-    /// copies in newPopulation selected chromosomes, then swaps vectors
+    /// roulette wheel, index of the chosen chromosome by binary search of the
+    /// cumulative probabilities
+    std::size_t selectChromosome();
+    /// selects the indices of the next population, gathers them into
+    /// newPopulation, then swaps vectors
     void selectNewPopulation();
 
     /// evaluates and selects the next generation
@@ -107,8 +206,9 @@ class GeneticAlgorithm
 
     /// we mutate all population except half the elites
     void mutatePopulation();
-    void mutateChromosome(chromosome& chromosome);
 
+    /// the crossover of type
+    template <CrossoverType type> void crossoverPopulation();
     /// select unique chormozomes for crossover and for each of them do
     /// crossover with one (any) random chromosome (could even be itself, is
     /// this ok?)
@@ -118,19 +218,47 @@ class GeneticAlgorithm
     /// sorting indices and doing crossover only for indices with value lower
     /// than crossoverProbability
     void crossoverPopulationSorted();
+    /// exchanges bits of population[i] and population[j] with
+    /// crossoverOperator
     void crossoverChromosomes(std::size_t i, std::size_t j);
 
-    /// applies one iteration of hillclimbing to all population
-    void hillclimbPopulation(); // TODO: test std::threads vs execution::unseq
-    void hillclimbChromosome(std::size_t index);
-    void hillclimbChromosome(chromosome& chromosome, std::size_t index);
+    /// hillclimbs the population on at most calls function calls, the
+    /// members spread over hillclimbThreads
+    void hillclimbPopulation(int calls);
+    /// climbs the members in order until climbLimit
+    template <HillclimbingType type>
+    void hillclimbPopulation(const std::vector<std::size_t>& order);
+    /// whether function.count() is below climbLimit
+    bool climbBudgetLeft() const;
+    void hillclimbChromosome(BitsRef chromosome, std::size_t index);
     void hillclimbBest();
-    void applyHillclimbing(chromosome& chromosome, std::size_t index);
-    bool
-    firstImprovementHillclimbing(chromosome& chromosome, std::size_t index);
-    bool firstImprovementRandomHillclimbing(chromosome& chromosome,
-                                            std::size_t index);
-    bool bestImprovementHillclimbing(chromosome& chromosome, std::size_t index);
+    /// climbs until a step of type finds no improvement
+    template <HillclimbingType type>
+    void applyHillclimbing(BitsRef chromosome, std::size_t index);
+    /// a step from chromosome, of value and decoded in decodings[index]. On an
+    /// improvement both are updated.
+    template <HillclimbingType type>
+    bool hillclimbingStep(BitsRef chromosome, std::size_t index,
+                          double& value);
+    bool firstImprovementHillclimbing(BitsRef chromosome,
+                                      std::size_t index, double& value);
+    bool firstImprovementRandomHillclimbing(BitsRef chromosome,
+                                            std::size_t index, double& value);
+    bool bestImprovementHillclimbing(BitsRef chromosome, std::size_t index,
+                                     double& value);
+    /// value of chromosome, which differs only in bit from the point
+    /// neighbours[index] was reset to. Evaluated incrementally.
+    double evaluateNeighbour(ConstBitsRef chromosome, std::size_t index,
+                             std::size_t bit);
+    /// whether chromosome is better than value, confirmed by a full evaluation
+    /// so that rounding of the incremental ones cannot fake an improvement.
+    /// If it is, value becomes the confirmed one.
+    bool improves(ConstBitsRef chromosome, std::size_t index,
+                  double& value);
+
+    /// Indices of the members, best first, by the weights of their last
+    /// evaluation
+    std::vector<std::size_t> rankPopulation() const;
 
     /// Adaptation of hyperparameters depending on various factors
     void adapt();
@@ -140,26 +268,48 @@ class GeneticAlgorithm
     void initContainers();
     void initStrategies(CrossoverType crossoverType,
                         HillclimbingType hillclimbingType);
-    void initDistributions(
-        int populationSize); // we will not need this if template Size
+    void initDistributions(int populationSize);
 
-    void printChromosome(const chromosome& chromosome) const;
-    void printChromosomeRepr(const chromosome& chromosome) const;
+    void printChromosome(ConstBitsRef chromosome) const;
+    void printChromosomeRepr(ConstBitsRef chromosome) const;
     void printPopulation() const;
 
-    // TODO: test against char, might be faster because std::vector<double> is
-    // space efficient but not time efficient
-    std::vector<chromosome> population;
-    std::vector<chromosome> newPopulation;
+    // packed chromosomes, each population in one contiguous buffer with
+    // wordsPerChromosome words per member
+    PackedBitsArray population;
+    PackedBitsArray newPopulation;
     std::vector<std::vector<double>> decodings;
     // used to optimize rotate operation
     std::vector<std::vector<double>> auxiliars;
+    // incremental evaluation of the hillclimbing neighbours
+    std::vector<cec22::DeltaEvaluator> neighbours;
+    // random bits of the hillclimbing of each member, independent of the
+    // thread it runs on
+    std::vector<RandomStream> streams;
+    // decoding and auxiliar of chromosomes outside of population
+    std::vector<double> decoded;
+    std::vector<double> decodedAux;
+    // decoded population, points[d * populationSize + i] is dimension d of
+    // chromosome i
+    std::vector<double> points;
+    // bits of the variables of the population, in the layout of points
+    std::vector<std::uint64_t> words;
+    // keyed by the used words of the chromosomes
+    FitnessCache cache;
+    // misses of one population evaluation, keyed like cache, valued by their
+    // position in the batch
+    FitnessCache pending;
+    // population indices of the batch of misses
+    std::vector<std::size_t> misses;
+    // position in the batch of the value of each chromosome, if not cached
+    std::vector<std::size_t> positions;
+    std::vector<double> missPoints;
+    std::vector<double> missValues;
     std::vector<double> fitnesses;
     std::vector<double> selectionProbabilities;
+    // population indices of the next population
+    std::vector<std::size_t> selected;
     std::vector<std::size_t> indices; // [0, ..populationSize)
-    // considering population.size() == decoding.size() == fitnesses.size() ==
-    // selectionProbabilities.size() == population, it might be an idea to use
-    // std array
 
     chromosome bestChromosome;
     double bestValue;
@@ -173,9 +323,11 @@ class GeneticAlgorithm
     const double selectionPressure;
 
     const int maxSteps;
-    const int populationSize;    // TODO: make template Size
-    const int dimensions;        // TODO: use constexpr
-    const int bitsPerChromosome; // TODO: make template bitsPerChromosome
+    const int populationSize;
+    const int dimensions;
+    // the used bits of chromosome, dimensions variables
+    const int bitsPerChromosome;
+    const int wordsPerChromosome;
     const int stepsToHypermutation;
     const int encodingChangeRate;
     const int maxNoImprovementSteps;
@@ -188,16 +340,24 @@ class GeneticAlgorithm
 
     std::random_device seed;
     std::mt19937_64 gen{seed()};
-    std::bernoulli_distribution randomBool;
     std::uniform_real_distribution<double> randomDouble{0.0, 1.0};
     std::uniform_int_distribution<> radomChromosome; // initialized in ctor
     std::uniform_int_distribution<> randomBitIndex;  // initialized in ctor
 
-    /// applies decoding within bounds
-    std::function<long long(const chromosome_cit, const chromosome_cit)>
-        decodingStrategy;
-    std::function<void()> crossoverPopulationStrategy;
-    std::function<bool(chromosome&, std::size_t)> hillclimbingStrategy;
+    /// whether the variables are decoded as gray codes
+    bool grayDecoding = false;
+    CrossoverOperator crossoverOperator = CrossoverOperator::SinglePoint;
+    int hillclimbThreads = 0;
+    double hillclimbShare = 0.0;
+    /// function.count() at which the running hillclimbing stops
+    int climbLimit = 0;
+    int climbCalls = 0;
+    /// whether hillclimbPopulation is running, evaluations skip the cache
+    bool climbing = false;
+    // bits exchanged by a uniform crossover
+    chromosome crossoverMask;
+    CrossoverStrategy crossoverStrategy;
+    HillclimbingStrategy hillclimbingStrategy;
     FunctionManager function;
 };
 
@@ -0,0 +1,149 @@
+#include "IslandModel.h"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace ga {
+
+IslandModel::IslandModel(int islandCount, const Factory& make,
+                         Migration migration)
+    : migration{migration}
+{
+    if (islandCount < 1 or migration.interval < 1) {
+        throw std::runtime_error{"Islands need an island and an interval"};
+    }
+    for (auto i = 0; i < islandCount; ++i) {
+        islands.push_back(make());
+    }
+    // room for a few migrations in flight on each pair
+    const auto capacity = 4 * static_cast<std::size_t>(migration.migrants);
+    for (auto i = 0; i < islandCount * islandCount; ++i) {
+        queues.push_back(std::make_unique<SpscQueue<chromosome>>(capacity));
+    }
+    bests.resize(islandCount);
+}
+
+double IslandModel::run()
+{
+    // migrants left over from the last run
+    for (auto& queue : queues) {
+        while (queue->pop()) {
+        }
+    }
+    // the evaluations of start and finish are set aside, the rest is taken a
+    // generation at a time, or as the climbing of an island, by whichever
+    // island gets there first
+    auto reserved = 0LL;
+    for (const auto& island : islands) {
+        reserved += 2LL * island->size() + 1;
+    }
+    std::atomic<long long> budget{islands.front()->maxCalls() - reserved};
+    {
+        std::vector<std::jthread> threads;
+        for (std::size_t i = 0; i < islands.size(); ++i) {
+            threads.emplace_back([this, i, &budget]() { runIsland(i, budget); });
+        }
+    }
+    return *std::min_element(bests.begin(), bests.end());
+}
+
+void IslandModel::runIsland(std::size_t island, std::atomic<long long>& budget)
+{
+    auto& ga = *islands[island];
+    auto stream = RandomStream{std::random_device{}() + island};
+    const auto generation = static_cast<long long>(ga.size());
+    // the island's part of the climbing is reserved at once, half of it
+    // climbs now and finish gets the rest. What the budget cannot cover is
+    // not climbed.
+    const auto climbing = static_cast<long long>(ga.hillclimbBudget()) /
+                          static_cast<long long>(islands.size());
+    const auto granted =
+        climbing > 0 ? std::clamp(budget.fetch_sub(climbing), 0LL, climbing)
+                     : 0LL;
+
+    ga.start(static_cast<int>(granted / 2));
+    for (auto epoch = 1; budget.fetch_sub(generation) >= generation; ++epoch) {
+        if (not ga.step()) {
+            break;
+        }
+        if (epoch % migration.interval == 0) {
+            migrate(island, stream);
+        }
+    }
+    bests[island] =
+        ga.finish(static_cast<int>(granted) - ga.hillclimbingCount());
+}
+
+void IslandModel::migrate(std::size_t island, RandomStream& stream)
+{
+    auto& ga = *islands[island];
+    const auto n = islands.size();
+    if (n > 1) {
+        const auto migrants = ga.emigrants(migration.migrants);
+        const auto send = [&](std::size_t to) {
+            for (const auto& migrant : migrants) {
+                // dropped when to is behind on taking them in
+                queue(island, to).push(migrant);
+            }
+        };
+        if (migration.topology == Topology::Ring) {
+            send((island + 1) % n);
+        } else if (migration.topology == Topology::Random) {
+            // any island but this one
+            const auto to = stream() % (n - 1);
+            send(to < island ? to : to + 1);
+        } else {
+            for (std::size_t to = 0; to < n; ++to) {
+                if (to != island) {
+                    send(to);
+                }
+            }
+        }
+    }
+
+    auto arrived = std::vector<chromosome>{};
+    for (std::size_t from = 0; from < n; ++from) {
+        if (from == island) {
+            continue;
+        }
+        while (const auto migrant = queue(from, island).pop()) {
+            arrived.push_back(*migrant);
+        }
+    }
+    if (not arrived.empty()) {
+        ga.immigrate(arrived, migration.replacement);
+    }
+}
+
+SpscQueue<chromosome>& IslandModel::queue(std::size_t from, std::size_t to)
+{
+    return *queues[from * islands.size() + to];
+}
+
+int IslandModel::count() const
+{
+    auto calls = 0;
+    for (const auto& island : islands) {
+        calls += island->count();
+    }
+    return calls;
+}
+
+int IslandModel::size() const
+{
+    return static_cast<int>(islands.size());
+}
+
+IslandModel getDefaultIslands(const std::string& functionName,
+                              int islandCount)
+{
+    return {islandCount, [&functionName]() {
+                // built in place, GeneticAlgorithm cannot be moved
+                return std::unique_ptr<GeneticAlgorithm>(
+                    new GeneticAlgorithm(getDefault(functionName)));
+            }};
+}
+
+} // namespace ga
@@ -0,0 +1,71 @@
+#pragma once
+#include "GeneticAlgorithm.h"
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ga {
+
+/// Islands migrants are sent to
+enum class Topology
+{
+    Ring,   // the next island
+    Random, // one other island, chosen each time
+    Full,   // every other island
+};
+
+struct Migration {
+    Topology topology = Topology::Ring;
+    /// generations between migrations
+    int interval = 20;
+    /// best members sent to each target
+    int migrants = 2;
+    Replacement replacement = Replacement::Worst;
+};
+
+/// Runs several GeneticAlgorithm instances at once, one thread each, on the
+/// function call budget of a single run. Every interval generations an island
+/// sends copies of its best members to others and takes in the migrants that
+/// arrived. Migrants travel through one lock-free queue per ordered pair of
+/// islands, so islands never wait for each other; a migrant that finds its
+/// queue full is dropped.
+class IslandModel
+{
+  public:
+    using Factory = std::function<std::unique_ptr<GeneticAlgorithm>()>;
+
+    /// islandCount algorithms made by make, which should all solve the same
+    /// function. An island that hillclimbs takes its share of
+    /// hillclimbBudget() from the shared budget before it starts.
+    IslandModel(int islandCount, const Factory& make,
+                Migration migration = {});
+
+    /// Best value found by any island. Generations and climbing are reserved
+    /// from the shared budget before they run, so together the islands make
+    /// at most maxCalls() calls, and a few more per climbing thread.
+    double run();
+    /// Function calls of all islands
+    int count() const;
+    int size() const;
+
+  private:
+    void runIsland(std::size_t island, std::atomic<long long>& budget);
+    void migrate(std::size_t island, RandomStream& stream);
+    SpscQueue<chromosome>& queue(std::size_t from, std::size_t to);
+
+    std::vector<std::unique_ptr<GeneticAlgorithm>> islands;
+    // queues[from * islands.size() + to]
+    std::vector<std::unique_ptr<SpscQueue<chromosome>>> queues;
+    std::vector<double> bests;
+    Migration migration;
+};
+
+/// islandCount islands of getDefault(functionName), default migration
+IslandModel getDefaultIslands(const std::string& functionName,
+                              int islandCount);
+
+} // namespace ga
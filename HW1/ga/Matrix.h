@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace cec22 {
+
+/// Allocator returning memory aligned to Alignment bytes, so rows can be read
+/// with aligned vector loads
+template <typename T, std::size_t Alignment> struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U> struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(
+            ::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept
+    {
+        ::operator delete(p, std::align_val_t{Alignment});
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept
+    {
+        return true;
+    }
+};
+
+/// Row-major matrix stored in one contiguous, 64 byte aligned buffer. Rows are
+/// padded with zeros up to a multiple of lanes doubles, so every row starts
+/// aligned and kernels can read whole vectors without a tail loop. A view reads
+/// the same layout from memory owned elsewhere, e.g. a mapped DataBundle, and
+/// is read only.
+class Matrix
+{
+  public:
+    static constexpr std::size_t alignment = 64;
+    static constexpr std::size_t lanes = 4;
+
+    Matrix() = default;
+
+    Matrix(std::size_t rows, std::size_t columns)
+        // clang-format off
+        : rows_{rows}
+        , columns_{columns}
+        , stride_{(columns + lanes - 1) / lanes * lanes}
+        , data_(rows * stride_, 0.0)
+    // clang-format on
+    {
+    }
+
+    /// Read only matrix over rows * stride doubles at data, which must outlive
+    /// it and all its copies
+    static Matrix view(std::size_t rows, std::size_t columns, const double* data)
+    {
+        auto matrix = Matrix{};
+        matrix.rows_ = rows;
+        matrix.columns_ = columns;
+        matrix.stride_ = (columns + lanes - 1) / lanes * lanes;
+        matrix.view_ = data;
+        return matrix;
+    }
+
+    std::size_t rows() const
+    {
+        return rows_;
+    }
+    std::size_t columns() const
+    {
+        return columns_;
+    }
+    /// distance between the beginnings of two consecutive rows
+    std::size_t stride() const
+    {
+        return stride_;
+    }
+    bool empty() const
+    {
+        return rows_ == 0;
+    }
+
+    const double* row(std::size_t i) const
+    {
+        return (view_ ? view_ : data_.data()) + i * stride_;
+    }
+    double* row(std::size_t i)
+    {
+        return data_.data() + i * stride_;
+    }
+
+    double operator()(std::size_t i, std::size_t j) const
+    {
+        return row(i)[j];
+    }
+    double& operator()(std::size_t i, std::size_t j)
+    {
+        return row(i)[j];
+    }
+
+  private:
+    std::size_t rows_ = 0;
+    std::size_t columns_ = 0;
+    std::size_t stride_ = 0;
+    std::vector<double, AlignedAllocator<double, alignment>> data_;
+    const double* view_ = nullptr;
+};
+
+} // namespace cec22
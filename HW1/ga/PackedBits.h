@@ -0,0 +1,317 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ga {
+
+/// 64 bit words holding bits bits
+constexpr std::size_t wordsFor(std::size_t bits)
+{
+    return (bits + 63) / 64;
+}
+
+/// Bit string packed into 64 bit words owned elsewhere, read only when Word
+/// is const. Bit i is bit 63 - i % 64 of word i / 64, so the bits of a run
+/// spell its integer value, first bit most significant. Bits past the used
+/// ones are kept 0, which lets copies, comparisons and combinations work on
+/// whole words. Like std::span, a const span still writes its bits.
+template <typename Word>
+class BitSpan
+{
+  public:
+    using word = std::remove_const_t<Word>;
+    static constexpr std::size_t wordBits = 64;
+    static constexpr bool writable = not std::is_const_v<Word>;
+
+    BitSpan(Word* data, std::size_t words)
+        : data{data}
+        , count{words}
+    {
+    }
+    operator BitSpan<const word>() const
+    {
+        return {data, count};
+    }
+
+    std::size_t capacity() const
+    {
+        return count * wordBits;
+    }
+    std::span<Word> words() const
+    {
+        return {data, count};
+    }
+
+    bool operator[](std::size_t i) const
+    {
+        return data[i / wordBits] & maskOf(i);
+    }
+    void set(std::size_t i, bool value) const
+        requires writable
+    {
+        if (value) {
+            data[i / wordBits] |= maskOf(i);
+        } else {
+            data[i / wordBits] &= ~maskOf(i);
+        }
+    }
+    void flip(std::size_t i) const
+        requires writable
+    {
+        data[i / wordBits] ^= maskOf(i);
+    }
+
+    /// Bits [begin, begin + width) as an integer, 0 < width <= 64. A field may
+    /// straddle two words.
+    word field(std::size_t begin, std::size_t width) const
+    {
+        const auto w = begin / wordBits;
+        const auto offset = begin % wordBits;
+        auto bits = data[w] << offset;
+        if (offset + width > wordBits) {
+            bits |= data[w + 1] >> (wordBits - offset);
+        }
+        return bits >> (wordBits - width);
+    }
+    /// Writes value, which fits in width bits, to bits [begin, begin + width)
+    void setField(std::size_t begin, std::size_t width, word value) const
+        requires writable
+    {
+        const auto w = begin / wordBits;
+        const auto offset = begin % wordBits;
+        const auto mask = ~word{0} >> (wordBits - width);
+        if (offset + width <= wordBits) {
+            const auto shift = wordBits - offset - width;
+            data[w] = (data[w] & ~(mask << shift)) | (value << shift);
+            return;
+        }
+        // the last spill bits go to the next word
+        const auto spill = offset + width - wordBits;
+        data[w] = (data[w] & ~(mask >> spill)) | (value >> spill);
+        data[w + 1] = (data[w + 1] & (~word{0} >> spill)) |
+                      (value << (wordBits - spill));
+    }
+
+    /// Copies the bits of other, which has as many words
+    void assign(BitSpan<const word> other) const
+        requires writable
+    {
+        std::copy_n(other.words().begin(), count, data);
+    }
+    /// Swaps the bits set in mask with other
+    void swapMasked(BitSpan other, BitSpan<const word> mask) const
+        requires writable
+    {
+        for (std::size_t w = 0; w < count; ++w) {
+            swapWord(other, w, mask.words()[w]);
+        }
+    }
+    /// Swaps bits [begin, end) with other, masking only the first and the last
+    /// of the words they span
+    void swapRange(BitSpan other, std::size_t begin, std::size_t end) const
+        requires writable
+    {
+        if (begin >= end) {
+            return;
+        }
+        const auto first = begin / wordBits;
+        const auto last = (end - 1) / wordBits;
+        if (first == last) {
+            swapWord(other, first,
+                     spanMask(begin % wordBits, end - last * wordBits));
+            return;
+        }
+        swapWord(other, first, spanMask(begin % wordBits, wordBits));
+        for (auto w = first + 1; w < last; ++w) {
+            std::swap(data[w], other.data[w]);
+        }
+        swapWord(other, last, spanMask(0, end - last * wordBits));
+    }
+    /// Swaps bits [0, end) with other
+    void swapPrefix(BitSpan other, std::size_t end) const
+        requires writable
+    {
+        swapRange(other, 0, end);
+    }
+    /// Zeroes bits [begin, capacity)
+    void clearFrom(std::size_t begin) const
+        requires writable
+    {
+        for (auto w = wordsFor(begin); w < count; ++w) {
+            data[w] = 0;
+        }
+        if (const auto rest = begin % wordBits) {
+            data[begin / wordBits] &= ~word{0} << (wordBits - rest);
+        }
+    }
+
+    friend bool operator==(BitSpan a, BitSpan b)
+    {
+        return std::ranges::equal(a.words(), b.words());
+    }
+
+  private:
+    static constexpr word maskOf(std::size_t i)
+    {
+        return word{1} << (wordBits - 1 - i % wordBits);
+    }
+    /// Bits [begin, end) of a word, 0 <= begin < end <= 64
+    static constexpr word spanMask(std::size_t begin, std::size_t end)
+    {
+        const auto after = end < wordBits ? ~word{0} >> end : word{0};
+        return (~word{0} >> begin) & ~after;
+    }
+    void swapWord(BitSpan other, std::size_t w, word mask) const
+    {
+        const auto diff = (data[w] ^ other.data[w]) & mask;
+        data[w] ^= diff;
+        other.data[w] ^= diff;
+    }
+
+    Word* data;
+    std::size_t count;
+};
+
+using BitsRef = BitSpan<std::uint64_t>;
+using ConstBitsRef = BitSpan<const std::uint64_t>;
+
+/// Bit string of a capacity chosen at run time, owning its words. See BitSpan
+/// for the layout, the operations are those of its span.
+class PackedBits
+{
+  public:
+    using word = std::uint64_t;
+
+    PackedBits() = default;
+    explicit PackedBits(std::size_t words)
+        : data(words)
+    {
+    }
+    /// a copy of bits
+    template <typename Word>
+    PackedBits(BitSpan<Word> bits)
+        : data(bits.words().begin(), bits.words().end())
+    {
+    }
+    /// copies bits, reusing the words held
+    template <typename Word> PackedBits& operator=(BitSpan<Word> bits)
+    {
+        data.assign(bits.words().begin(), bits.words().end());
+        return *this;
+    }
+
+    operator BitsRef()
+    {
+        return {data.data(), data.size()};
+    }
+    operator ConstBitsRef() const
+    {
+        return {data.data(), data.size()};
+    }
+
+    std::size_t capacity() const
+    {
+        return data.size() * BitsRef::wordBits;
+    }
+    std::span<word> words()
+    {
+        return data;
+    }
+    std::span<const word> words() const
+    {
+        return data;
+    }
+
+    bool operator[](std::size_t i) const
+    {
+        return ConstBitsRef{*this}[i];
+    }
+    void set(std::size_t i, bool value)
+    {
+        BitsRef{*this}.set(i, value);
+    }
+    void flip(std::size_t i)
+    {
+        BitsRef{*this}.flip(i);
+    }
+    word field(std::size_t begin, std::size_t width) const
+    {
+        return ConstBitsRef{*this}.field(begin, width);
+    }
+    void setField(std::size_t begin, std::size_t width, word value)
+    {
+        BitsRef{*this}.setField(begin, width, value);
+    }
+    void swapMasked(BitsRef other, ConstBitsRef mask)
+    {
+        BitsRef{*this}.swapMasked(other, mask);
+    }
+    void swapRange(BitsRef other, std::size_t begin, std::size_t end)
+    {
+        BitsRef{*this}.swapRange(other, begin, end);
+    }
+    void swapPrefix(BitsRef other, std::size_t end)
+    {
+        BitsRef{*this}.swapPrefix(other, end);
+    }
+    void clearFrom(std::size_t begin)
+    {
+        BitsRef{*this}.clearFrom(begin);
+    }
+
+    bool operator==(const PackedBits&) const = default;
+
+  private:
+    std::vector<word> data;
+};
+
+/// size bit strings of the same number of words, one after the other in a
+/// single buffer
+class PackedBitsArray
+{
+  public:
+    using word = std::uint64_t;
+
+    PackedBitsArray() = default;
+    PackedBitsArray(std::size_t size, std::size_t words)
+        : data(size * words)
+        , stride{words}
+    {
+    }
+
+    BitsRef operator[](std::size_t i)
+    {
+        return {data.data() + i * stride, stride};
+    }
+    ConstBitsRef operator[](std::size_t i) const
+    {
+        return {data.data() + i * stride, stride};
+    }
+    std::size_t size() const
+    {
+        return stride == 0 ? 0 : data.size() / stride;
+    }
+    /// the words of every bit string, in order
+    std::span<word> words()
+    {
+        return data;
+    }
+
+    void swap(PackedBitsArray& other) noexcept
+    {
+        data.swap(other.data);
+        std::swap(stride, other.stride);
+    }
+
+  private:
+    std::vector<word> data;
+    std::size_t stride = 0;
+};
+
+} // namespace ga
@@ -0,0 +1,63 @@
+#include "ProblemData.h"
+
+#include <algorithm>
+#include <future>
+#include <map>
+#include <mutex>
+
+namespace cec22 {
+namespace {
+
+ProblemData withSingleRotate(ProblemData data)
+{
+    const auto& rotate = data.rotate;
+    data.singleRotate.resize(rotate.rows() * rotate.stride());
+    for (std::size_t i = 0; i < rotate.rows(); ++i) {
+        std::copy_n(rotate.row(i), rotate.stride(),
+                    data.singleRotate.begin() + i * rotate.stride());
+    }
+    return data;
+}
+
+} // namespace
+
+std::shared_ptr<const ProblemData>
+problemData(const ProblemKey& key, const std::function<ProblemData()>& load)
+{
+    using Data = std::shared_ptr<const ProblemData>;
+    static std::mutex mutex;
+    static std::map<ProblemKey, std::shared_future<Data>> registry;
+
+    // generated data can take seconds to load, so the lock only guards the
+    // registry. The first caller of a key loads it outside the lock, later
+    // ones wait on its future, and other keys load meanwhile.
+    auto promise = std::promise<Data>{};
+    auto future = std::shared_future<Data>{};
+    auto loads = false;
+    {
+        std::lock_guard lock{mutex};
+        auto it = registry.find(key);
+        if (it == registry.end()) {
+            it = registry.emplace(key, promise.get_future().share()).first;
+            loads = true;
+        }
+        future = it->second;
+    }
+    if (loads) {
+        try {
+            promise.set_value(
+                std::make_shared<const ProblemData>(withSingleRotate(load())));
+        } catch (...) {
+            // the callers waiting meanwhile get the exception, the next ones
+            // load again
+            {
+                std::lock_guard lock{mutex};
+                registry.erase(key);
+            }
+            promise.set_exception(std::current_exception());
+        }
+    }
+    return future.get();
+}
+
+} // namespace cec22
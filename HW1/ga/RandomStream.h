@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ga {
+
+/// Counter based random bit generator. The n-th number of a stream is a hash
+/// of its key and n, so a stream carries no state shared with the others and
+/// can be used by any thread. Satisfies UniformRandomBitGenerator.
+class RandomStream
+{
+  public:
+    using result_type = std::uint64_t;
+
+    RandomStream() = default;
+    explicit RandomStream(std::uint64_t seed)
+        : key{mix(seed)}
+    {
+    }
+
+    static constexpr result_type min()
+    {
+        return 0;
+    }
+    static constexpr result_type max()
+    {
+        return ~result_type{0};
+    }
+    result_type operator()()
+    {
+        return mix(key + ++counter * 0x9e3779b97f4a7c15ULL);
+    }
+
+  private:
+    /// splitmix64 finalizer
+    static constexpr std::uint64_t mix(std::uint64_t x)
+    {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    std::uint64_t key = 0;
+    std::uint64_t counter = 0;
+};
+
+} // namespace ga
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace ga {
+
+/// Bounded lock-free queue for one producer thread and one consumer thread. A
+/// ring of capacity slots, rounded up to a power of two. Neither side ever
+/// waits: push fails when the ring is full and pop when it is empty.
+template <typename T>
+class SpscQueue
+{
+  public:
+    explicit SpscQueue(std::size_t capacity)
+        : slots(std::bit_ceil(std::max<std::size_t>(capacity, 1)))
+    {
+    }
+
+    /// Producer side
+    bool push(const T& value)
+    {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == slots.size()) {
+            return false;
+        }
+        slots[tail & (slots.size() - 1)] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    /// Consumer side
+    std::optional<T> pop()
+    {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+        auto value = std::move(slots[head & (slots.size() - 1)]);
+        head_.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+  private:
+    std::vector<T> slots;
+    // on separate cache lines, each written by one side only
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+};
+
+} // namespace ga
@@ -1,6 +1,7 @@
 
 #include "Cec22.h"
 #include "GeneticAlgorithm.h"
+#include "IslandModel.h"
 
 #include <execution>
 #include <fstream>
@@ -24,6 +25,18 @@ int main(int argc, char** argv)
         } else if (argv[1] == std::string{"2"}) {
             runExperiments2(argv[2]);
             return 0;
+        } else if (argv[1] == std::string{"check"}) {
+            const auto batch = cec22::batch::sanity_check();
+            const auto fixed = cec22::fixed::sanity_check();
+            return batch and fixed ? 0 : 1;
+        } else if (argv[1] == std::string{"convert"}) {
+            ga::convertInputData();
+            return 0;
+        } else if (argv[1] == std::string{"islands"} and argc > 2) {
+            const auto count = argc > 3 ? std::stoi(argv[3]) : 4;
+            auto islands = ga::getDefaultIslands(argv[2], count);
+            std::cout << islands.run() << '\n' << islands.count() << '\n';
+            return 0;
         }
         
         std::ofstream fout{"experiments/10/2/" + std::string{argv[1]}};
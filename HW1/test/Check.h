@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Helpers shared by the tests and benchmarks in this directory
+
+namespace test {
+
+/// whether any check failed, the test returns 1 if so
+inline auto failed = false;
+
+/// prints what, marked ok or FAIL, and records a failure
+inline void check(bool ok, const std::string& what)
+{
+    failed = failed or not ok;
+    std::cout << (ok ? "ok   " : "FAIL ") << what << '\n';
+}
+
+/// keeps the timed calls from being optimized away
+inline volatile double sink = 0.0;
+
+/// ns per call of f, averaged over repetitions calls
+template <typename F> double nsPerCall(int repetitions, F&& f)
+{
+    auto total = 0.0;
+    const auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < repetitions; ++i) {
+        total += f();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    sink = total;
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           repetitions;
+}
+
+} // namespace test
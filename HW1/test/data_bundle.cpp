@@ -0,0 +1,93 @@
+#include "../ga/DataBundle.h"
+#include "../ga/FunctionManager.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Every function must give the same values whether its data comes from the
+// text files, from the binary bundle, or from the text files again because
+// the bundle is corrupted. Run from HW1, reads input_data.
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr auto points = 100;
+
+/// A copy of input_data under root, the bundles are cached per directory
+fs::path makeRoot(const fs::path& root)
+{
+    fs::remove_all(root);
+    fs::create_directories(root);
+    fs::copy("input_data", root / "input_data");
+    return root;
+}
+
+std::vector<double> evaluate(const fs::path& root, const std::string& name,
+                             int dimensions)
+{
+    setenv("GA_ROOT", root.c_str(), 1);
+    ga::FunctionManager function{name, dimensions, true, true};
+
+    std::mt19937_64 gen{42};
+    std::uniform_real_distribution<double> dist{-100.0, 100.0};
+    std::vector<double> x(dimensions);
+    std::vector<double> aux(dimensions);
+    std::vector<double> values;
+    for (auto i = 0; i < points; ++i) {
+        for (auto& v : x) {
+            v = dist(gen);
+        }
+        values.push_back(function(x, aux));
+    }
+    return values;
+}
+
+} // namespace
+
+int main()
+{
+    const auto temp = fs::temp_directory_path() / "cec22_data_bundle";
+    const auto text = makeRoot(temp / "text");
+    const auto bundle = makeRoot(temp / "bundle");
+    const auto corrupted = makeRoot(temp / "corrupted");
+    using cec22::DataBundle;
+
+    DataBundle::write((bundle / "input_data/").string());
+    DataBundle::write((corrupted / "input_data/").string());
+    {
+        // flips a payload byte, the checksum no longer matches
+        const auto file = corrupted / "input_data" / DataBundle::fileName;
+        std::fstream f{file, std::ios::in | std::ios::out | std::ios::binary};
+        f.seekp(static_cast<std::streamoff>(fs::file_size(file) - 1));
+        f.put('\x7f');
+    }
+
+    const std::vector<std::string> functions = {
+        "zakharov_func", "rosenbrock_func", "schaffer_F7_func",
+        "rastrigin_func", "levy_func", "hf01", "hf02", "hf03", "cf01", "cf02",
+        "cf03", "cf04"};
+
+    auto failed = not DataBundle::find((bundle / "input_data/").string()) or
+                  DataBundle::find((corrupted / "input_data/").string());
+    if (failed) {
+        std::cout << "FAIL the bundle was not opened, or the corrupted one\n";
+    }
+    for (const auto dimensions : {10, 20}) {
+        for (const auto& name : functions) {
+            const auto expected = evaluate(text, name, dimensions);
+            const auto ok = evaluate(bundle, name, dimensions) == expected and
+                            evaluate(corrupted, name, dimensions) == expected;
+            failed = failed or not ok;
+            std::cout << (ok ? "ok   " : "FAIL ") << name << " D"
+                      << dimensions << '\n';
+        }
+    }
+    fs::remove_all(temp);
+    return failed ? 1 : 0;
+}
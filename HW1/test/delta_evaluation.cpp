@@ -0,0 +1,119 @@
+#include "../ga/FunctionManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Values of single coordinate changes evaluated by cec22::DeltaEvaluator must
+// match full evaluations of the changed point, for every function, dimension
+// and flag combination. Also times a hillclimbing sweep both ways. Run from
+// HW1, reads input_data.
+
+namespace {
+
+constexpr auto points = 20;
+constexpr auto tolerance = 1e-9;
+
+struct Result {
+    double error = 0.0;
+    double fullNs = 0.0;
+    double deltaNs = 0.0;
+};
+
+Result compare(const std::string& name, int dimensions, bool shiftFlag,
+               bool rotateFlag)
+{
+    ga::FunctionManager function{name, dimensions, shiftFlag, rotateFlag};
+    auto neighbours = function.deltaEvaluator();
+
+    std::mt19937_64 gen{42};
+    std::uniform_real_distribution<double> dist{-100.0, 100.0};
+    std::vector<double> x(dimensions);
+    std::vector<double> aux(dimensions);
+    std::vector<double> full(dimensions);
+    std::vector<double> delta(dimensions);
+
+    auto result = Result{};
+    for (auto p = 0; p < points; ++p) {
+        for (auto& v : x) {
+            v = dist(gen);
+        }
+        const auto values = x;
+        std::vector<double> changed(dimensions);
+        for (auto& v : changed) {
+            v = dist(gen);
+        }
+
+        // one sweep: every coordinate changed once, from the same point
+        auto start = std::chrono::steady_clock::now();
+        for (auto d = 0; d < dimensions; ++d) {
+            x[d] = changed[d];
+            full[d] = function(x, aux);
+            x[d] = values[d];
+        }
+        auto end = std::chrono::steady_clock::now();
+        result.fullNs +=
+            std::chrono::duration<double, std::nano>(end - start).count();
+
+        start = std::chrono::steady_clock::now();
+        neighbours.reset(x);
+        for (auto d = 0; d < dimensions; ++d) {
+            delta[d] = function(neighbours, d, changed[d]);
+        }
+        end = std::chrono::steady_clock::now();
+        result.deltaNs +=
+            std::chrono::duration<double, std::nano>(end - start).count();
+
+        for (auto d = 0; d < dimensions; ++d) {
+            const auto error = std::fabs(delta[d] - full[d]) /
+                               std::max(1.0, std::fabs(full[d]));
+            result.error = std::max(result.error, error);
+        }
+    }
+    result.fullNs /= points;
+    result.deltaNs /= points;
+    return result;
+}
+
+} // namespace
+
+int main()
+{
+    const std::vector<std::string> functions = {
+        "zakharov_func", "rosenbrock_func", "schaffer_F7_func",
+        "rastrigin_func", "levy_func", "hf01", "hf02", "hf03", "cf01", "cf02",
+        "cf03", "cf04"};
+    // compositions are always shifted and rotated
+    const std::vector<std::pair<bool, bool>> flags = {
+        {true, true}, {true, false}, {false, false}};
+
+    auto failed = false;
+    std::cout << "relative error, ns per sweep of full and delta evaluations\n";
+    for (const auto dimensions : {10, 20}) {
+        for (const auto& name : functions) {
+            for (const auto& [shiftFlag, rotateFlag] : flags) {
+                if (name[0] == 'c' and not rotateFlag) {
+                    continue;
+                }
+                const auto [error, fullNs, deltaNs] =
+                    compare(name, dimensions, shiftFlag, rotateFlag);
+                const auto ok = error <= tolerance;
+                failed = failed or not ok;
+                std::cout << (ok ? "ok   " : "FAIL ") << std::left
+                          << std::setw(17) << name << " D" << dimensions
+                          << (shiftFlag ? " shift" : "      ")
+                          << (rotateFlag ? " rotate " : "        ")
+                          << std::right << std::scientific
+                          << std::setprecision(1) << error << std::fixed
+                          << std::setw(10) << fullNs << std::setw(10)
+                          << deltaNs << '\n';
+            }
+        }
+    }
+    return failed ? 1 : 0;
+}
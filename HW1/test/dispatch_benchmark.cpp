@@ -0,0 +1,75 @@
+#include "../ga/Cec22.h"
+#include "../ga/FunctionManager.h"
+#include "Check.h"
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Time per call of zakharov_func, the cheapest function, so the dispatch is a
+// visible part of it: through the two std::function layers the function
+// managers used before, through FunctionManager's std::variant, and calling
+// the kernel directly. Run from HW1, reads input_data.
+
+namespace {
+
+constexpr auto repetitions = 2'000'000;
+
+using test::nsPerCall;
+
+template <std::size_t D> void benchmark()
+{
+    std::mt19937_64 gen{42};
+    std::uniform_real_distribution<double> random{-100.0, 100.0};
+    auto x = std::vector<double>(D);
+    auto aux = std::vector<double>(D);
+    for (auto& v : x) {
+        v = random(gen);
+    }
+    const auto shift = std::vector<double>(D);
+    const auto rotate = cec22::Matrix{};
+
+    // the wrapping of the function managers before the variant: the kernel in
+    // a std::function, captured by the std::function that was called
+    const std::function<double(const std::vector<double>&,
+                               std::vector<double>&, const std::vector<double>&,
+                               const cec22::Matrix&, bool, bool)>
+        inner = cec22::fixed::zakharov_func<D>;
+    const std::function<double(const std::vector<double>&,
+                               std::vector<double>&)>
+        erased = [=](const std::vector<double>& x, std::vector<double>& aux) {
+            return inner(x, aux, shift, rotate, false, false);
+        };
+    ga::FunctionManager function{"zakharov_func", D, false, false};
+
+    // a new point each call, like a population being evaluated
+    const auto before = nsPerCall(repetitions, [&] {
+        x[0] += 1e-9;
+        return erased(x, aux);
+    });
+    const auto after = nsPerCall(repetitions, [&] {
+        x[0] += 1e-9;
+        return function.f(x, aux);
+    });
+    const auto direct = nsPerCall(repetitions, [&] {
+        x[0] += 1e-9;
+        return cec22::fixed::zakharov_func<D>(x, aux, shift, rotate, false,
+                                              false);
+    });
+    std::cout << "zakharov_func D" << std::setw(3) << std::left << D
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(9) << before << " ns " << std::setw(9) << after
+              << " ns " << std::setw(9) << direct << " ns\n";
+}
+
+} // namespace
+
+int main()
+{
+    std::cout << "std::function, std::variant and direct call per call\n";
+    benchmark<10>();
+    benchmark<20>();
+}
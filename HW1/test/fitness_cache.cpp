@@ -0,0 +1,87 @@
+#include "../ga/Constants.h"
+#include "../ga/FitnessCache.h"
+#include "../ga/GeneticAlgorithm.h"
+#include "Check.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// ga::FitnessCache must return the stored values of exact repeats only, keep
+// binary and gray keys apart and stay within its capacity. A GA run with the
+// cache must find repeats and must not count them as function calls. Run from
+// HW1, reads input_data.
+
+namespace {
+
+using test::check;
+
+void checkCache()
+{
+    constexpr auto words = 3;
+    auto cache = ga::FitnessCache{100, words};
+    check(cache.capacity() == 128, "capacity rounded to a power of two");
+
+    const std::vector<std::uint64_t> a = {1, 2, 3};
+    const std::vector<std::uint64_t> b = {1, 2, 4};
+    check(not cache.find(a.data(), false), "empty cache misses");
+    cache.insert(a.data(), false, 1.5);
+    const auto found = cache.find(a.data(), false);
+    check(found and *found == 1.5, "repeat hits with the stored value");
+    check(not cache.find(b.data(), false), "different key misses");
+    check(not cache.find(a.data(), true), "gray key misses binary entry");
+    cache.insert(a.data(), false, 2.5);
+    check(*cache.find(a.data(), false) == 2.5, "insert replaces equal key");
+    check(cache.hits() == 2 and cache.misses() == 3, "hits and misses counted");
+
+    // many more keys than slots, every lookup is a hit or an honest miss
+    auto wrong = false;
+    for (std::uint64_t i = 0; i < 10'000; ++i) {
+        const std::vector<std::uint64_t> key = {i, i * 7, i ^ 0xff};
+        cache.insert(key.data(), true, static_cast<double>(i));
+    }
+    for (std::uint64_t i = 0; i < 10'000; ++i) {
+        const std::vector<std::uint64_t> key = {i, i * 7, i ^ 0xff};
+        const auto value = cache.find(key.data(), true);
+        wrong = wrong or (value and *value != static_cast<double>(i));
+    }
+    check(not wrong and cache.capacity() == 128, "bounded under eviction");
+
+    cache.clear();
+    check(not cache.find(a.data(), false), "clear forgets entries");
+
+    auto disabled = ga::FitnessCache{};
+    disabled.insert(a.data(), false, 1.0);
+    check(not disabled.find(a.data(), false) and disabled.misses() == 0,
+          "disabled cache stores and counts nothing");
+}
+
+void checkRun()
+{
+    auto cached = ga::getDefault("rastrigin_func");
+    cached.useFitnessCache(ga::constants::cacheCapacity);
+    cached.run();
+    const auto& cache = cached.fitnessCache();
+    std::cout << "calls " << cached.count() << ", hits " << cache.hits()
+              << ", misses " << cache.misses() << '\n';
+    check(cache.hits() > 0, "run finds repeats");
+    // misses of the population also include repeats found in the generation
+    check(cached.count() <= static_cast<int>(cache.misses()),
+          "repeats are not function calls");
+
+    auto uncached = ga::getDefault("rastrigin_func");
+    uncached.run();
+    check(uncached.fitnessCache().hits() == 0 and
+              uncached.count() > cached.count(),
+          "cache is off by default");
+}
+
+} // namespace
+
+int main()
+{
+    checkCache();
+    checkRun();
+    return test::failed ? 1 : 0;
+}
@@ -0,0 +1,135 @@
+#include "../ga/FunctionManager.h"
+#include "../ga/GeneratedData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Data generated for sizes without shipped data must be orthogonal rotations,
+// shifts and permutations cached as bundles, and every function must evaluate
+// on it the same way through the single point, batched and delta paths. Uses
+// a temporary GA_ROOT, nothing is written to input_data.
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr auto dimensions = 50;
+constexpr auto points = 20;
+constexpr auto tolerance = 1e-9;
+
+double relative(double a, double b)
+{
+    return std::fabs(a - b) / std::max(1.0, std::fabs(b));
+}
+
+bool orthogonal()
+{
+    std::mt19937_64 gen{42};
+    const auto m = cec22::randomRotation(dimensions, gen);
+    auto error = 0.0;
+    for (auto i = 0; i < dimensions; ++i) {
+        for (auto j = 0; j < dimensions; ++j) {
+            auto dot = 0.0;
+            for (auto k = 0; k < dimensions; ++k) {
+                dot += m(i, k) * m(j, k);
+            }
+            error = std::max(error, std::fabs(dot - (i == j ? 1.0 : 0.0)));
+        }
+    }
+    const auto ok = error < 1e-12;
+    std::cout << (ok ? "ok   " : "FAIL ") << "M * M^T - I = " << error
+              << '\n';
+    return ok;
+}
+
+bool evaluate(const std::string& name)
+{
+    ga::FunctionManager function{name, dimensions, true, true};
+    auto neighbours = function.deltaEvaluator();
+
+    std::mt19937_64 gen{42};
+    std::uniform_real_distribution<double> dist{-100.0, 100.0};
+    std::vector<double> batch(dimensions * points);
+    std::vector<double> single(points);
+    std::vector<double> x(dimensions);
+    std::vector<double> aux(dimensions);
+    auto error = 0.0;
+    for (auto p = 0; p < points; ++p) {
+        for (auto d = 0; d < dimensions; ++d) {
+            x[d] = dist(gen);
+            batch[d * points + p] = x[d];
+        }
+        single[p] = function(x, aux);
+
+        // changing the last coordinate to the first one's value
+        neighbours.reset(x);
+        const auto delta = function(neighbours, dimensions - 1, x[0]);
+        x[dimensions - 1] = x[0];
+        error = std::max(error, relative(delta, function(x, aux)));
+    }
+    std::vector<double> values(points);
+    function.evaluateBatch(batch, values);
+    for (auto p = 0; p < points; ++p) {
+        error = std::max(error, relative(values[p], single[p]));
+    }
+
+    const auto ok = error <= tolerance;
+    std::cout << (ok ? "ok   " : "FAIL ") << name << " D" << dimensions
+              << " error " << error << '\n';
+    return ok;
+}
+
+bool cached(const std::string& directory)
+{
+    // function 12, cf04, has 6 components
+    const auto* bundle = cec22::generatedData(directory, 12, dimensions);
+    const auto rotate = bundle->matrix("M_12_D50", 6 * dimensions, dimensions);
+    const auto shift = bundle->lines("shift_data_12");
+    const auto file =
+        fs::path{directory} / cec22::generatedFile(12, dimensions);
+    const auto ok = fs::exists(file) and rotate and shift and
+                    shift->size() == 6 and
+                    shift->front().size() == std::size_t{dimensions};
+    std::cout << (ok ? "ok   " : "FAIL ")
+              << "cf04 data cached as a bundle\n";
+
+    // the optimum of zakharov is at the shift, rotated or not
+    ga::FunctionManager function{"zakharov_func", dimensions, true, true};
+    const auto* data = cec22::generatedData(directory, 1, dimensions);
+    const auto line = data->lines("shift_data_1")->front();
+    std::vector<double> x(line.begin(), line.end());
+    std::vector<double> aux(dimensions);
+    const auto optimum = std::fabs(function(x, aux)) < 1e-9;
+    std::cout << (optimum ? "ok   " : "FAIL ")
+              << "zakharov_func at the shift\n";
+    return ok and optimum;
+}
+
+} // namespace
+
+int main()
+{
+    const auto root = fs::temp_directory_path() / "cec22_generated_data";
+    fs::remove_all(root);
+    fs::create_directories(root / "input_data");
+    setenv("GA_ROOT", root.c_str(), 1);
+
+    const std::vector<std::string> functions = {
+        "zakharov_func", "rosenbrock_func", "schaffer_F7_func",
+        "rastrigin_func", "levy_func", "hf01", "hf02", "hf03", "cf01", "cf02",
+        "cf03", "cf04"};
+
+    auto ok = orthogonal();
+    for (const auto& name : functions) {
+        ok = evaluate(name) and ok;
+    }
+    ok = cached((root / "input_data/").string()) and ok;
+    fs::remove_all(root);
+    return ok ? 0 : 1;
+}
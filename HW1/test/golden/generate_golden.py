@@ -0,0 +1,50 @@
+"""Writes the golden values of test/golden_reference.cpp: a seeded corpus of
+points for the 12 functions at D=10 and D=20, evaluated by the reference
+implementation HW2/CEC2022.py on the data of HW2/input_data. It matches
+HW1/input_data, except for the extra lines of shift_data_8.txt, which
+CEC2022.py can't read and the C++ code ignores.
+
+Run once from anywhere, python3 HW1/test/golden/generate_golden.py, the output
+is committed so the test runs offline. Regenerate only when the corpus or the
+input data change.
+"""
+import contextlib
+import io
+import os
+import random
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+HW1 = os.path.dirname(os.path.dirname(HERE))
+HW2 = os.path.join(os.path.dirname(HW1), "HW2")
+sys.path.insert(0, HW2)
+
+import CEC2022  # noqa: E402
+
+POINTS = 16
+SEED = 2022
+
+
+def main():
+    # CEC2022.py reads input_data/ relative to the working directory
+    os.chdir(HW2)
+    rng = random.Random(SEED)
+    for dimensions in (10, 20):
+        name = os.path.join(HERE, "cec22_D%d.txt" % dimensions)
+        with open(name, "w") as out:
+            out.write("# function value x[0] ... x[%d], from CEC2022.py\n"
+                      % (dimensions - 1))
+            for function, index in CEC2022.func_dict.items():
+                for _ in range(POINTS):
+                    x = [rng.uniform(-100.0, 100.0) for _ in range(dimensions)]
+                    # it warns about D=10 and D=20 too
+                    with contextlib.redirect_stdout(io.StringIO()):
+                        value = CEC2022.cec22_test_func(x, dimensions, 1,
+                                                        index)[0]
+                    out.write(" ".join([function, repr(float(value))] +
+                                       [repr(v) for v in x]) + "\n")
+        print("Wrote", name)
+
+
+if __name__ == "__main__":
+    main()
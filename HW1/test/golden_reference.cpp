@@ -0,0 +1,281 @@
+#include "../ga/FunctionManager.h"
+#include "../ga/ProblemData.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Values of every evaluation path must match golden values of the reference
+// implementation, CEC2022.py, on a seeded corpus of points at D=10 and D=20.
+// The golden files are written once by test/golden/generate_golden.py, so the
+// test runs offline. Reports the max relative error and ns per evaluation of
+// each path:
+//  * runtime: the cec22 kernels, for any size
+//  * fixed: the fixed size kernels, on the vectorized transcendentals
+//  * batch: the batched kernels, in double
+//  * mixed: the batched kernels, shifted and rotated in single precision
+//  * delta: single coordinate changes by cec22::DeltaEvaluator
+// Run from HW1, reads input_data and test/golden.
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr auto repetitions = 200;
+constexpr auto tolerance = 1e-9;
+/// see test/mixed_precision.cpp
+constexpr auto mixedTolerance = 1e-4;
+
+using Clock = std::chrono::steady_clock;
+
+// keeps the timed calls from being optimized away
+volatile double sink = 0.0;
+
+/// The golden points of one function, point p at [p * D, (p + 1) * D)
+struct Golden {
+    std::vector<double> points;
+    std::vector<double> values;
+};
+
+std::map<std::string, Golden> readGolden(int dimensions)
+{
+    const auto file =
+        "test/golden/cec22_D" + std::to_string(dimensions) + ".txt";
+    std::ifstream in{file};
+    if (not in) {
+        throw std::runtime_error{"File " + file + " does not exist"};
+    }
+
+    std::map<std::string, Golden> golden;
+    for (std::string str; std::getline(in, str);) {
+        if (str.empty() or str.front() == '#') {
+            continue;
+        }
+        std::istringstream ss{str};
+        std::string name;
+        auto value = 0.0;
+        ss >> name >> value;
+        auto& g = golden[name];
+        g.values.push_back(value);
+        for (auto d = 0; d < dimensions; ++d) {
+            auto x = 0.0;
+            if (not(ss >> x)) {
+                std::cerr << "Line of " << name << " has " << d
+                          << " coordinates, expected " << dimensions << '\n';
+                throw std::runtime_error{"Read error"};
+            }
+            g.points.push_back(x);
+        }
+    }
+    return golden;
+}
+
+/// Kind evaluator of the Kernel, as bySize does for the runtime size
+template <template <auto, auto> class Kind, auto Kernel, auto BatchKernel>
+cec22::Evaluator make(std::shared_ptr<const cec22::ProblemData> data)
+{
+    return Kind<Kernel, BatchKernel>{std::move(data), true, true};
+}
+
+/// The evaluator of the runtime size kernel of name, on the data the function
+/// managers loaded
+cec22::Evaluator runtimeEvaluator(const std::string& name, int dimensions)
+{
+    using namespace cec22;
+    using Factory = Evaluator (*)(std::shared_ptr<const ProblemData>);
+    static const std::map<std::string, std::pair<int, Factory>> functions = {
+        {"zakharov_func",
+         {1, make<BasicEvaluator, zakharov_func, batch::zakharov_func>}},
+        {"rosenbrock_func",
+         {2, make<BasicEvaluator, rosenbrock_func, batch::rosenbrock_func>}},
+        {"schaffer_F7_func",
+         {3, make<BasicEvaluator, schaffer_F7_func, batch::schaffer_F7_func>}},
+        {"rastrigin_func",
+         {4, make<BasicEvaluator, rastrigin_func, batch::rastrigin_func>}},
+        {"levy_func", {5, make<BasicEvaluator, levy_func, batch::levy_func>}},
+        {"hf01", {6, make<HybridEvaluator, hf01, batch::hf01>}},
+        {"hf02", {7, make<HybridEvaluator, hf02, batch::hf02>}},
+        {"hf03", {8, make<HybridEvaluator, hf03, batch::hf03>}},
+        {"cf01", {9, make<CompositionEvaluator, cf01, batch::cf01>}},
+        {"cf02", {10, make<CompositionEvaluator, cf02, batch::cf02>}},
+        {"cf03", {11, make<CompositionEvaluator, cf03, batch::cf03>}},
+        {"cf04", {12, make<CompositionEvaluator, cf04, batch::cf04>}},
+    };
+
+    auto directory = fs::current_path().string() + "/input_data/";
+    if (auto p = std::getenv("GA_ROOT")) {
+        directory = std::string{p} + "/input_data/";
+    }
+    const auto [index, factory] = functions.at(name);
+    // shifted and rotated data is keyed like the function managers key it
+    return factory(problemData({directory, index, dimensions, true, true},
+                               []() -> ProblemData {
+                                   throw std::logic_error{
+                                       "Data is not loaded yet"};
+                               }));
+}
+
+struct Path {
+    double error = 0.0;
+    double ns = 0.0;
+};
+
+double relative(double value, double expected)
+{
+    return std::fabs(value - expected) / std::max(1.0, std::fabs(expected));
+}
+
+/// Max relative error of values, ns per point of the time taken
+Path result(const std::vector<double>& values,
+            const std::vector<double>& expected, Clock::duration time)
+{
+    auto path = Path{};
+    for (std::size_t p = 0; p < values.size(); ++p) {
+        path.error = std::max(path.error, relative(values[p], expected[p]));
+    }
+    path.ns = std::chrono::duration<double, std::nano>(time).count() /
+              (repetitions * values.size());
+    return path;
+}
+
+/// Point p of golden
+std::vector<double> pointOf(const Golden& golden, int dimensions, int p)
+{
+    const auto begin = golden.points.begin() + p * dimensions;
+    return {begin, begin + dimensions};
+}
+
+/// Evaluates one point at a time with f(x, aux)
+template <typename F>
+Path single(const Golden& golden, int dimensions, F&& f)
+{
+    const auto count = static_cast<int>(golden.values.size());
+    std::vector<double> values(count);
+    std::vector<double> aux(dimensions);
+    auto total = 0.0;
+    const auto start = Clock::now();
+    for (auto r = 0; r < repetitions; ++r) {
+        for (auto p = 0; p < count; ++p) {
+            auto x = pointOf(golden, dimensions, p);
+            values[p] = f(x, aux);
+            total += values[p];
+        }
+    }
+    const auto time = Clock::now() - start;
+    sink = total;
+    return result(values, golden.values, time);
+}
+
+/// Evaluates all the points as one batch
+Path batched(const Golden& golden, int dimensions,
+             ga::FunctionManager& function)
+{
+    const auto count = static_cast<int>(golden.values.size());
+    // structure of arrays, see cec22::batch
+    std::vector<double> points(dimensions * count);
+    for (auto p = 0; p < count; ++p) {
+        for (auto d = 0; d < dimensions; ++d) {
+            points[d * count + p] = golden.points[p * dimensions + d];
+        }
+    }
+    std::vector<double> values(count);
+    auto total = 0.0;
+    const auto start = Clock::now();
+    for (auto r = 0; r < repetitions; ++r) {
+        function.evaluateBatch(points, values);
+        total += values[0];
+    }
+    const auto time = Clock::now() - start;
+    sink = total;
+    return result(values, golden.values, time);
+}
+
+/// Reaches each point by changing one coordinate of a neighbour
+Path delta(const Golden& golden, int dimensions,
+           ga::FunctionManager& function)
+{
+    const auto count = static_cast<int>(golden.values.size());
+    auto neighbours = function.deltaEvaluator();
+    std::vector<double> values(count);
+    auto time = Clock::duration{};
+    auto total = 0.0;
+    for (auto p = 0; p < count; ++p) {
+        auto x = pointOf(golden, dimensions, p);
+        const auto d = p % dimensions;
+        const auto value = x[d];
+        x[d] = -value;
+        neighbours.reset(x);
+        const auto start = Clock::now();
+        for (auto r = 0; r < repetitions; ++r) {
+            values[p] = function(neighbours, d, value);
+            total += values[p];
+        }
+        time += Clock::now() - start;
+    }
+    sink = total;
+    return result(values, golden.values, time);
+}
+
+bool compare(const std::string& name, const Golden& golden, int dimensions)
+{
+    ga::FunctionManager function{name, dimensions, true, true};
+    const auto runtime = runtimeEvaluator(name, dimensions);
+
+    const auto paths = std::vector<Path>{
+        single(golden, dimensions,
+               [&](const auto& x, auto& aux) {
+                   return std::visit([&](const auto& f) { return f(x, aux); },
+                                     runtime);
+               }),
+        single(golden, dimensions,
+               [&](auto& x, auto& aux) { return function.f(x, aux); }),
+        batched(golden, dimensions, function),
+        [&] {
+            // never switches back to double
+            ga::FunctionManager mixed{name, dimensions, true, true};
+            mixed.useSinglePrecision(-std::numeric_limits<double>::infinity());
+            return batched(golden, dimensions, mixed);
+        }(),
+        delta(golden, dimensions, function)};
+
+    auto ok = true;
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        ok = ok and paths[i].error <= (i == 3 ? mixedTolerance : tolerance);
+    }
+    std::cout << (ok ? "ok   " : "FAIL ") << std::left << std::setw(17)
+              << name << " D" << dimensions << std::right;
+    for (const auto& path : paths) {
+        std::cout << std::scientific << std::setprecision(1) << std::setw(9)
+                  << path.error << std::fixed << std::setw(9) << path.ns;
+    }
+    std::cout << '\n';
+    return ok;
+}
+
+} // namespace
+
+int main()
+{
+    auto failed = false;
+    std::cout << "max relative error and ns per evaluation of the runtime, "
+                 "fixed, batch, mixed and delta paths\n";
+    for (const auto dimensions : {10, 20}) {
+        for (const auto& [name, golden] : readGolden(dimensions)) {
+            failed = not compare(name, golden, dimensions) or failed;
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,127 @@
+#include "../ga/IslandModel.h"
+#include "../ga/SpscQueue.h"
+#include "Check.h"
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// The migration queue must keep its order, refuse pushes when full and hand
+// every value over between two threads. Island runs on every topology must
+// stay within the call budget of a single run and finish with a finite best
+// value, also when the islands take their hillclimbing out of it. Run from
+// HW1, reads input_data.
+
+namespace {
+
+using test::check;
+
+void checkQueue()
+{
+    // rounded up to 4
+    ga::SpscQueue<int> queue{3};
+    auto pushed = 0;
+    while (queue.push(pushed)) {
+        ++pushed;
+    }
+    check(pushed == 4, "full at capacity");
+    auto inOrder = true;
+    for (auto i = 0; i < pushed; ++i) {
+        const auto value = queue.pop();
+        inOrder = inOrder and value and *value == i;
+    }
+    check(inOrder and not queue.pop(), "popped in order until empty");
+
+    constexpr auto values = 100'000;
+    ga::SpscQueue<int> shared{64};
+    auto received = 0;
+    auto ordered = true;
+    {
+        // both sides yield when they cannot go on, a spinning side would
+        // hold a single core for its whole time slice
+        std::jthread consumer{[&]() {
+            while (received < values) {
+                if (const auto value = shared.pop()) {
+                    ordered = ordered and *value == received;
+                    ++received;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }};
+        for (auto i = 0; i < values;) {
+            if (shared.push(i)) {
+                ++i;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+    check(received == values and ordered, "handed over between threads");
+}
+
+void checkRun()
+{
+    const auto topologies = {
+        std::pair{ga::Topology::Ring, "ring"},
+        std::pair{ga::Topology::Random, "random"},
+        std::pair{ga::Topology::Full, "full"},
+    };
+    for (const auto& [topology, name] : topologies) {
+        const auto migration = ga::Migration{.topology = topology};
+        ga::IslandModel islands{
+            4,
+            []() {
+                return std::unique_ptr<ga::GeneticAlgorithm>(
+                    new ga::GeneticAlgorithm(
+                        ga::getDefault("rastrigin_func")));
+            },
+            migration};
+        const auto value = islands.run();
+        std::cout << name << ": " << value << ", " << islands.count()
+                  << " calls\n";
+        // the budget of one default run
+        check(std::isfinite(value) and islands.count() <= 200'101,
+              std::string{name} + " islands within budget");
+    }
+}
+
+void checkHillclimbing()
+{
+    // each island climbs its share of the 40000 calls out of the shared budget
+    auto made = std::vector<ga::GeneticAlgorithm*>{};
+    const auto make = [&made]() {
+        auto ga = std::unique_ptr<ga::GeneticAlgorithm>(
+            new ga::GeneticAlgorithm(ga::getDefault("rastrigin_func")));
+        ga->useHillclimbing(2);
+        made.push_back(ga.get());
+        return ga;
+    };
+    ga::IslandModel islands{2, make};
+    const auto value = islands.run();
+    auto climbing = 0;
+    for (const auto* island : made) {
+        climbing += island->hillclimbingCount();
+    }
+    std::cout << "hillclimbing: " << value << ", " << islands.count()
+              << " calls, " << climbing << " climbing\n";
+    // a few calls over per climbing thread
+    check(std::isfinite(value) and islands.count() <= 200'101 + 8,
+          "hillclimbing islands within budget");
+    check(climbing > 20'000 and climbing <= 40'000 + 8,
+          "hillclimbing islands climb their share");
+}
+
+} // namespace
+
+int main()
+{
+    checkQueue();
+    checkRun();
+    checkHillclimbing();
+    return test::failed ? 1 : 0;
+}
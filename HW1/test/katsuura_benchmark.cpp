@@ -0,0 +1,101 @@
+#include "../ga/Cec22.h"
+#include "Check.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// Time per call of hf02 and hf03, whose costliest component is Katsuura, for
+// the scalar runtime versions and the D=10/D=20 kernels using the vectorized
+// Katsuura engine. The Katsuura product alone is timed against the loop it
+// replaced, which called std::pow for every term.
+
+namespace {
+
+constexpr auto repetitions = 200'000;
+
+using test::nsPerCall;
+
+double katsuuraPowLoop(const double* x, std::size_t n, double exponent)
+{
+    auto f = 1.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        auto temp = 0.0;
+        for (auto j = 1; j < 33; ++j) {
+            const auto temp1 = std::pow(2.0, j);
+            const auto temp2 = temp1 * x[i];
+            temp += std::fabs(temp2 - std::floor(temp2 + 0.5)) / temp1;
+        }
+        f *= std::pow(1.0 + (i + 1) * temp, exponent);
+    }
+    return f;
+}
+
+void report(const char* name, int dimensions, double before, double after)
+{
+    std::cout << std::left << std::setw(10) << name << " D" << std::setw(3)
+              << dimensions << std::right << std::fixed << std::setprecision(1)
+              << std::setw(9) << before << " ns " << std::setw(9) << after
+              << " ns  x" << std::setprecision(2) << before / after << '\n';
+}
+
+template <std::size_t D> void benchmark()
+{
+    std::mt19937_64 gen{42};
+    std::uniform_real_distribution<double> random{-100.0, 100.0};
+
+    auto shift = std::vector<double>(D);
+    std::generate(shift.begin(), shift.end(), [&]() { return random(gen); });
+    auto rotate = cec22::Matrix{D, D};
+    for (std::size_t i = 0; i < rotate.rows(); ++i) {
+        std::generate_n(rotate.row(i), D,
+                        [&]() { return random(gen) / 100.0; });
+    }
+    auto indices = std::vector<std::size_t>(D);
+    std::iota(indices.begin(), indices.end(), 0);
+    std::shuffle(indices.begin(), indices.end(), gen);
+
+    auto x = std::vector<double>(D);
+    auto aux = std::vector<double>(D);
+    std::generate(x.begin(), x.end(), [&]() { return random(gen); });
+
+    const auto hybrid = [&](auto f) {
+        return nsPerCall(repetitions, [&] {
+            // a new point each call, like a population being evaluated
+            x[0] += 1e-9;
+            return f(x, aux, shift, rotate, indices, true, true);
+        });
+    };
+    report("hf02", D, hybrid(cec22::hf02), hybrid(cec22::fixed::hf02<D>));
+    report("hf03", D, hybrid(cec22::hf03), hybrid(cec22::fixed::hf03<D>));
+
+    // Katsuura's inputs are scaled by 5 / 100
+    auto z = std::vector<double>(D);
+    std::transform(x.begin(), x.end(), z.begin(),
+                   [](double v) { return v * 5.0 / 100.0; });
+    const auto exponent = 10.0 / std::pow(static_cast<double>(D), 1.2);
+    const auto before = nsPerCall(repetitions, [&] {
+        z[0] += 1e-9;
+        return katsuuraPowLoop(z.data(), D, exponent);
+    });
+    const auto after = nsPerCall(repetitions, [&] {
+        z[0] += 1e-9;
+        return cec22::simd::katsuura(z.data(), D, exponent);
+    });
+    report("katsuura", D, before, after);
+}
+
+} // namespace
+
+int main()
+{
+    std::cout << "isa " << cec22::simd::name(cec22::simd::active())
+              << ", before / after per call\n";
+    benchmark<10>();
+    benchmark<20>();
+}
@@ -0,0 +1,100 @@
+#include "../ga/FunctionManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+// Batches evaluated in mixed precision must stay close to the double ones,
+// and once a value falls below the threshold the manager must report double
+// values only. Also times a batch both ways. Run from HW1, reads input_data.
+
+namespace {
+
+constexpr auto count = 100;
+constexpr auto repetitions = 200;
+constexpr auto tolerance = 1e-4;
+
+std::vector<double> randomBatch(int dimensions)
+{
+    std::mt19937_64 gen{42};
+    std::uniform_real_distribution<double> dist{-100.0, 100.0};
+    std::vector<double> points(dimensions * count);
+    for (auto& v : points) {
+        v = dist(gen);
+    }
+    return points;
+}
+
+/// ns per batch
+double time(ga::FunctionManager& function, const std::vector<double>& points,
+            std::vector<double>& values)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < repetitions; ++i) {
+        function.evaluateBatch(points, values);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           repetitions;
+}
+
+bool compare(const std::string& name, int dimensions)
+{
+    const auto points = randomBatch(dimensions);
+    std::vector<double> expected(count);
+    std::vector<double> values(count);
+
+    ga::FunctionManager reference{name, dimensions, true, true};
+    const auto doubleNs = time(reference, points, expected);
+
+    // never switches back
+    ga::FunctionManager mixed{name, dimensions, true, true};
+    mixed.useSinglePrecision(-std::numeric_limits<double>::infinity());
+    const auto mixedNs = time(mixed, points, values);
+    auto error = 0.0;
+    for (auto p = 0; p < count; ++p) {
+        error = std::max(error, std::fabs(values[p] - expected[p]) /
+                                    std::max(1.0, std::fabs(expected[p])));
+    }
+
+    // switches on the first batch, which is evaluated again
+    ga::FunctionManager switched{name, dimensions, true, true};
+    switched.useSinglePrecision(std::numeric_limits<double>::infinity());
+    switched.evaluateBatch(points, values);
+    const auto exact = values == expected;
+
+    const auto ok = error <= tolerance and exact;
+    std::cout << (ok ? "ok   " : "FAIL ") << std::left << std::setw(17)
+              << name << " D" << dimensions << std::right << std::scientific
+              << std::setprecision(1) << std::setw(9) << error
+              << (exact ? "" : " not switched") << std::fixed
+              << std::setw(11) << doubleNs << std::setw(11) << mixedNs
+              << '\n';
+    return ok;
+}
+
+} // namespace
+
+int main()
+{
+    const std::vector<std::string> functions = {
+        "zakharov_func", "rosenbrock_func", "schaffer_F7_func",
+        "rastrigin_func", "levy_func", "hf01", "hf02", "hf03", "cf01", "cf02",
+        "cf03", "cf04"};
+
+    auto failed = false;
+    std::cout << "relative error, ns per batch of " << count
+              << " in double and mixed precision\n";
+    for (const auto dimensions : {10, 20}) {
+        for (const auto& name : functions) {
+            failed = not compare(name, dimensions) or failed;
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,294 @@
+#include "../ga/GeneticAlgorithm.h"
+#include "Check.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <set>
+#include <vector>
+
+// The genetic operators, reached through ga::GeneticAlgorithmProbe. Mutation
+// must flip each bit past the elite prefix with mutationProbability, all of
+// them from 1 up, and leave the unused bits 0. Selection must draw members
+// with the probabilities of their weights, also when rounding leaves the last
+// cumulative probability below 1, and put the elites first. Run from HW1,
+// reads input_data.
+
+namespace ga {
+
+struct GeneticAlgorithmProbe
+{
+    static void setMutationProbability(GeneticAlgorithm& ga, double p)
+    {
+        ga.mutationProbability = p;
+    }
+    static void clearPopulation(GeneticAlgorithm& ga)
+    {
+        std::ranges::fill(ga.population.words(), 0);
+    }
+    static void mutate(GeneticAlgorithm& ga)
+    {
+        ga.mutatePopulation();
+    }
+    /// set bits of member i
+    static long long ones(const GeneticAlgorithm& ga, int i)
+    {
+        auto count = 0LL;
+        for (const auto word : ga.population[i].words()) {
+            count += std::popcount(word);
+        }
+        return count;
+    }
+    static bool unusedClear(const GeneticAlgorithm& ga, int i)
+    {
+        const auto member = ga.population[i];
+        for (auto bit = std::size_t(ga.bitsPerChromosome);
+             bit < member.capacity(); ++bit) {
+            if (member[bit]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    static int bitsPerChromosome(const GeneticAlgorithm& ga)
+    {
+        return ga.bitsPerChromosome;
+    }
+    static int elitesNumber(const GeneticAlgorithm& ga)
+    {
+        return ga.elitesNumber;
+    }
+
+    /// sets the selection weights and their cumulative probabilities
+    static void setFitnesses(GeneticAlgorithm& ga,
+                             const std::vector<double>& fitnesses)
+    {
+        ga.fitnesses = fitnesses;
+        ga.computeSelectionProbabilities(
+            std::accumulate(fitnesses.begin(), fitnesses.end(), 0.0));
+    }
+    static std::vector<double>& selectionProbabilities(GeneticAlgorithm& ga)
+    {
+        return ga.selectionProbabilities;
+    }
+    static std::size_t select(GeneticAlgorithm& ga)
+    {
+        return ga.selectChromosome();
+    }
+    static void selectNewPopulation(GeneticAlgorithm& ga)
+    {
+        ga.selectNewPopulation();
+    }
+    static const std::vector<std::size_t>& selected(const GeneticAlgorithm& ga)
+    {
+        return ga.selected;
+    }
+    /// writes the index of each member to its first variable
+    static void markPopulation(GeneticAlgorithm& ga)
+    {
+        for (auto i = 0; i < ga.populationSize; ++i) {
+            ga.population[i].setField(0, constants::bitsPerVariable, i);
+        }
+    }
+    static std::size_t mark(const GeneticAlgorithm& ga, int i)
+    {
+        return ga.population[i].field(0, constants::bitsPerVariable);
+    }
+};
+
+} // namespace ga
+
+namespace {
+
+using Probe = ga::GeneticAlgorithmProbe;
+using test::check;
+
+constexpr auto populationSize = 100;
+
+ga::GeneticAlgorithm makeGeneticAlgorithm(double elitesPercentage)
+{
+    return {0.5,
+            0.005,
+            0.025,
+            elitesPercentage,
+            10.0,
+            ga::CrossoverType::Classic,
+            ga::HillclimbingType::FirstImprovementRandom,
+            populationSize,
+            10,
+            20,
+            50,
+            1'000'000,
+            "rastrigin_func",
+            true,
+            true};
+}
+
+void checkMutation()
+{
+    auto ga = makeGeneticAlgorithm(0.1);
+    const auto first = Probe::elitesNumber(ga) / 2;
+    const auto bits = Probe::bitsPerChromosome(ga);
+    check(first == 5, "elite prefix of 5 members");
+
+    // ~6650 flips expected, the bound is over 5 standard deviations
+    constexpr auto p = 0.01;
+    constexpr auto repetitions = 20;
+    Probe::setMutationProbability(ga, p);
+    auto flips = 0LL;
+    auto elitesKept = true;
+    auto unusedClear = true;
+    for (auto r = 0; r < repetitions; ++r) {
+        Probe::clearPopulation(ga);
+        Probe::mutate(ga);
+        for (auto i = 0; i < populationSize; ++i) {
+            const auto ones = Probe::ones(ga, i);
+            if (i < first) {
+                elitesKept = elitesKept and ones == 0;
+            } else {
+                flips += ones;
+            }
+            unusedClear = unusedClear and Probe::unusedClear(ga, i);
+        }
+    }
+    const auto expected =
+        p * repetitions * (populationSize - first) * static_cast<double>(bits);
+    const auto rate = flips / expected;
+    std::cout << "flip rate " << rate << " of the expected\n";
+    check(std::abs(rate - 1.0) < 0.065, "flip rate of mutationProbability");
+    check(elitesKept, "elite prefix not mutated");
+    check(unusedClear, "unused bits stay 0");
+
+    // hypermutation may swap in rates of 1 and more
+    for (const auto large : {1.0, 1.5}) {
+        Probe::setMutationProbability(ga, large);
+        Probe::clearPopulation(ga);
+        Probe::mutate(ga);
+        auto all = true;
+        for (auto i = 0; i < populationSize; ++i) {
+            const auto expectedOnes = i < first ? 0 : bits;
+            all = all and Probe::ones(ga, i) == expectedOnes and
+                  Probe::unusedClear(ga, i);
+        }
+        check(all, large == 1.0 ? "p = 1 flips every bit"
+                                : "p > 1 flips every bit");
+    }
+}
+
+/// chi-square statistic of counts against probabilities, draws in total
+double chiSquare(const std::vector<long long>& counts,
+                 const std::vector<double>& probabilities, long long draws)
+{
+    auto statistic = 0.0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        const auto expected = probabilities[i] * draws;
+        statistic += (counts[i] - expected) * (counts[i] - expected) / expected;
+    }
+    return statistic;
+}
+
+/// counts of draws selections, false if one was out of the population
+bool countSelections(ga::GeneticAlgorithm& ga, long long draws,
+                     std::vector<long long>& counts)
+{
+    counts.assign(populationSize, 0);
+    for (auto d = 0LL; d < draws; ++d) {
+        const auto i = Probe::select(ga);
+        if (i >= counts.size()) {
+            return false;
+        }
+        ++counts[i];
+    }
+    return true;
+}
+
+void checkSelection()
+{
+    auto ga = makeGeneticAlgorithm(0.1);
+    std::vector<double> fitnesses(populationSize);
+    for (auto i = 0; i < populationSize; ++i) {
+        fitnesses[i] = i % 10 + 1.0;
+    }
+    const auto total =
+        std::accumulate(fitnesses.begin(), fitnesses.end(), 0.0);
+    std::vector<double> probabilities(populationSize);
+    for (auto i = 0; i < populationSize; ++i) {
+        probabilities[i] = fitnesses[i] / total;
+    }
+    Probe::setFitnesses(ga, fitnesses);
+    const auto& cumulative = Probe::selectionProbabilities(ga);
+    check(std::abs(cumulative.back() - 1.0) < 1e-9 and
+              std::abs(cumulative[9] - 55.0 / total) < 1e-12,
+          "cumulative selection probabilities");
+
+    // 99 degrees of freedom: mean 99, standard deviation 14
+    constexpr auto draws = 200'000LL;
+    constexpr auto bound = 99 + 6 * 14;
+    std::vector<long long> counts;
+    auto inRange = countSelections(ga, draws, counts);
+    const auto statistic = chiSquare(counts, probabilities, draws);
+    std::cout << "chi-square " << statistic << '\n';
+    check(inRange and statistic < bound,
+          "selections follow the cumulative probabilities");
+
+    // the draws past the last cumulative probability go to the last member
+    auto& shortened = Probe::selectionProbabilities(ga);
+    for (auto& p : shortened) {
+        p *= 0.9;
+    }
+    auto clamped = probabilities;
+    for (auto& p : clamped) {
+        p *= 0.9;
+    }
+    clamped.back() += 0.1;
+    inRange = countSelections(ga, draws, counts);
+    const auto clampedStatistic = chiSquare(counts, clamped, draws);
+    std::cout << "chi-square " << clampedStatistic << '\n';
+    check(inRange and clampedStatistic < bound,
+          "last cumulative below 1 clamps to the last member");
+}
+
+void checkElites()
+{
+    auto ga = makeGeneticAlgorithm(0.1);
+    const auto elites = Probe::elitesNumber(ga);
+    check(elites == 10, "10 elites");
+
+    // distinct weights in a shuffled order, the elites are those from 90 up
+    std::vector<double> fitnesses(populationSize);
+    std::iota(fitnesses.begin(), fitnesses.end(), 0.0);
+    std::shuffle(fitnesses.begin(), fitnesses.end(), std::mt19937{7});
+    Probe::setFitnesses(ga, fitnesses);
+    Probe::markPopulation(ga);
+    Probe::selectNewPopulation(ga);
+
+    const auto& selected = Probe::selected(ga);
+    std::set<std::size_t> best;
+    for (auto k = 0; k < elites; ++k) {
+        if (fitnesses[selected[k]] >= populationSize - elites) {
+            best.insert(selected[k]);
+        }
+    }
+    check(best.size() == static_cast<std::size_t>(elites),
+          "the elites are selected[0..elitesNumber)");
+
+    auto gathered = true;
+    for (auto k = 0; k < populationSize; ++k) {
+        gathered = gathered and Probe::mark(ga, k) == selected[k];
+    }
+    check(gathered, "members k of the new population are selected[k]");
+}
+
+} // namespace
+
+int main()
+{
+    checkMutation();
+    checkSelection();
+    checkElites();
+    return test::failed ? 1 : 0;
+}
@@ -0,0 +1,242 @@
+#include "../ga/GeneticAlgorithm.h"
+#include "../ga/PackedBits.h"
+#include "Check.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// ga::PackedBits must behave like the std::vector<bool> chromosomes it
+// replaced, bit for bit, with the unused bits left 0. Fields are read and
+// written whole, also across words. The members of a ga::PackedBitsArray are
+// spans of its buffer. The gray conversions of the GA are checked by its
+// sanityCheck, also past D=20. Run from HW1, reads input_data.
+
+namespace {
+
+constexpr auto words = 11;
+constexpr auto bits = 700;
+using Bits = ga::PackedBits;
+
+using test::check;
+
+bool same(const Bits& packed, const std::vector<bool>& model)
+{
+    for (std::size_t i = 0; i < model.size(); ++i) {
+        if (packed[i] != model[i]) {
+            return false;
+        }
+    }
+    for (auto i = model.size(); i < packed.capacity(); ++i) {
+        if (packed[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void checkBits()
+{
+    std::mt19937_64 gen{42};
+    std::uniform_int_distribution<std::size_t> randomBit{0, bits - 1};
+    std::bernoulli_distribution randomBool;
+
+    auto a = Bits{words};
+    auto b = Bits{words};
+    auto modelA = std::vector<bool>(bits);
+    auto modelB = std::vector<bool>(bits);
+    for (std::size_t i = 0; i < bits; ++i) {
+        modelA[i] = randomBool(gen);
+        modelB[i] = randomBool(gen);
+        a.set(i, modelA[i]);
+        b.set(i, modelB[i]);
+    }
+    check(same(a, modelA) and same(b, modelB), "set");
+
+    for (auto k = 0; k < 1000; ++k) {
+        const auto i = randomBit(gen);
+        a.flip(i);
+        modelA[i] = not modelA[i];
+    }
+    check(same(a, modelA), "flip");
+
+    // first bits are the most significant ones of their word
+    auto c = Bits{words};
+    c.set(0, true);
+    c.set(65, true);
+    check(c.words()[0] == 1ULL << 63 and c.words()[1] == 1ULL << 62,
+          "bit order");
+
+    auto ok = true;
+    for (auto k = 0; k < 200; ++k) {
+        const auto end = randomBit(gen) + 1;
+        a.swapPrefix(b, end);
+        for (std::size_t i = 0; i < end; ++i) {
+            const bool t = modelA[i];
+            modelA[i] = modelB[i];
+            modelB[i] = t;
+        }
+        ok = ok and same(a, modelA) and same(b, modelB);
+    }
+    a.swapPrefix(b, 0);
+    a.swapPrefix(b, 640);
+    for (std::size_t i = 0; i < 640; ++i) {
+        const bool t = modelA[i];
+        modelA[i] = modelB[i];
+        modelB[i] = t;
+    }
+    check(ok and same(a, modelA) and same(b, modelB), "swapPrefix");
+
+    ok = true;
+    for (auto k = 0; k < 200; ++k) {
+        const auto first = randomBit(gen);
+        const auto second = randomBit(gen) + 1;
+        const auto begin = std::min(first, second);
+        const auto end = std::max(first, second);
+        a.swapRange(b, begin, end);
+        for (auto i = begin; i < end; ++i) {
+            const bool t = modelA[i];
+            modelA[i] = modelB[i];
+            modelB[i] = t;
+        }
+        ok = ok and same(a, modelA) and same(b, modelB);
+    }
+    // empty, within one word, and whole words
+    a.swapRange(b, 100, 100);
+    a.swapRange(b, 70, 75);
+    a.swapRange(b, 64, 192);
+    for (std::size_t i = 70; i < 75; ++i) {
+        const bool t = modelA[i];
+        modelA[i] = modelB[i];
+        modelB[i] = t;
+    }
+    for (std::size_t i = 64; i < 192; ++i) {
+        const bool t = modelA[i];
+        modelA[i] = modelB[i];
+        modelB[i] = t;
+    }
+    check(ok and same(a, modelA) and same(b, modelB), "swapRange");
+
+    auto mask = Bits{words};
+    for (std::size_t i = 0; i < bits; ++i) {
+        mask.set(i, randomBool(gen));
+    }
+    a.swapMasked(b, mask);
+    for (std::size_t i = 0; i < bits; ++i) {
+        if (mask[i]) {
+            const bool t = modelA[i];
+            modelA[i] = modelB[i];
+            modelB[i] = t;
+        }
+    }
+    check(same(a, modelA) and same(b, modelB), "swapMasked");
+
+    // fields of every width and position, straddling words or not
+    auto fields = true;
+    std::uniform_int_distribution<std::size_t> randomWidth{1, 64};
+    for (auto k = 0; k < 2000; ++k) {
+        const auto width = randomWidth(gen);
+        const auto begin = randomBit(gen) % (bits - width + 1);
+        auto expected = std::uint64_t{0};
+        for (auto i = begin; i < begin + width; ++i) {
+            expected = expected * 2 + modelA[i];
+        }
+        fields = fields and a.field(begin, width) == expected;
+
+        const auto value = gen() >> (64 - width);
+        a.setField(begin, width, value);
+        for (std::size_t i = 0; i < width; ++i) {
+            modelA[begin + i] = (value >> (width - 1 - i)) & 1;
+        }
+        fields = fields and same(a, modelA);
+    }
+    check(fields, "field and setField");
+
+    auto d = a;
+    check(d == a and not(d == b), "comparison");
+    d.flip(bits - 1);
+    check(not(d == a), "comparison of the last bit");
+
+    auto e = Bits{words};
+    for (auto& word : e.words()) {
+        word = ~0ULL;
+    }
+    e.clearFrom(350);
+    auto modelE = std::vector<bool>(350, true);
+    check(same(e, modelE), "clearFrom");
+}
+
+void checkArray()
+{
+    // 3 members of 2 words, one after the other
+    auto array = ga::PackedBitsArray{3, 2};
+    array[1].set(0, true);
+    array[1].set(127, true);
+    const auto all = array.words();
+    check(array.size() == 3 and all.size() == 6 and all[2] == 1ULL << 63 and
+              all[3] == 1ULL and all[0] == 0 and all[4] == 0,
+          "members are spans of one buffer");
+
+    array[2].assign(array[1]);
+    auto copy = Bits{array[2]};
+    check(array[2] == array[1] and copy.words().size() == 2 and copy[127],
+          "assign and copy of a member");
+
+    array[0].swapPrefix(array[1], 128);
+    check(array[0][0] and array[0][127] and not array[1][0],
+          "members swap bits");
+
+    auto other = ga::PackedBitsArray{3, 2};
+    other.swap(array);
+    check(other[0][0] and array.size() == 3 and not array[0][0], "swap");
+}
+
+ga::GeneticAlgorithm makeGeneticAlgorithm(int dimensions)
+{
+    return {0.5,
+            0.005,
+            0.025,
+            0.0,
+            10.0,
+            ga::CrossoverType::Classic,
+            ga::HillclimbingType::FirstImprovementRandom,
+            100,
+            dimensions,
+            20,
+            50,
+            1'000'000,
+            "rastrigin_func",
+            true,
+            true};
+}
+
+void checkGray()
+{
+    // chromosomes are sized at run time, past the 11 words of D=20 too
+    for (const auto dimensions : {10, 20, 50}) {
+        auto ga = makeGeneticAlgorithm(dimensions);
+        // values must come from decoding, not from the cache
+        ga.useFitnessCache(0);
+        auto ok = true;
+        try {
+            ga.sanityCheck();
+        } catch (const std::exception& exception) {
+            std::cout << exception.what() << '\n';
+            ok = false;
+        }
+        check(ok, "gray round trip D" + std::to_string(dimensions));
+    }
+}
+
+} // namespace
+
+int main()
+{
+    checkBits();
+    checkArray();
+    checkGray();
+    return test::failed ? 1 : 0;
+}
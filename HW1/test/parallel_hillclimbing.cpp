@@ -0,0 +1,106 @@
+#include "../ga/FunctionManager.h"
+#include "../ga/GeneticAlgorithm.h"
+#include "Check.h"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Function calls made from several threads at once must all be counted, and a
+// GA run hillclimbing its population on several threads must finish with a
+// finite best value, within the call budget and after some hillclimbing calls,
+// with every HillclimbingType. Run from HW1, reads input_data.
+
+namespace {
+
+using test::check;
+
+void checkCount()
+{
+    constexpr auto threads = 4;
+    constexpr auto calls = 2000;
+    constexpr auto dimensions = 10;
+    ga::FunctionManager function{"cf01", dimensions, true, true};
+    {
+        std::vector<std::jthread> workers;
+        for (auto t = 0; t < threads; ++t) {
+            workers.emplace_back([&function]() {
+                std::vector<double> x(dimensions, 1.0);
+                std::vector<double> aux(dimensions);
+                auto neighbours = function.deltaEvaluator();
+                neighbours.reset(x);
+                for (auto i = 0; i < calls; ++i) {
+                    function(x, aux);
+                    function(neighbours, i % dimensions, 2.0);
+                }
+            });
+        }
+    }
+    check(function.count() == threads * calls * 2, "calls of all threads");
+}
+
+// a run may go over maxCalls by the evaluation of one population and a few
+// calls per climbing thread
+void checkBudget(const ga::GeneticAlgorithm& ga, double value,
+                 const std::string& what)
+{
+    check(std::isfinite(value) and ga.count() <= ga.maxCalls() + 101,
+          what + " within budget");
+    check(ga.hillclimbingCount() > 0, what + " hillclimbed");
+}
+
+void checkRun()
+{
+    for (const auto threads : {1, 4}) {
+        auto ga = ga::getDefault("rastrigin_func");
+        ga.useHillclimbing(threads);
+        const auto value = ga.run();
+        std::cout << threads << " threads: " << value << ", " << ga.count()
+                  << " calls, " << ga.hillclimbingCount() << " climbing\n";
+        checkBudget(ga, value,
+                    "memetic run on " + std::to_string(threads) + " threads");
+    }
+}
+
+void checkStrategies()
+{
+    const auto types = {
+        std::pair{ga::HillclimbingType::BestImprovement, "best"},
+        std::pair{ga::HillclimbingType::FirstImprovement, "first"},
+        std::pair{ga::HillclimbingType::FirstImprovementRandom, "random"},
+    };
+    for (const auto& [type, name] : types) {
+        ga::GeneticAlgorithm ga{0.5,
+                                0.005,
+                                0.025,
+                                0.0,
+                                10.0,
+                                ga::CrossoverType::Sorted,
+                                type,
+                                ga::constants::populationSize,
+                                10,
+                                20,
+                                50,
+                                1'000'000,
+                                "rastrigin_func",
+                                true,
+                                true};
+        ga.useHillclimbing(2);
+        const auto value = ga.run();
+        std::cout << name << " improvement: " << value << '\n';
+        checkBudget(ga, value, std::string{name} + " improvement hillclimbing");
+    }
+}
+
+} // namespace
+
+int main()
+{
+    checkCount();
+    checkRun();
+    checkStrategies();
+    return test::failed ? 1 : 0;
+}
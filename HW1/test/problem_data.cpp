@@ -0,0 +1,135 @@
+#include "../ga/FunctionManager.h"
+#include "../ga/ProblemData.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Threads asking for the same problem data at once must get one shared copy,
+// loaded once, different keys must load at the same time, and function
+// managers built concurrently must still evaluate like one built alone. Run
+// from HW1, reads input_data.
+
+namespace {
+
+constexpr auto threads = 8;
+
+bool sharedLoad()
+{
+    std::atomic<int> loads = 0;
+    const auto load = [&] {
+        ++loads;
+        // slow enough for the other threads to arrive meanwhile
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        return cec22::ProblemData{{1.0, 2.0}, {}, {}};
+    };
+    const auto key = cec22::ProblemKey{"test", 1, 2, true, false};
+
+    std::vector<std::shared_ptr<const cec22::ProblemData>> data(threads);
+    std::vector<std::jthread> workers;
+    for (auto i = 0; i < threads; ++i) {
+        workers.emplace_back(
+            [&, i] { data[i] = cec22::problemData(key, load); });
+    }
+    workers.clear();
+
+    auto ok = loads == 1;
+    for (const auto& d : data) {
+        ok = ok and d == data.front();
+    }
+    std::cout << (ok ? "ok   " : "FAIL ") << loads << " loads, "
+              << data.front().use_count() - 1 << " users\n";
+    return ok;
+}
+
+bool failedLoad()
+{
+    const auto key = cec22::ProblemKey{"test", 2, 2, true, false};
+    try {
+        cec22::problemData(key, []() -> cec22::ProblemData {
+            throw std::runtime_error{"Read error"};
+        });
+    } catch (const std::runtime_error&) {
+    }
+    // nothing was kept, the next call loads
+    const auto data = cec22::problemData(
+        key, [] { return cec22::ProblemData{{3.0}, {}, {}}; });
+    const auto ok = data->shift == std::vector<double>{3.0};
+    std::cout << (ok ? "ok   " : "FAIL ") << "load after a failed load\n";
+    return ok;
+}
+
+bool independentKeys()
+{
+    // the load of one key waits for another key to be loaded meanwhile, which
+    // a lock held over loading would keep out until the deadline
+    std::atomic<bool> otherLoaded = false;
+    auto overlapped = false;
+    const auto slowKey = cec22::ProblemKey{"test", 3, 2, true, false};
+    const auto quickKey = cec22::ProblemKey{"test", 4, 2, true, false};
+    {
+        std::jthread slow{[&] {
+            cec22::problemData(slowKey, [&] {
+                const auto deadline =
+                    std::chrono::steady_clock::now() + std::chrono::seconds{2};
+                while (not otherLoaded and
+                       std::chrono::steady_clock::now() < deadline) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                }
+                overlapped = otherLoaded;
+                return cec22::ProblemData{{1.0}, {}, {}};
+            });
+        }};
+        // the slow load starts first
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        cec22::problemData(quickKey,
+                           [] { return cec22::ProblemData{{2.0}, {}, {}}; });
+        otherLoaded = true;
+    }
+    std::cout << (overlapped ? "ok   " : "FAIL ")
+              << "another key loaded during a slow load\n";
+    return overlapped;
+}
+
+bool concurrentManagers()
+{
+    std::vector<double> x(20, 1.5);
+    std::vector<double> aux(20);
+    auto ok = true;
+    for (const auto* name : {"rastrigin_func", "hf02", "cf04"}) {
+        std::vector<double> values(threads);
+        std::vector<std::jthread> workers;
+        for (auto i = 0; i < threads; ++i) {
+            workers.emplace_back([&, i] {
+                auto point = x;
+                auto scratch = aux;
+                ga::FunctionManager function{name, 20, true, true};
+                values[i] = function(point, scratch);
+            });
+        }
+        workers.clear();
+
+        ga::FunctionManager function{name, 20, true, true};
+        const auto expected = function(x, aux);
+        auto same = true;
+        for (const auto v : values) {
+            same = same and v == expected;
+        }
+        std::cout << (same ? "ok   " : "FAIL ") << name
+                  << " built by " << threads << " threads\n";
+        ok = ok and same;
+    }
+    return ok;
+}
+
+} // namespace
+
+int main()
+{
+    const auto ok = sharedLoad() and failedLoad() and independentKeys() and
+                    concurrentManagers();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+#include "../ga/FunctionManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Time to load (or generate, the first time) the data of rastrigin_func and
+// cf04, shifted and rotated, and time per point of single point and batched
+// evaluations, from the competition sizes up to 1000 dimensions. Generated
+// data is cached in input_data as generated_<index>_D<dimensions>.bin. Run
+// from HW1.
+
+namespace {
+
+constexpr auto count = 100;
+
+// keeps the calls from being optimized away
+volatile double sink = 0.0;
+
+using Clock = std::chrono::steady_clock;
+
+double ns(Clock::time_point start, Clock::time_point end)
+{
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+void benchmark(const std::string& name, int dimensions)
+{
+    auto start = Clock::now();
+    ga::FunctionManager function{name, dimensions, true, true};
+    const auto loadMs = ns(start, Clock::now()) / 1e6;
+
+    std::mt19937_64 gen{42};
+    std::uniform_real_distribution<double> dist{-100.0, 100.0};
+    std::vector<double> points(dimensions * count);
+    for (auto& v : points) {
+        v = dist(gen);
+    }
+    std::vector<double> values(count);
+    std::vector<double> x(dimensions);
+    std::vector<double> aux(dimensions);
+
+    // fewer repetitions for the larger sizes, the rotation is quadratic
+    const auto repetitions =
+        std::max(1, 2'000'000 / (dimensions * dimensions));
+    auto total = 0.0;
+    start = Clock::now();
+    for (auto r = 0; r < repetitions; ++r) {
+        for (auto p = 0; p < count; ++p) {
+            for (auto d = 0; d < dimensions; ++d) {
+                x[d] = points[d * count + p];
+            }
+            total += function(x, aux);
+        }
+    }
+    const auto singleNs = ns(start, Clock::now()) / (repetitions * count);
+
+    start = Clock::now();
+    for (auto r = 0; r < repetitions; ++r) {
+        function.evaluateBatch(points, values);
+        total += values[0];
+    }
+    const auto batchNs = ns(start, Clock::now()) / (repetitions * count);
+    sink = total;
+
+    std::cout << std::left << std::setw(15) << name << std::right << " D"
+              << std::setw(4) << std::left << dimensions << std::right
+              << std::fixed << std::setprecision(1) << std::setw(10) << loadMs
+              << " ms" << std::setw(12) << singleNs << " ns" << std::setw(12)
+              << batchNs << " ns\n";
+}
+
+} // namespace
+
+int main()
+{
+    std::cout << "load, ns per point of single and batched evaluations\n";
+    for (const auto dimensions : {10, 20, 50, 100, 500, 1000}) {
+        benchmark("rastrigin_func", dimensions);
+        benchmark("cf04", dimensions);
+    }
+}
@@ -14,7 +14,17 @@ constexpr double PI = 3.1415926535897932384626433832795029;
 constexpr double E = 2.7182818284590452353602874713526625;
 
 using vector_begin = std::vector<double>::const_iterator;
-using matrix_begin = std::vector<std::vector<double>>::const_iterator;
+
+/// First row of a (sub)matrix of a Matrix, rows are stride doubles apart
+struct matrix_begin {
+    const double* first;
+    std::size_t stride;
+};
+
+matrix_begin rowsFrom(const Matrix& matrix, std::size_t row)
+{
+    return {matrix.row(row), matrix.stride()};
+}
 
 struct VectorRange {
     std::vector<double>::iterator begin;
@@ -37,18 +47,34 @@ void shiftfunc(const std::vector<double>& x, std::vector<double>& aux,
                    aux.begin(), std::minus<double>());
 }
 
-void rotatefunc(std::vector<double>& vec, const matrix_begin rotateBegin)
+/// out = M * in, for the n x n matrix starting at rotateBegin. in is padded
+/// with zeros up to the stride. When rows is not null, out[i] is computed with
+/// matrix row rows[i], which applies the hybrid permutation in the same pass.
+/// Runs the simd::rotate build of the active instruction set.
+void rotatefunc(const double* in, double* out, const matrix_begin rotateBegin,
+                std::size_t n, const std::size_t* rows = nullptr)
 {
-    // assuming vec.size() == rotate.size() == rotate[0].size() == aux.size()
-    const auto n = vec.size();
-    auto aux = std::vector<double>(n, 0.0);
-    for (std::size_t i = 0; i < n; ++i) {
-        for (std::size_t j = 0; j < n; ++j) {
-            aux[i] += vec[j] * rotateBegin[i][j];
-            // accesing iterator as if it were a matrix
-        }
+    simd::rotate(in, out, rotateBegin.first, rotateBegin.stride, n, rows);
+}
+
+/// Per thread buffer of at least size doubles. It only grows, so steady state
+/// evaluations do not allocate. Its content is only valid until the next call.
+std::vector<double>& threadScratch(std::size_t size)
+{
+    thread_local auto scratch = std::vector<double>{};
+    if (scratch.size() < size) {
+        scratch.resize(size);
     }
-    std::swap(aux, vec); // swapping result to back to vec
+    return scratch;
+}
+
+/// Input buffer of the rotation, padded with zeros up to stride
+double* rotationScratch(std::size_t n, std::size_t stride)
+{
+    auto& scratch = threadScratch(stride);
+    // padding may hold values of a longer vector from a previous call
+    std::fill(scratch.begin() + n, scratch.begin() + stride, 0.0);
+    return scratch.data();
 }
 
 // const VectorRange is misleading. Value of iterators can change, the position
@@ -79,14 +105,6 @@ void multiplyVectorWithScalar(std::vector<double>& vec, double scalar)
         std::bind(std::multiplies<double>(), std::placeholders::_1, scalar));
 }
 
-void rotate(std::vector<double>& vec, const matrix_begin rotateBegin,
-            bool rotateFlag)
-{
-    if (rotateFlag) [[likely]] {
-        rotatefunc(vec, rotateBegin);
-    }
-}
-
 void shiftRotateTransform(const std::vector<double>& x,
                           std::vector<double>& aux,
                           const vector_begin shiftBegin,
@@ -94,9 +112,19 @@ void shiftRotateTransform(const std::vector<double>& x,
                           bool shiftFlag, bool rotateFlag)
 {
     // shift rotate transform with shift rate != 1.0
-    shift(x, aux, shiftBegin, shiftFlag);
-    multiplyVectorWithScalar(aux, shiftRate);
-    rotate(aux, rotateBegin, rotateFlag);
+    if (not rotateFlag) [[unlikely]] {
+        shift(x, aux, shiftBegin, shiftFlag);
+        multiplyVectorWithScalar(aux, shiftRate);
+        return;
+    }
+
+    // shifting into the rotation input, then rotating straight into aux
+    const auto n = x.size();
+    auto* shifted = rotationScratch(n, rotateBegin.stride);
+    for (std::size_t i = 0; i < n; ++i) {
+        shifted[i] = (shiftFlag ? x[i] - shiftBegin[i] : x[i]) * shiftRate;
+    }
+    rotatefunc(shifted, aux.data(), rotateBegin, n);
 }
 
 void shiftRotateTransform(const std::vector<double>& x,
@@ -106,42 +134,58 @@ void shiftRotateTransform(const std::vector<double>& x,
                           bool rotateFlag)
 {
     // shift rotate transform with shiftRate = 1.0
-    shift(x, aux, shiftBegin, shiftFlag);
-    rotate(aux, rotateBegin, rotateFlag);
+    if (not rotateFlag) [[unlikely]] {
+        shift(x, aux, shiftBegin, shiftFlag);
+        return;
+    }
+    // multiplying by 1.0 is exact
+    shiftRotateTransform(x, aux, shiftBegin, rotateBegin, 1.0, shiftFlag,
+                         rotateFlag);
 }
 
 void shiftRotateTransform(const std::vector<double>& x,
                           std::vector<double>& aux,
                           const std::vector<double>& shift,
-                          const std::vector<std::vector<double>>& rotate,
+                          const Matrix& rotate,
                           double shiftRate, bool shiftFlag, bool rotateFlag)
 {
-    shiftRotateTransform(x, aux, shift.cbegin(), rotate.cbegin(), shiftRate,
+    shiftRotateTransform(x, aux, shift.cbegin(), rowsFrom(rotate, 0), shiftRate,
                          shiftFlag, rotateFlag);
 }
 
 void shiftRotateTransform(const std::vector<double>& x,
                           std::vector<double>& aux,
                           const std::vector<double>& shift,
-                          const std::vector<std::vector<double>>& rotate,
-                          bool shiftFlag, bool rotateFlag)
+                          const Matrix& rotate, bool shiftFlag, bool rotateFlag)
 {
-    shiftRotateTransform(x, aux, shift.cbegin(), rotate.cbegin(), shiftFlag,
+    shiftRotateTransform(x, aux, shift.cbegin(), rowsFrom(rotate, 0), shiftFlag,
                          rotateFlag);
 }
 
-void applyPermutation(std::vector<double>& nums,
-                      const std::vector<std::size_t>& indices)
+/// aux = P * M * (x - shift) in one pass, P being the permutation of the
+/// hybrid functions: aux[k] is component indices[k] of the shifted and rotated
+/// point
+void permutedTransform(const std::vector<double>& x, std::vector<double>& aux,
+                       const std::vector<double>& shift, const Matrix& rotate,
+                       const std::vector<std::size_t>& indices, bool shiftFlag,
+                       bool rotateFlag)
 {
-    auto aux = std::vector<double>{};
-    aux.reserve(indices.size());
-
-    // assuming indices.size() == nums.size()
-    std::transform(indices.begin(), indices.end(), std::back_inserter(aux),
-                   [&](auto i) { return nums[i]; });
+    const auto n = x.size();
+    // assuming indices.size() == x.size()
+    if (not rotateFlag) [[unlikely]] {
+        for (std::size_t k = 0; k < n; ++k) {
+            const auto i = indices[k];
+            aux[k] = shiftFlag ? x[i] - shift[i] : x[i];
+        }
+        return;
+    }
 
-    // moving result of permutation to nums
-    std::swap(aux, nums);
+    const auto begin = rowsFrom(rotate, 0);
+    auto* shifted = rotationScratch(n, begin.stride);
+    for (std::size_t i = 0; i < n; ++i) {
+        shifted[i] = shiftFlag ? x[i] - shift[i] : x[i];
+    }
+    rotatefunc(shifted, aux.data(), begin, n, indices.data());
 }
 
 template <std::size_t Size>
@@ -203,12 +247,11 @@ double do_ackley_func(const VectorRange& x)
 }
 
 double ackley_func(const std::vector<double>& x, std::vector<double>& aux,
-                   const std::vector<double>& shift,
-                   const std::vector<std::vector<double>>& rotate,
+                   const std::vector<double>& shift, const Matrix& rotate,
                    bool shiftFlag, bool rotateFlag)
 {
     // shift rate is 1.0
-    shiftRotateTransform(x, aux, shift.cbegin(), rotate.cbegin(), shiftFlag,
+    shiftRotateTransform(x, aux, shift.cbegin(), rowsFrom(rotate, 0), shiftFlag,
                          rotateFlag);
 
     return do_ackley_func({aux.begin(), aux.end()});
@@ -250,11 +293,10 @@ bent_cigar_func(const std::vector<double>& x, std::vector<double>& aux,
 }
 
 double bent_cigar_func(const std::vector<double>& x, std::vector<double>& aux,
-                       const std::vector<double>& shift,
-                       const std::vector<std::vector<double>>& rotate,
+                       const std::vector<double>& shift, const Matrix& rotate,
                        bool shiftFlag, bool rotateFlag)
 {
-    return bent_cigar_func(x, aux, shift.cbegin(), rotate.cbegin(), shiftFlag,
+    return bent_cigar_func(x, aux, shift.cbegin(), rowsFrom(rotate, 0), shiftFlag,
                            rotateFlag);
 }
 
@@ -274,11 +316,10 @@ discus_func(const std::vector<double>& x, std::vector<double>& aux,
 }
 
 double discus_func(const std::vector<double>& x, std::vector<double>& aux,
-                   const std::vector<double>& shift,
-                   const std::vector<std::vector<double>>& rotate,
+                   const std::vector<double>& shift, const Matrix& rotate,
                    bool shiftFlag, bool rotateFlag)
 {
-    return discus_func(x, aux, shift.cbegin(), rotate.cbegin(), shiftFlag,
+    return discus_func(x, aux, shift.cbegin(), rowsFrom(rotate, 0), shiftFlag,
                        rotateFlag);
 }
 
@@ -299,11 +340,10 @@ ellips_func(const std::vector<double>& x, std::vector<double>& aux,
 }
 
 double ellips_func(const std::vector<double>& x, std::vector<double>& aux,
-                   const std::vector<double>& shift,
-                   const std::vector<std::vector<double>>& rotate,
+                   const std::vector<double>& shift, const Matrix& rotate,
                    bool shiftFlag, bool rotateFlag)
 {
-    return ellips_func(x, aux, shift.cbegin(), rotate.cbegin(), shiftFlag,
+    return ellips_func(x, aux, shift.cbegin(), rowsFrom(rotate, 0), shiftFlag,
                        rotateFlag);
 }
 
@@ -337,11 +377,10 @@ escaffer6_func(const std::vector<double>& x, std::vector<double>& aux,
 }
 
 double escaffer6_func(const std::vector<double>& x, std::vector<double>& aux,
-                      const std::vector<double>& shift,
-                      const std::vector<std::vector<double>>& rotate,
+                      const std::vector<double>& shift, const Matrix& rotate,
                       bool shiftFlag, bool rotateFlag)
 {
-    return escaffer6_func(x, aux, shift.cbegin(), rotate.cbegin(), shiftFlag,
+    return escaffer6_func(x, aux, shift.cbegin(), rowsFrom(rotate, 0), shiftFlag,
                           rotateFlag);
 }
 
@@ -363,11 +402,10 @@ griewank_func(const std::vector<double>& x, std::vector<double>& aux,
 }
 
 double griewank_func(const std::vector<double>& x, std::vector<double>& aux,
-                     const std::vector<double>& shift,
-                     const std::vector<std::vector<double>>& rotate,
+                     const std::vector<double>& shift, const Matrix& rotate,
                      bool shiftFlag, bool rotateFlag)
 {
-    return griewank_func(x, aux, shift.cbegin(), rotate.cbegin(), shiftFlag,
+    return griewank_func(x, aux, shift.cbegin(), rowsFrom(rotate, 0), shiftFlag,
                          rotateFlag);
 }
 
@@ -396,11 +434,10 @@ double do_grie_rosen_func(const VectorRange& x)
 }
 
 double grie_rosen_func(const std::vector<double>& x, std::vector<double>& aux,
-                       const std::vector<double>& shift,
-                       const std::vector<std::vector<double>>& rotate,
+                       const std::vector<double>& shift, const Matrix& rotate,
                        bool shiftFlag, bool rotateFlag)
 {
-    shiftRotateTransform(x, aux, shift.cbegin(), rotate.cbegin(), 5.0 / 100.0,
+    shiftRotateTransform(x, aux, shift.cbegin(), rowsFrom(rotate, 0), 5.0 / 100.0,
                          shiftFlag, rotateFlag);
 
     return do_grie_rosen_func({aux.begin(), aux.end()});
@@ -429,11 +466,10 @@ double do_happycat_func(const VectorRange& x)
 }
 
 double happycat_func(const std::vector<double>& x, std::vector<double>& aux,
-                     const std::vector<double>& shift,
-                     const std::vector<std::vector<double>>& rotate,
+                     const std::vector<double>& shift, const Matrix& rotate,
                      bool shiftFlag, bool rotateFlag)
 {
-    shiftRotateTransform(x, aux, shift.cbegin(), rotate.cbegin(), 5.0 / 100.0,
+    shiftRotateTransform(x, aux, shift.cbegin(), rowsFrom(rotate, 0), 5.0 / 100.0,
                          shiftFlag, rotateFlag);
 
     return do_happycat_func({aux.begin(), aux.end()});
@@ -478,11 +514,10 @@ double hgbat_func(const VectorRange& x)
 }
 
 double hgbat_func(const std::vector<double>& x, std::vector<double>& aux,
-                  const std::vector<double>& shift,
-                  const std::vector<std::vector<double>>& rotate,
+                  const std::vector<double>& shift, const Matrix& rotate,
                   bool shiftFlag, bool rotateFlag)
 {
-    return hgbat_func(x, aux, shift.cbegin(), rotate.cbegin(), shiftFlag,
+    return hgbat_func(x, aux, shift.cbegin(), rowsFrom(rotate, 0), shiftFlag,
                       rotateFlag);
 }
 
@@ -503,11 +538,10 @@ rosenbrock_func(const std::vector<double>& x, std::vector<double>& aux,
 }
 
 double rosenbrock_func(const std::vector<double>& x, std::vector<double>& aux,
-                       const std::vector<double>& shift,
-                       const std::vector<std::vector<double>>& rotate,
+                       const std::vector<double>& shift, const Matrix& rotate,
                        bool shiftFlag, bool rotateFlag)
 {
-    return rosenbrock_func(x, aux, shift.cbegin(), rotate.cbegin(), shiftFlag,
+    return rosenbrock_func(x, aux, shift.cbegin(), rowsFrom(rotate, 0), shiftFlag,
                            rotateFlag);
 }
 
@@ -539,11 +573,10 @@ double rastrigin_func(const VectorRange& x)
 }
 
 double rastrigin_func(const std::vector<double>& x, std::vector<double>& aux,
-                      const std::vector<double>& shift,
-                      const std::vector<std::vector<double>>& rotate,
+                      const std::vector<double>& shift, const Matrix& rotate,
                       bool shiftFlag, bool rotateFlag)
 {
-    return rastrigin_func(x, aux, shift.cbegin(), rotate.cbegin(), shiftFlag,
+    return rastrigin_func(x, aux, shift.cbegin(), rowsFrom(rotate, 0), shiftFlag,
                           rotateFlag);
 }
 
@@ -590,11 +623,10 @@ double schwefel_func(const VectorRange& x)
 }
 
 double schwefel_func(const std::vector<double>& x, std::vector<double>& aux,
-                     const std::vector<double>& shift,
-                     const std::vector<std::vector<double>>& rotate,
+                     const std::vector<double>& shift, const Matrix& rotate,
                      bool shiftFlag, bool rotateFlag)
 {
-    return schwefel_func(x, aux, shift.cbegin(), rotate.cbegin(), shiftFlag,
+    return schwefel_func(x, aux, shift.cbegin(), rowsFrom(rotate, 0), shiftFlag,
                          rotateFlag);
 }
 
@@ -619,8 +651,7 @@ double do_schaffer_F7_func(const VectorRange& x)
 }
 
 double schaffer_F7_func(const std::vector<double>& x, std::vector<double>& aux,
-                        const std::vector<double>& shift,
-                        const std::vector<std::vector<double>>& rotate,
+                        const std::vector<double>& shift, const Matrix& rotate,
                         bool shiftFlag, [[maybe_unused]] bool rotateFlag)
 {
     // schaffer_F7_func is wrong, it's not rotated
@@ -639,8 +670,7 @@ double schaffer_F7_func(const VectorRange& x)
 
 double
 step_rastrigin_func(const std::vector<double>& x, std::vector<double>& aux,
-                    const std::vector<double>& shift,
-                    const std::vector<std::vector<double>>& rotate,
+                    const std::vector<double>& shift, const Matrix& rotate,
                     bool shiftFlag, bool rotateFlag)
 {
     return rastrigin_func(x, aux, shift, rotate, shiftFlag, rotateFlag);
@@ -648,7 +678,7 @@ step_rastrigin_func(const std::vector<double>& x, std::vector<double>& aux,
 
 double levy_func(const std::vector<double>& x, std::vector<double>& aux,
                  const std::vector<double>& shift,
-                 const std::vector<std::vector<double>>& rotate, bool shiftFlag,
+                 const Matrix& rotate, bool shiftFlag,
                  bool rotateFlag)
 {
     // min is 1.49966e-32, close to 0
@@ -672,8 +702,7 @@ double levy_func(const std::vector<double>& x, std::vector<double>& aux,
 }
 
 double zakharov_func(const std::vector<double>& x, std::vector<double>& aux,
-                     const std::vector<double>& shift,
-                     const std::vector<std::vector<double>>& rotate,
+                     const std::vector<double>& shift, const Matrix& rotate,
                      bool shiftFlag, bool rotateFlag)
 {
     // shift rate is 1.0
@@ -683,7 +712,7 @@ double zakharov_func(const std::vector<double>& x, std::vector<double>& aux,
     auto sum2 = 0.0;
     for (std::size_t i = 0, n = aux.size(); i < n; ++i) {
         sum1 += aux[i] * aux[i];
-        sum2 += 0.5 * i * aux[i];
+        sum2 += 0.5 * (i + 1) * aux[i];
     }
     return sum1 + sum2 * sum2 + sum2 * sum2 * sum2 * sum2;
 }
@@ -696,10 +725,10 @@ double do_katsuura_func(const VectorRange& x)
     for (auto i = 0; i < size; ++i) {
         auto temp = 0.0;
         const auto xi = *std::next(x.begin, i);
-        for (auto j = 1; j < 33; ++j) {
-            const auto temp1 = std::pow(2.0, j);
-            const auto temp2 = temp1 * xi;
-            temp += std::fabs(temp2 - std::floor(temp2 + 0.5)) / temp1;
+        for (auto j = 0; j < 32; ++j) {
+            const auto temp2 = katsuuraScales.up[j] * xi;
+            temp += std::fabs(temp2 - std::floor(temp2 + 0.5)) *
+                    katsuuraScales.down[j];
         }
         f *= std::pow(1.0 + (i + 1) * temp, 10.0 / temp3);
     }
@@ -708,8 +737,7 @@ double do_katsuura_func(const VectorRange& x)
 }
 
 double katsuura_func(const std::vector<double>& x, std::vector<double>& aux,
-                     const std::vector<double>& shift,
-                     const std::vector<std::vector<double>>& rotate,
+                     const std::vector<double>& shift, const Matrix& rotate,
                      bool shiftFlag, bool rotateFlag)
 {
     shiftRotateTransform(x, aux, shift, rotate, 5.0 / 100.0, shiftFlag,
@@ -727,14 +755,12 @@ double katsuura_func(const VectorRange& x)
 
 double
 hf01(const std::vector<double>& x, std::vector<double>& aux,
-     const std::vector<double>& shift,
-     const std::vector<std::vector<double>>& rotate,
+     const std::vector<double>& shift, const Matrix& rotate,
      const std::vector<std::size_t>& indices, bool shiftFlag, bool rotateFlag)
 {
     // [0.4, 0.4, 0.2]
     // shift rate is 1.0
-    shiftRotateTransform(x, aux, shift, rotate, shiftFlag, rotateFlag);
-    applyPermutation(aux, indices);
+    permutedTransform(x, aux, shift, rotate, indices, shiftFlag, rotateFlag);
 
     const auto limit = std::ceil(0.4 * aux.size());
     const auto margin_1 = std::next(aux.begin(), limit); // 0.4
@@ -751,14 +777,12 @@ hf01(const std::vector<double>& x, std::vector<double>& aux,
 
 double
 hf02(const std::vector<double>& x, std::vector<double>& aux,
-     const std::vector<double>& shift,
-     const std::vector<std::vector<double>>& rotate,
+     const std::vector<double>& shift, const Matrix& rotate,
      const std::vector<std::size_t>& indices, bool shiftFlag, bool rotateFlag)
 {
     // [0.1, 0.2, 0.2, 0.2, 0.1, 0.2]
     // shift rate is 1.0
-    shiftRotateTransform(x, aux, shift, rotate, shiftFlag, rotateFlag);
-    applyPermutation(aux, indices);
+    permutedTransform(x, aux, shift, rotate, indices, shiftFlag, rotateFlag);
 
     const auto limit1 = std::ceil(0.1 * aux.size());
     const auto limit2 = std::ceil(0.2 * aux.size());
@@ -776,8 +800,12 @@ hf02(const std::vector<double>& x, std::vector<double>& aux,
     const auto range4 = VectorRange{margin3, margin4};
     const auto range5 = VectorRange{margin4, margin5};
     // const auto range6 = VectorRange{margin5, x.end()}; // CORRECT
-    auto copy = std::vector<double>{aux.begin(), aux.begin() + 2};
-    const auto range6 = VectorRange{copy.begin(), copy.end()}; // WRONG
+    // WRONG, as the reference: Schaffer F7 runs on as many of the first
+    // (unscaled) values as the last part has
+    const auto size6 = std::distance(margin5, aux.end());
+    auto& copy = threadScratch(size6);
+    std::copy_n(aux.begin(), size6, copy.begin());
+    const auto range6 = VectorRange{copy.begin(), copy.begin() + size6};
 
     return hgbat_func(range1) + katsuura_func(range2) + ackley_func(range3) +
            rastrigin_func(range4) + schwefel_func(range5) +
@@ -786,14 +814,12 @@ hf02(const std::vector<double>& x, std::vector<double>& aux,
 
 double
 hf03(const std::vector<double>& x, std::vector<double>& aux,
-     const std::vector<double>& shift,
-     const std::vector<std::vector<double>>& rotate,
+     const std::vector<double>& shift, const Matrix& rotate,
      const std::vector<std::size_t>& indices, bool shiftFlag, bool rotateFlag)
 {
     //  [0.3, 0.2, 0.2, 0.1, 0.2]
     // shift rate is 1.0
-    shiftRotateTransform(x, aux, shift, rotate, shiftFlag, rotateFlag);
-    applyPermutation(aux, indices);
+    permutedTransform(x, aux, shift, rotate, indices, shiftFlag, rotateFlag);
 
     const auto limit1 = std::ceil(0.1 * aux.size());
     const auto limit2 = std::ceil(0.2 * aux.size());
@@ -818,7 +844,7 @@ hf03(const std::vector<double>& x, std::vector<double>& aux,
 
 double cf01(const std::vector<double>& x, std::vector<double>& aux,
             const std::vector<double>& shift,
-            const std::vector<std::vector<double>>& rotate, bool rotateFlag)
+            const Matrix& rotate, bool rotateFlag)
 {
     // asumming that shift.size and rotate.size is (at least) 5 * x.size
     const auto size = x.size();
@@ -827,10 +853,10 @@ double cf01(const std::vector<double>& x, std::vector<double>& aux,
     const auto shift_margin_3 = std::next(shift_margin_2, size);
     const auto shift_margin_4 = std::next(shift_margin_3, size);
 
-    const auto rotate_margin_1 = std::next(rotate.cbegin(), size);
-    const auto rotate_margin_2 = std::next(rotate_margin_1, size);
-    const auto rotate_margin_3 = std::next(rotate_margin_2, size);
-    const auto rotate_margin_4 = std::next(rotate_margin_3, size);
+    const auto rotate_margin_1 = rowsFrom(rotate, size);
+    const auto rotate_margin_2 = rowsFrom(rotate, 2 * size);
+    const auto rotate_margin_3 = rowsFrom(rotate, 3 * size);
+    const auto rotate_margin_4 = rowsFrom(rotate, 4 * size);
 
     constexpr auto N = 5;
     // fit is function result * lambda + bias
@@ -839,7 +865,7 @@ double cf01(const std::vector<double>& x, std::vector<double>& aux,
     // bias is 0, 200, 300, 100, 400
 
     const std::array<double, N> fit{
-        rosenbrock_func(x, aux, shift.cbegin(), rotate.cbegin(), true,
+        rosenbrock_func(x, aux, shift.cbegin(), rowsFrom(rotate, 0), true,
                         rotateFlag),
         ellips_func(x, aux, shift_margin_1, rotate_margin_1, true, rotateFlag) *
                 1e-6 +
@@ -862,22 +888,22 @@ double cf01(const std::vector<double>& x, std::vector<double>& aux,
 
 double cf02(const std::vector<double>& x, std::vector<double>& aux,
             const std::vector<double>& shift,
-            const std::vector<std::vector<double>>& rotate, bool rotateFlag)
+            const Matrix& rotate, bool rotateFlag)
 {
     // asumming that shift.size and rotate.size is (at least) 3 * x.size
     const auto size = x.size();
     const auto shift_margin_1 = std::next(shift.begin(), size);
     const auto shift_margin_2 = std::next(shift_margin_1, size);
 
-    const auto rotate_margin_1 = std::next(rotate.begin(), size);
-    const auto rotate_margin_2 = std::next(rotate_margin_1, size);
+    const auto rotate_margin_1 = rowsFrom(rotate, size);
+    const auto rotate_margin_2 = rowsFrom(rotate, 2 * size);
 
     constexpr auto N = 3;
     // fit is function result * lambda + bias
     // lambda is 1, 1, 1
     // bias is 0, 200, 100
     const std::array<double, N> fit{
-        schwefel_func(x, aux, shift.cbegin(), rotate.cbegin(), true,
+        schwefel_func(x, aux, shift.cbegin(), rowsFrom(rotate, 0), true,
                       false), // ?? why false
         rastrigin_func(x, aux, shift_margin_1, rotate_margin_1, true,
                        rotateFlag) +
@@ -891,7 +917,7 @@ double cf02(const std::vector<double>& x, std::vector<double>& aux,
 
 double cf03(const std::vector<double>& x, std::vector<double>& aux,
             const std::vector<double>& shift,
-            const std::vector<std::vector<double>>& rotate, bool rotateFlag)
+            const Matrix& rotate, bool rotateFlag)
 {
     // asumming that shift.size and rotate.size is (at least) 5 * x.size
     const auto size = x.size();
@@ -900,10 +926,10 @@ double cf03(const std::vector<double>& x, std::vector<double>& aux,
     const auto shift_margin_3 = std::next(shift_margin_2, size);
     const auto shift_margin_4 = std::next(shift_margin_3, size);
 
-    const auto rotate_margin_1 = std::next(rotate.cbegin(), size);
-    const auto rotate_margin_2 = std::next(rotate_margin_1, size);
-    const auto rotate_margin_3 = std::next(rotate_margin_2, size);
-    const auto rotate_margin_4 = std::next(rotate_margin_3, size);
+    const auto rotate_margin_1 = rowsFrom(rotate, size);
+    const auto rotate_margin_2 = rowsFrom(rotate, 2 * size);
+    const auto rotate_margin_3 = rowsFrom(rotate, 3 * size);
+    const auto rotate_margin_4 = rowsFrom(rotate, 4 * size);
 
     constexpr auto N = 5;
     // fit is function result * lambda + bias
@@ -911,7 +937,7 @@ double cf03(const std::vector<double>& x, std::vector<double>& aux,
     // their lambda is [10000/2e+7, 1, 1000 / 100, 1,  10000 / 1e+3]
     // bias = [0, 200, 300, 400, 200]
     const std::array<double, N> fit{
-        escaffer6_func(x, aux, shift.cbegin(), rotate.cbegin(), true,
+        escaffer6_func(x, aux, shift.cbegin(), rowsFrom(rotate, 0), true,
                        rotateFlag) *
             (10000.0 / 2e+7),
         schwefel_func(x, aux, shift_margin_1, rotate_margin_1, true,
@@ -938,7 +964,7 @@ double cf03(const std::vector<double>& x, std::vector<double>& aux,
 
 double cf04(const std::vector<double>& x, std::vector<double>& aux,
             const std::vector<double>& shift,
-            const std::vector<std::vector<double>>& rotate, bool rotateFlag)
+            const Matrix& rotate, bool rotateFlag)
 {
     // asumming that shift.size and rotate.size is (at least) 6 * x.size
     const auto size = x.size();
@@ -948,18 +974,18 @@ double cf04(const std::vector<double>& x, std::vector<double>& aux,
     const auto shift_margin_4 = std::next(shift_margin_3, size);
     const auto shift_margin_5 = std::next(shift_margin_4, size);
 
-    const auto rotate_margin_1 = std::next(rotate.cbegin(), size);
-    const auto rotate_margin_2 = std::next(rotate_margin_1, size);
-    const auto rotate_margin_3 = std::next(rotate_margin_2, size);
-    const auto rotate_margin_4 = std::next(rotate_margin_3, size);
-    const auto rotate_margin_5 = std::next(rotate_margin_4, size);
+    const auto rotate_margin_1 = rowsFrom(rotate, size);
+    const auto rotate_margin_2 = rowsFrom(rotate, 2 * size);
+    const auto rotate_margin_3 = rowsFrom(rotate, 3 * size);
+    const auto rotate_margin_4 = rowsFrom(rotate, 4 * size);
+    const auto rotate_margin_5 = rowsFrom(rotate, 5 * size);
 
     constexpr auto N = 6;
     // fit is function result * lambda + bias
     // lambda = [10, 10, 2.5, 1e−26, 1e-6, 5e-4]
     // bias = [0, 300, 500, 100, 400, 200]
     const std::array<double, N> fit{
-        hgbat_func(x, aux, shift.cbegin(), rotate.cbegin(), true, rotateFlag) *
+        hgbat_func(x, aux, shift.cbegin(), rowsFrom(rotate, 0), true, rotateFlag) *
             10,
         rastrigin_func(x, aux, shift_margin_1, rotate_margin_1, true,
                        rotateFlag) *
@@ -986,12 +1012,230 @@ double cf04(const std::vector<double>& x, std::vector<double>& aux,
     return compositionFunctionCalculator<N>(x, shift, delta, fit);
 }
 
+namespace {
+
+double rastriginTerm(double z)
+{
+    return z * z - 10.0 * std::cos(2.0 * PI * z);
+}
+
+/// The terms of levy_func depending on coordinate i of n
+double levyTerm(std::size_t i, std::size_t n, double z)
+{
+    const auto w = 1.0 + z / 4.0;
+    auto f = 0.0;
+    if (i == 0) {
+        const auto temp = std::sin(PI * w);
+        f += temp * temp;
+    }
+    if (i + 1 < n) {
+        const auto temp = std::sin(PI * w + 1.0);
+        f += (w - 1.0) * (w - 1.0) * (1.0 + 10.0 * temp * temp);
+    } else {
+        const auto temp = std::sin(2.0 * PI * w);
+        f += (w - 1.0) * (w - 1.0) * (1.0 + temp * temp);
+    }
+    return f;
+}
+
+} // namespace
+
+DeltaEvaluator::DeltaEvaluator(Function function,
+                               std::shared_ptr<const ProblemData> data,
+                               bool shiftFlag, bool rotateFlag)
+    : function{function}, data{std::move(data)}, shiftFlag{shiftFlag}
+{
+    // components and their rotation, as in the functions above
+    switch (function) {
+    case Function::schaffer_F7:
+        components = {{0, false}};
+        break;
+    case Function::cf01:
+        components = {{0, rotateFlag},
+                      {1, rotateFlag},
+                      {2, rotateFlag},
+                      {3, rotateFlag},
+                      {4, false}};
+        break;
+    case Function::cf02:
+        components = {{0, false}, {1, rotateFlag}, {2, rotateFlag}};
+        break;
+    case Function::cf03:
+        components = {{0, rotateFlag},
+                      {1, rotateFlag},
+                      {2, rotateFlag},
+                      {3, rotateFlag},
+                      {4, rotateFlag}};
+        break;
+    case Function::cf04:
+        components = {{0, rotateFlag}, {1, rotateFlag}, {2, rotateFlag},
+                      {3, rotateFlag}, {4, rotateFlag}, {5, rotateFlag}};
+        break;
+    default:
+        components = {{0, rotateFlag}};
+    }
+    if (function >= Function::cf01) {
+        this->shiftFlag = true;
+    }
+    separable = (function == Function::zakharov or
+                 function == Function::rastrigin or
+                 function == Function::levy) and
+                not rotateFlag;
+}
+
+void DeltaEvaluator::reset(const std::vector<double>& x)
+{
+    const auto n = x.size();
+    point = x;
+    images.resize(components.size() * n);
+    changed.resize(images.size());
+    aux.resize(n);
+
+    const auto& shift = data->shift;
+    for (std::size_t k = 0; k < components.size(); ++k) {
+        // offsets count components, the data of component k starts at k * n
+        const auto offset = components[k].offset * n;
+        auto* image = images.data() + k * n;
+        if (components[k].rotated) {
+            const auto begin = rowsFrom(data->rotate, offset);
+            auto* shifted = rotationScratch(n, begin.stride);
+            for (std::size_t i = 0; i < n; ++i) {
+                shifted[i] = shiftFlag ? x[i] - shift[offset + i] : x[i];
+            }
+            rotatefunc(shifted, image, begin, n);
+        } else {
+            for (std::size_t i = 0; i < n; ++i) {
+                image[i] = shiftFlag ? x[i] - shift[offset + i] : x[i];
+            }
+        }
+    }
+
+    if (not separable) {
+        return;
+    }
+    terms.resize(n);
+    sums[0] = 0.0;
+    sums[1] = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (function == Function::rastrigin) {
+            terms[i] = rastriginTerm(images[i] * (5.12 / 100.0));
+            sums[0] += terms[i];
+        } else if (function == Function::zakharov) {
+            terms[i] = images[i];
+            sums[0] += terms[i] * terms[i];
+            sums[1] += 0.5 * (i + 1) * terms[i];
+        } else {
+            terms[i] = levyTerm(i, n, images[i]);
+            sums[0] += terms[i];
+        }
+    }
+}
+
+double DeltaEvaluator::evaluateWithCoordinateChange(std::size_t dimension,
+                                                    double value)
+{
+    if (separable) {
+        return evaluateSums(dimension, value);
+    }
+
+    const auto n = point.size();
+    const auto previous = point[dimension];
+    const auto step = value - previous;
+    point[dimension] = value;
+    for (std::size_t k = 0; k < components.size(); ++k) {
+        const auto offset = components[k].offset * n;
+        const auto* image = images.data() + k * n;
+        auto* out = changed.data() + k * n;
+        if (components[k].rotated) {
+            // M * (x + step * e_d) = M * x + step * column d of M
+            const auto stride = data->rotate.stride();
+            const auto* column = data->rotate.row(offset) + dimension;
+            for (std::size_t i = 0; i < n; ++i) {
+                out[i] = image[i] + step * column[i * stride];
+            }
+        } else {
+            std::copy_n(image, n, out);
+            out[dimension] =
+                shiftFlag ? value - data->shift[offset + dimension] : value;
+        }
+    }
+
+    const auto f = evaluateChanged();
+    point[dimension] = previous;
+    return f;
+}
+
+double DeltaEvaluator::evaluateSums(std::size_t dimension, double value) const
+{
+    const auto n = point.size();
+    const auto z = shiftFlag ? value - data->shift[dimension] : value;
+    const auto old = terms[dimension];
+    if (function == Function::rastrigin) {
+        const auto term = rastriginTerm(z * (5.12 / 100.0));
+        return n * 10.0 + (sums[0] - old + term);
+    }
+    if (function == Function::zakharov) {
+        const auto sum1 = sums[0] - old * old + z * z;
+        const auto sum2 = sums[1] + 0.5 * (dimension + 1) * (z - old);
+        return sum1 + sum2 * sum2 + sum2 * sum2 * sum2 * sum2;
+    }
+    return sums[0] - old + levyTerm(dimension, n, z);
+}
+
+double DeltaEvaluator::evaluateChanged()
+{
+    // the images are already shifted and rotated, the functions only apply
+    // their shift rate and the hybrid permutation
+    const auto n = point.size();
+    if (n == 10) [[likely]] {
+        return fixed::transformed<10>(function, changed.data(), point,
+                                      data->shift, data->indices);
+    }
+    if (n == 20) {
+        return fixed::transformed<20>(function, changed.data(), point,
+                                      data->shift, data->indices);
+    }
+
+    const auto& shift = data->shift;
+    const auto& rotate = data->rotate;
+    const auto& indices = data->indices;
+    switch (function) {
+    case Function::zakharov:
+        return zakharov_func(changed, aux, shift, rotate, false, false);
+    case Function::rosenbrock:
+        return rosenbrock_func(changed, aux, shift, rotate, false, false);
+    case Function::schaffer_F7:
+        return schaffer_F7_func(changed, aux, shift, rotate, false, false);
+    case Function::rastrigin:
+        return rastrigin_func(changed, aux, shift, rotate, false, false);
+    case Function::levy:
+        return levy_func(changed, aux, shift, rotate, false, false);
+    case Function::hf01:
+        return hf01(changed, aux, shift, rotate, indices, false, false);
+    case Function::hf02:
+        return hf02(changed, aux, shift, rotate, indices, false, false);
+    case Function::hf03:
+        return hf03(changed, aux, shift, rotate, indices, false, false);
+    // without fixed kernels the compositions are evaluated in full, point
+    // holds the changed coordinate
+    case Function::cf01:
+        return cf01(point, aux, shift, rotate, true);
+    case Function::cf02:
+        return cf02(point, aux, shift, rotate, true);
+    case Function::cf03:
+        return cf03(point, aux, shift, rotate, true);
+    case Function::cf04:
+        return cf04(point, aux, shift, rotate, true);
+    }
+    return 0.0;
+}
+
 int sanity_check()
 {
     auto x = std::vector<double>(10, 0.0);
     auto aux = std::vector<double>(10, 0.0);
     const auto shift = std::vector<double>(60, 0.0);
-    const auto rotate = std::vector<std::vector<double>>{};
+    const auto rotate = Matrix{};
     const auto indices = std::vector<std::size_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
     std::cout << "zakharov_func = "
               << zakharov_func(x, aux, shift, rotate, false, false)
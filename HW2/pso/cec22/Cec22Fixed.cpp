@@ -0,0 +1,955 @@
+#include "Cec22.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+namespace cec22::fixed {
+namespace {
+
+constexpr double PI = 3.1415926535897932384626433832795029;
+constexpr double E = 2.7182818284590452353602874713526625;
+
+using vec4 = double __attribute__((vector_size(Matrix::lanes * sizeof(double))));
+
+// loading through memcpy, vector types must not alias doubles
+void load(vec4& v, const double* p)
+{
+    std::memcpy(&v, p, sizeof(v));
+}
+
+double sum(const vec4& v)
+{
+    return (v[0] + v[1]) + (v[2] + v[3]);
+}
+
+/// Row length of a Matrix with D columns
+template <std::size_t D>
+constexpr std::size_t strideOf =
+    (D + Matrix::lanes - 1) / Matrix::lanes * Matrix::lanes;
+
+/// std::ceil(rate * size) of the hybrid functions, at compile time
+constexpr std::size_t ceilPart(double rate, std::size_t size)
+{
+    const auto part = rate * size;
+    const auto truncated = static_cast<std::size_t>(part);
+    return truncated < part ? truncated + 1 : truncated;
+}
+
+static_assert(ceilPart(0.4, 10) == 4 and ceilPart(0.3, 20) == 6);
+
+/// out = M * in, in the same operation order as the sse2 and avx2 builds of
+/// the runtime rotation. in is padded with zeros up to the stride, rotate is
+/// the first of D rows of a Matrix with D columns. When rows is not null,
+/// out[i] is computed with row rows[i].
+template <std::size_t D>
+void rotateBlocked(const double* in, const double* rotate, double* out,
+                   const std::size_t* rows = nullptr)
+{
+    constexpr auto stride = strideOf<D>;
+    const auto source = [=](std::size_t i) { return rows ? rows[i] : i; };
+    constexpr auto blocked = D / 4 * 4;
+    for (std::size_t i = 0; i < blocked; i += 4) {
+        const auto* r0 = rotate + source(i) * stride;
+        const auto* r1 = rotate + source(i + 1) * stride;
+        const auto* r2 = rotate + source(i + 2) * stride;
+        const auto* r3 = rotate + source(i + 3) * stride;
+        vec4 s0{}, s1{}, s2{}, s3{};
+        vec4 v, m;
+        for (std::size_t j = 0; j < stride; j += Matrix::lanes) {
+            load(v, in + j);
+            load(m, r0 + j);
+            s0 += m * v;
+            load(m, r1 + j);
+            s1 += m * v;
+            load(m, r2 + j);
+            s2 += m * v;
+            load(m, r3 + j);
+            s3 += m * v;
+        }
+        out[i] = sum(s0);
+        out[i + 1] = sum(s1);
+        out[i + 2] = sum(s2);
+        out[i + 3] = sum(s3);
+    }
+    if constexpr (blocked != D) {
+        for (std::size_t i = blocked; i < D; ++i) {
+            const auto* r = rotate + source(i) * stride;
+            vec4 s{};
+            vec4 v, m;
+            for (std::size_t j = 0; j < stride; j += Matrix::lanes) {
+                load(v, in + j);
+                load(m, r + j);
+                s += m * v;
+            }
+            out[i] = sum(s);
+        }
+    }
+}
+
+/// aux = M * ((x - shift) * rate), in the same operation order as the runtime
+/// transform. rotate is the first of D rows of a Matrix with D columns.
+/// When rows is not null, output i is computed from row (or, without
+/// rotation, component) rows[i], which applies the hybrid permutation in the
+/// same pass
+template <std::size_t D>
+void shiftRotateTransform(const double* x, double* aux, const double* shift,
+                          const double* rotate, double rate, bool shiftFlag,
+                          bool rotateFlag, const std::size_t* rows = nullptr)
+{
+    if (not rotateFlag) [[unlikely]] {
+        for (std::size_t i = 0; i < D; ++i) {
+            const auto k = rows ? rows[i] : i;
+            aux[i] = (shiftFlag ? x[k] - shift[k] : x[k]) * rate;
+        }
+        return;
+    }
+
+    std::array<double, strideOf<D>> shifted{}; // padding stays 0
+    for (std::size_t i = 0; i < D; ++i) {
+        shifted[i] = (shiftFlag ? x[i] - shift[i] : x[i]) * rate;
+    }
+    rotateBlocked<D>(shifted.data(), rotate, aux, rows);
+}
+
+/// Transform of component k, whose shift and rotation start at k * D
+template <std::size_t D>
+void componentTransform(const std::vector<double>& x, std::vector<double>& aux,
+                        const std::vector<double>& shift, const Matrix& rotate,
+                        std::size_t k, double rate, bool shiftFlag,
+                        bool rotateFlag)
+{
+    shiftRotateTransform<D>(x.data(), aux.data(),
+                            shiftFlag ? shift.data() + k * D : nullptr,
+                            rotateFlag ? rotate.row(k * D) : nullptr, rate,
+                            shiftFlag, rotateFlag);
+}
+
+/// aux = P * M * (x - shift), P being the permutation of the hybrids
+template <std::size_t D>
+void hybridTransform(const std::vector<double>& x, std::vector<double>& aux,
+                     const std::vector<double>& shift, const Matrix& rotate,
+                     const std::vector<std::size_t>& indices, bool shiftFlag,
+                     bool rotateFlag)
+{
+    shiftRotateTransform<D>(x.data(), aux.data(),
+                            shiftFlag ? shift.data() : nullptr,
+                            rotateFlag ? rotate.row(0) : nullptr, 1.0,
+                            shiftFlag, rotateFlag, indices.data());
+}
+
+// Kernels work on N values starting at x, already transformed. The hybrid
+// callers scale their part in place first, like the runtime versions.
+
+/// Shorter loops are not worth the call of a vectorized kernel
+constexpr std::size_t simdMinimum = 4;
+
+template <std::size_t N> void scale(double* x, double rate)
+{
+    for (std::size_t i = 0; i < N; ++i) {
+        x[i] *= rate;
+    }
+}
+
+template <std::size_t N> double ackley(const double* x)
+{
+    auto sum1 = 0.0;
+    auto sum2 = 0.0;
+    if constexpr (N >= simdMinimum) {
+        simd::ackley(x, N, sum1, sum2);
+    } else {
+        for (std::size_t i = 0; i < N; ++i) {
+            sum1 += x[i] * x[i];
+            sum2 += std::cos(2.0 * PI * x[i]);
+        }
+    }
+    constexpr auto n = static_cast<double>(N);
+    sum1 = -0.2 * std::sqrt(sum1 / n);
+    sum2 /= n;
+    return E - 20.0 * std::exp(sum1) - std::exp(sum2) + 20.0;
+}
+
+template <std::size_t N> double bent_cigar(const double* x)
+{
+    auto f = x[0] * x[0];
+    for (std::size_t i = 1; i < N; ++i) {
+        f = f + x[i] * x[i] * 1000000.0;
+    }
+    return f;
+}
+
+template <std::size_t N> double discus(const double* x)
+{
+    auto f = x[0] * x[0] * 1000000.0;
+    for (std::size_t i = 1; i < N; ++i) {
+        f = f + x[i] * x[i];
+    }
+    return f;
+}
+
+template <std::size_t N> double ellips(const double* x)
+{
+    constexpr auto n = N - 1.0;
+    auto f = 0.0;
+    for (std::size_t i = 0; i < N; ++i) {
+        f = f + std::pow(10.0, 6.0 * static_cast<int>(i) / n) * x[i] * x[i];
+    }
+    return f;
+}
+
+template <std::size_t N> double escaffer6(const double* x)
+{
+    const auto term = [](double first, double second) {
+        const auto xi = first * first;
+        const auto xinext = second * second;
+        const auto temp1 = std::sin(std::sqrt(xi + xinext));
+        const auto temp2 = 1.0 + 0.001 * (xi + xinext);
+        return 0.5 + (temp1 * temp1 - 0.5) / (temp2 * temp2);
+    };
+    auto f = 0.0;
+    for (std::size_t i = 0; i < N - 1; ++i) {
+        f += term(x[i], x[i + 1]);
+    }
+    return f + term(x[N - 1], x[0]);
+}
+
+template <std::size_t N> double griewank(const double* x)
+{
+    auto s = 0.0;
+    auto p = 1.0;
+    if constexpr (N >= simdMinimum) {
+        simd::griewank(x, N, s, p);
+    } else {
+        for (std::size_t i = 0; i < N; ++i) {
+            s += x[i] * x[i];
+            p *= std::cos(x[i] / std::sqrt(1.0 + i));
+        }
+    }
+    return 1.0 + s / 4000.0 - p;
+}
+
+template <std::size_t N> double grie_rosen(const double* x)
+{
+    const auto term = [](double current, double next) {
+        const auto temp1 = current * current - next;
+        const auto temp2 = current - 1.0;
+        const auto temp = 100.0 * temp1 * temp1 + temp2 * temp2;
+        return (temp * temp) / 4000.0 - std::cos(temp) + 1.0;
+    };
+    auto f = 0.0;
+    for (std::size_t i = 0; i < N - 1; ++i) {
+        f += term(x[i] + 1.0, x[i + 1] + 1.0);
+    }
+    return f + term(x[N - 1] + 1.0, x[0] + 1.0);
+}
+
+template <std::size_t N> double happycat(const double* x)
+{
+    auto sum_y = 0.0;
+    auto r2 = 0.0;
+    for (std::size_t i = 0; i < N; ++i) {
+        const auto aux = x[i] - 1.0;
+        sum_y += aux;
+        r2 += aux * aux;
+    }
+    constexpr auto n = static_cast<double>(N);
+    return std::pow(std::abs(r2 - n), 2 * 1.0 / 8.0) + (0.5 * r2 + sum_y) / n +
+           0.5;
+}
+
+template <std::size_t N> double hgbat(const double* x)
+{
+    auto sum_y = 0.0;
+    auto r2 = 0.0;
+    for (std::size_t i = 0; i < N; ++i) {
+        const auto aux = x[i] - 1.0;
+        sum_y += aux;
+        r2 += aux * aux;
+    }
+    return std::pow(std::fabs(r2 * r2 - sum_y * sum_y), 2.0 * 1.0 / 4.0) +
+           (0.5 * r2 + sum_y) / static_cast<double>(N) + 0.5;
+}
+
+template <std::size_t N> double rosenbrock(const double* x)
+{
+    auto f = 0.0;
+    for (std::size_t i = 0; i < N - 1; ++i) {
+        const auto temp = x[i] + 1.0;
+        const auto temp1 = temp * temp - x[i + 1] - 1.0;
+        f += 100.0 * temp1 * temp1 + x[i] * x[i];
+    }
+    return f;
+}
+
+template <std::size_t N> double rastrigin(const double* x)
+{
+    if constexpr (N >= simdMinimum) {
+        return N * 10.0 + simd::rastrigin(x, N);
+    }
+    auto f = N * 10.0;
+    for (std::size_t i = 0; i < N; ++i) {
+        f = f + x[i] * x[i] - 10.0 * std::cos(2.0 * PI * x[i]);
+    }
+    return f;
+}
+
+template <std::size_t N> double schwefel(const double* x)
+{
+    constexpr auto n = static_cast<double>(N);
+    auto f = 0.0;
+    for (std::size_t i = 0; i < N; ++i) {
+        const auto xi = x[i] + 4.209687462275036e+002;
+        if (xi > 500.0) {
+            const auto temp1 = (500.0 - std::fmod(xi, 500)) *
+                               std::sin(std::sqrt(500.0 - std::fmod(xi, 500)));
+            const auto temp2 = (xi - 500.0) / 100.0;
+            f = f - temp1 + temp2 * temp2 / n;
+        } else if (xi < -500.0) {
+            const auto temp1 =
+                (-500.0 + std::fmod(std::fabs(xi), 500)) *
+                std::sin(std::sqrt(500.0 - std::fmod(std::fabs(xi), 500)));
+            const auto temp2 = (xi + 500.0) / 100.0;
+            f = f - temp1 + temp2 * temp2 / n;
+        } else {
+            f = f - xi * std::sin(std::sqrt(std::fabs(xi)));
+        }
+    }
+    return 4.189828872724338e+002 * n + f;
+}
+
+template <std::size_t N> double schaffer_F7(const double* x)
+{
+    auto f = 0.0;
+    if constexpr (N > simdMinimum) {
+        f = simd::schaffer_F7(x, N);
+    } else {
+        for (std::size_t i = 0; i < N - 1; ++i) {
+            const auto si = std::sqrt(x[i] * x[i] + x[i + 1] * x[i + 1]);
+            const auto temp = std::sin(50.0 * std::pow(si, 0.2));
+            const auto sqrtsi = std::sqrt(si);
+            f += sqrtsi + sqrtsi * temp * temp;
+        }
+    }
+    constexpr auto n = static_cast<double>(N - 1);
+    return f * f / n / n;
+}
+
+template <std::size_t N> double zakharov(const double* x)
+{
+    auto sum1 = 0.0;
+    auto sum2 = 0.0;
+    for (std::size_t i = 0; i < N; ++i) {
+        sum1 += x[i] * x[i];
+        sum2 += 0.5 * (i + 1) * x[i];
+    }
+    return sum1 + sum2 * sum2 + sum2 * sum2 * sum2 * sum2;
+}
+
+template <std::size_t N> double levy(const double* x)
+{
+    const auto w = [](auto elem) { return 1.0 + (elem - 0.0) / 4.0; };
+
+    const auto term1 = std::sin(PI * w(x[0]));
+    const auto term2 = simd::levy(x, N);
+    const auto last = w(x[N - 1]);
+    const auto temp = std::sin(2.0 * PI * last);
+    const auto term3 = (last - 1.0) * (last - 1.0) * (1.0 + temp * temp);
+    return term1 * term1 + term2 + term3;
+}
+
+/// 10 / N^1.2, computed once at startup
+template <std::size_t N>
+const double katsuuraExponent = 10.0 / std::pow(static_cast<double>(N), 1.2);
+
+template <std::size_t N> double katsuura(const double* x)
+{
+    const auto f = simd::katsuura(x, N, katsuuraExponent<N>);
+    constexpr auto temp1 = 10.0 / static_cast<double>(N) / static_cast<double>(N);
+    return f * temp1 - temp1;
+}
+
+/// The N components of a composition function, transformed together. One
+/// sweep over the shift blocks computes both the scaled displacements
+/// (x - o_k) * rates[k] and the squared distances |x - o_k|^2 of the weights,
+/// then the stacked N * D x D matrix rotates the components marked in rotated.
+/// Blocks of 4 rows stay within a component, so they share the loads of its
+/// displacement. Each value is the same as with the per component transform.
+template <std::size_t D, std::size_t N> struct Composition {
+    Composition(const std::vector<double>& x, const std::vector<double>& shift,
+                const Matrix& rotate, const std::array<double, N>& rates,
+                const std::array<bool, N>& rotated)
+    {
+        constexpr auto stride = strideOf<D>;
+        std::array<double, N * stride> displaced{}; // padding stays 0
+        for (std::size_t k = 0; k < N; ++k) {
+            const auto* o = shift.data() + k * D;
+            auto* d = displaced.data() + k * stride;
+            auto norm = 0.0;
+            for (std::size_t j = 0; j < D; ++j) {
+                const auto temp = x[j] - o[j];
+                norm += temp * temp;
+                d[j] = temp * rates[k];
+            }
+            norms[k] = norm;
+        }
+
+        for (std::size_t k = 0; k < N; ++k) {
+            const auto* d = displaced.data() + k * stride;
+            if (rotated[k]) {
+                rotateBlocked<D>(d, rotate.row(k * D), z.data() + k * D);
+            } else {
+                std::copy_n(d, D, z.data() + k * D);
+            }
+        }
+    }
+
+    /// From images, the components already shifted and rotated, D apart,
+    /// but not yet scaled by their rates
+    Composition(const double* images, const std::vector<double>& x,
+                const std::vector<double>& shift,
+                const std::array<double, N>& rates)
+    {
+        for (std::size_t k = 0; k < N; ++k) {
+            const auto* o = shift.data() + k * D;
+            auto norm = 0.0;
+            for (std::size_t j = 0; j < D; ++j) {
+                const auto temp = x[j] - o[j];
+                norm += temp * temp;
+                z[k * D + j] = images[k * D + j] * rates[k];
+            }
+            norms[k] = norm;
+        }
+    }
+
+    /// Transformed component k
+    double* operator[](std::size_t k)
+    {
+        return z.data() + k * D;
+    }
+
+    std::array<double, N * D> z;
+    std::array<double, N> norms;
+};
+
+template <std::size_t D, std::size_t Size>
+double compositionFunctionCalculator(const std::array<double, Size>& norms,
+                                     const std::array<int, Size>& delta,
+                                     const std::array<double, Size>& fit)
+{
+    auto w_max = 0.0;
+    auto w_sum = 0.0;
+    std::array<double, Size> w{0.0};
+    for (std::size_t i = 0; i < Size; ++i) {
+        w[i] = norms[i];
+
+        // else will happen only when x is shift
+        if (w[i] != 0.0) [[likely]] {
+            w[i] = std::sqrt(1.0 / w[i]) *
+                   std::exp(-w[i] / 2.0 / D / delta[i] / delta[i]);
+        } else [[unlikely]] {
+            w[i] = 1.0e99; // INF
+        }
+
+        if (w[i] > w_max) {
+            w_max = w[i];
+        }
+        w_sum += w[i];
+    }
+
+    // This does not happen if there's any w[i] >= 0
+    if (w_max == 0.0) [[unlikely]] {
+        return std::accumulate(fit.begin(), fit.end(), 0.0) / Size;
+    }
+
+    auto f = 0.0;
+    for (std::size_t i = 0; i < Size; ++i) {
+        f = f + w[i] / w_sum * fit[i];
+    }
+    return f;
+}
+
+/// Parts of hf01 on z, the permuted transform, scaled in place
+template <std::size_t D> double hf01Parts(double* z)
+{
+    // [0.4, 0.4, 0.2]
+    constexpr auto limit = ceilPart(0.4, D);
+    constexpr auto margin1 = limit;
+    constexpr auto margin2 = margin1 + limit;
+
+    scale<margin2 - margin1>(z + margin1, 5.0 / 100.0);
+    scale<D - margin2>(z + margin2, 5.12 / 100.0);
+    return bent_cigar<margin1>(z) + hgbat<margin2 - margin1>(z + margin1) +
+           rastrigin<D - margin2>(z + margin2);
+}
+
+template <std::size_t D> double hf02Parts(double* z)
+{
+    // [0.1, 0.2, 0.2, 0.2, 0.1, 0.2]
+    constexpr auto limit1 = ceilPart(0.1, D);
+    constexpr auto limit2 = ceilPart(0.2, D);
+    constexpr auto margin1 = limit1;
+    constexpr auto margin2 = margin1 + limit2;
+    constexpr auto margin3 = margin2 + limit2;
+    constexpr auto margin4 = margin3 + limit2;
+    constexpr auto margin5 = margin4 + limit1;
+
+    // the last part should be [margin5, D), the runtime version uses as many
+    // of the first values, before scaling
+    std::array<double, D - margin5> copy;
+    std::copy_n(z, copy.size(), copy.begin());
+    scale<margin1>(z, 5.0 / 100.0);
+    scale<margin2 - margin1>(z + margin1, 5.0 / 100.0);
+    scale<margin4 - margin3>(z + margin3, 5.12 / 100.0);
+    scale<margin5 - margin4>(z + margin4, 1000.0 / 100.0);
+    return hgbat<margin1>(z) + katsuura<margin2 - margin1>(z + margin1) +
+           ackley<margin3 - margin2>(z + margin2) +
+           rastrigin<margin4 - margin3>(z + margin3) +
+           schwefel<margin5 - margin4>(z + margin4) +
+           schaffer_F7<D - margin5>(copy.data());
+}
+
+template <std::size_t D> double hf03Parts(double* z)
+{
+    //  [0.3, 0.2, 0.2, 0.1, 0.2]
+    constexpr auto margin1 = ceilPart(0.3, D);
+    constexpr auto margin2 = margin1 + ceilPart(0.2, D);
+    constexpr auto margin3 = margin2 + ceilPart(0.2, D);
+    constexpr auto margin4 = margin3 + ceilPart(0.1, D);
+
+    scale<margin1>(z, 5.0 / 100.0);
+    scale<margin2 - margin1>(z + margin1, 5.0 / 100.0);
+    scale<margin3 - margin2>(z + margin2, 5.0 / 100.0);
+    scale<margin4 - margin3>(z + margin3, 1000.0 / 100.0);
+    return katsuura<margin1>(z) + happycat<margin2 - margin1>(z + margin1) +
+           grie_rosen<margin3 - margin2>(z + margin2) +
+           schwefel<margin4 - margin3>(z + margin3) +
+           ackley<D - margin4>(z + margin4);
+}
+
+// Shift rates of the components, then the value of the transformed
+// components. Same lambdas and biases as the runtime versions.
+
+constexpr std::array<double, 5> cf01Rates{2.048 / 100.0, 1.0, 1.0, 1.0, 1.0};
+
+template <std::size_t D> double cf01Value(Composition<D, 5>& z)
+{
+    const std::array<double, 5> fit{
+        rosenbrock<D>(z[0]),
+        ellips<D>(z[1]) * 1e-6 + 200,
+        bent_cigar<D>(z[2]) * 1e-26 + 300,
+        discus<D>(z[3]) * 1e-6 + 100,
+        ellips<D>(z[4]) * 1e-6 + 400,
+    };
+    const std::array<int, 5> delta{10, 20, 30, 40, 50};
+    return compositionFunctionCalculator<D, 5>(z.norms, delta, fit);
+}
+
+constexpr std::array<double, 3> cf02Rates{1000.0 / 100.0, 5.12 / 100.0,
+                                          5.0 / 100.0};
+
+template <std::size_t D> double cf02Value(Composition<D, 3>& z)
+{
+    const std::array<double, 3> fit{
+        schwefel<D>(z[0]),
+        rastrigin<D>(z[1]) + 200,
+        hgbat<D>(z[2]) + 100,
+    };
+    const std::array<int, 3> delta{20, 10, 10};
+    return compositionFunctionCalculator<D, 3>(z.norms, delta, fit);
+}
+
+constexpr std::array<double, 5> cf03Rates{1.0, 1000.0 / 100.0, 600.0 / 100.0,
+                                          2.048 / 100.0, 5.12 / 100.0};
+
+template <std::size_t D> double cf03Value(Composition<D, 5>& z)
+{
+    const std::array<double, 5> fit{
+        escaffer6<D>(z[0]) * (10000.0 / 2e+7),
+        schwefel<D>(z[1]) * 1.0 + 200,
+        griewank<D>(z[2]) * (1000 / 100) + 300,
+        rosenbrock<D>(z[3]) * 1 + 400,
+        rastrigin<D>(z[4]) * (10000 / 1e+3) + 200,
+    };
+    const std::array<int, 5> delta{20, 20, 30, 30, 20};
+    return compositionFunctionCalculator<D, 5>(z.norms, delta, fit);
+}
+
+constexpr std::array<double, 6> cf04Rates{5.0 / 100.0, 5.12 / 100.0,
+                                          1000.0 / 100.0, 1.0, 1.0, 1.0};
+
+template <std::size_t D> double cf04Value(Composition<D, 6>& z)
+{
+    const std::array<double, 6> fit{
+        hgbat<D>(z[0]) * 10,
+        rastrigin<D>(z[1]) * 10 + 300,
+        schwefel<D>(z[2]) * 2.5 + 500,
+        bent_cigar<D>(z[3]) * 1e-26 + 100,
+        ellips<D>(z[4]) * 1e-6 + 400,
+        escaffer6<D>(z[5]) * 5e-4 + 200,
+    };
+    const std::array<int, 6> delta{10, 20, 30, 40, 50, 60};
+    return compositionFunctionCalculator<D, 6>(z.norms, delta, fit);
+}
+
+} // namespace
+
+template <std::size_t D>
+double zakharov_func(const std::vector<double>& x, std::vector<double>& aux,
+                     const std::vector<double>& shift, const Matrix& rotate,
+                     bool shiftFlag, bool rotateFlag)
+{
+    componentTransform<D>(x, aux, shift, rotate, 0, 1.0, shiftFlag,
+                          rotateFlag);
+    return zakharov<D>(aux.data());
+}
+
+template <std::size_t D>
+double rosenbrock_func(const std::vector<double>& x, std::vector<double>& aux,
+                       const std::vector<double>& shift, const Matrix& rotate,
+                       bool shiftFlag, bool rotateFlag)
+{
+    componentTransform<D>(x, aux, shift, rotate, 0, 2.048 / 100.0, shiftFlag,
+                          rotateFlag);
+    return rosenbrock<D>(aux.data());
+}
+
+template <std::size_t D>
+double schaffer_F7_func(const std::vector<double>& x, std::vector<double>& aux,
+                        const std::vector<double>& shift, const Matrix& rotate,
+                        bool shiftFlag, [[maybe_unused]] bool rotateFlag)
+{
+    // not rotated, same as the runtime version
+    componentTransform<D>(x, aux, shift, rotate, 0, 1.0, shiftFlag, false);
+    return schaffer_F7<D>(aux.data());
+}
+
+template <std::size_t D>
+double rastrigin_func(const std::vector<double>& x, std::vector<double>& aux,
+                      const std::vector<double>& shift, const Matrix& rotate,
+                      bool shiftFlag, bool rotateFlag)
+{
+    componentTransform<D>(x, aux, shift, rotate, 0, 5.12 / 100.0, shiftFlag,
+                          rotateFlag);
+    return rastrigin<D>(aux.data());
+}
+
+template <std::size_t D>
+double levy_func(const std::vector<double>& x, std::vector<double>& aux,
+                 const std::vector<double>& shift, const Matrix& rotate,
+                 bool shiftFlag, bool rotateFlag)
+{
+    componentTransform<D>(x, aux, shift, rotate, 0, 1.0, shiftFlag,
+                          rotateFlag);
+    return levy<D>(aux.data());
+}
+
+template <std::size_t D>
+double hf01(const std::vector<double>& x, std::vector<double>& aux,
+            const std::vector<double>& shift, const Matrix& rotate,
+            const std::vector<std::size_t>& indices, bool shiftFlag,
+            bool rotateFlag)
+{
+    hybridTransform<D>(x, aux, shift, rotate, indices, shiftFlag, rotateFlag);
+    return hf01Parts<D>(aux.data());
+}
+
+template <std::size_t D>
+double hf02(const std::vector<double>& x, std::vector<double>& aux,
+            const std::vector<double>& shift, const Matrix& rotate,
+            const std::vector<std::size_t>& indices, bool shiftFlag,
+            bool rotateFlag)
+{
+    hybridTransform<D>(x, aux, shift, rotate, indices, shiftFlag, rotateFlag);
+    return hf02Parts<D>(aux.data());
+}
+
+template <std::size_t D>
+double hf03(const std::vector<double>& x, std::vector<double>& aux,
+            const std::vector<double>& shift, const Matrix& rotate,
+            const std::vector<std::size_t>& indices, bool shiftFlag,
+            bool rotateFlag)
+{
+    hybridTransform<D>(x, aux, shift, rotate, indices, shiftFlag, rotateFlag);
+    return hf03Parts<D>(aux.data());
+}
+
+template <std::size_t D>
+double cf01(const std::vector<double>& x,
+            [[maybe_unused]] std::vector<double>& aux,
+            const std::vector<double>& shift, const Matrix& rotate,
+            bool rotateFlag)
+{
+    auto z = Composition<D, 5>{
+        x, shift, rotate, cf01Rates,
+        {rotateFlag, rotateFlag, rotateFlag, rotateFlag, false}};
+    return cf01Value(z);
+}
+
+template <std::size_t D>
+double cf02(const std::vector<double>& x,
+            [[maybe_unused]] std::vector<double>& aux,
+            const std::vector<double>& shift, const Matrix& rotate,
+            bool rotateFlag)
+{
+    auto z = Composition<D, 3>{x, shift, rotate, cf02Rates,
+                               {false, rotateFlag, rotateFlag}};
+    return cf02Value(z);
+}
+
+template <std::size_t D>
+double cf03(const std::vector<double>& x,
+            [[maybe_unused]] std::vector<double>& aux,
+            const std::vector<double>& shift, const Matrix& rotate,
+            bool rotateFlag)
+{
+    auto z = Composition<D, 5>{
+        x, shift, rotate, cf03Rates,
+        {rotateFlag, rotateFlag, rotateFlag, rotateFlag, rotateFlag}};
+    return cf03Value(z);
+}
+
+template <std::size_t D>
+double cf04(const std::vector<double>& x,
+            [[maybe_unused]] std::vector<double>& aux,
+            const std::vector<double>& shift, const Matrix& rotate,
+            bool rotateFlag)
+{
+    auto z = Composition<D, 6>{x,
+                               shift,
+                               rotate,
+                               cf04Rates,
+                               {rotateFlag, rotateFlag, rotateFlag, rotateFlag,
+                                rotateFlag, rotateFlag}};
+    return cf04Value(z);
+}
+
+template <std::size_t D>
+double transformed(DeltaEvaluator::Function function, const double* images,
+                   const std::vector<double>& x,
+                   const std::vector<double>& shift,
+                   const std::vector<std::size_t>& indices)
+{
+    using Function = DeltaEvaluator::Function;
+    std::array<double, D> z;
+    const auto scaled = [&](double rate) {
+        for (std::size_t i = 0; i < D; ++i) {
+            z[i] = images[i] * rate;
+        }
+        return z.data();
+    };
+    const auto permuted = [&] {
+        for (std::size_t i = 0; i < D; ++i) {
+            z[i] = images[indices[i]];
+        }
+        return z.data();
+    };
+
+    switch (function) {
+    case Function::zakharov:
+        return zakharov<D>(images);
+    case Function::rosenbrock:
+        return rosenbrock<D>(scaled(2.048 / 100.0));
+    case Function::schaffer_F7:
+        return schaffer_F7<D>(images);
+    case Function::rastrigin:
+        return rastrigin<D>(scaled(5.12 / 100.0));
+    case Function::levy:
+        return levy<D>(images);
+    case Function::hf01:
+        return hf01Parts<D>(permuted());
+    case Function::hf02:
+        return hf02Parts<D>(permuted());
+    case Function::hf03:
+        return hf03Parts<D>(permuted());
+    case Function::cf01: {
+        auto composition = Composition<D, 5>{images, x, shift, cf01Rates};
+        return cf01Value(composition);
+    }
+    case Function::cf02: {
+        auto composition = Composition<D, 3>{images, x, shift, cf02Rates};
+        return cf02Value(composition);
+    }
+    case Function::cf03: {
+        auto composition = Composition<D, 5>{images, x, shift, cf03Rates};
+        return cf03Value(composition);
+    }
+    case Function::cf04: {
+        auto composition = Composition<D, 6>{images, x, shift, cf04Rates};
+        return cf04Value(composition);
+    }
+    }
+    return 0.0;
+}
+
+// The sizes accepted by the function managers when shifting or rotating
+template double zakharov_func<10>(const std::vector<double>&,
+                                  std::vector<double>&,
+                                  const std::vector<double>&, const Matrix&,
+                                  bool, bool);
+template double zakharov_func<20>(const std::vector<double>&,
+                                  std::vector<double>&,
+                                  const std::vector<double>&, const Matrix&,
+                                  bool, bool);
+template double rosenbrock_func<10>(const std::vector<double>&,
+                                    std::vector<double>&,
+                                    const std::vector<double>&, const Matrix&,
+                                    bool, bool);
+template double rosenbrock_func<20>(const std::vector<double>&,
+                                    std::vector<double>&,
+                                    const std::vector<double>&, const Matrix&,
+                                    bool, bool);
+template double schaffer_F7_func<10>(const std::vector<double>&,
+                                     std::vector<double>&,
+                                     const std::vector<double>&, const Matrix&,
+                                     bool, bool);
+template double schaffer_F7_func<20>(const std::vector<double>&,
+                                     std::vector<double>&,
+                                     const std::vector<double>&, const Matrix&,
+                                     bool, bool);
+template double rastrigin_func<10>(const std::vector<double>&,
+                                   std::vector<double>&,
+                                   const std::vector<double>&, const Matrix&,
+                                   bool, bool);
+template double rastrigin_func<20>(const std::vector<double>&,
+                                   std::vector<double>&,
+                                   const std::vector<double>&, const Matrix&,
+                                   bool, bool);
+template double levy_func<10>(const std::vector<double>&, std::vector<double>&,
+                              const std::vector<double>&, const Matrix&, bool,
+                              bool);
+template double levy_func<20>(const std::vector<double>&, std::vector<double>&,
+                              const std::vector<double>&, const Matrix&, bool,
+                              bool);
+template double hf01<10>(const std::vector<double>&, std::vector<double>&,
+                         const std::vector<double>&, const Matrix&,
+                         const std::vector<std::size_t>&, bool, bool);
+template double hf01<20>(const std::vector<double>&, std::vector<double>&,
+                         const std::vector<double>&, const Matrix&,
+                         const std::vector<std::size_t>&, bool, bool);
+template double hf02<10>(const std::vector<double>&, std::vector<double>&,
+                         const std::vector<double>&, const Matrix&,
+                         const std::vector<std::size_t>&, bool, bool);
+template double hf02<20>(const std::vector<double>&, std::vector<double>&,
+                         const std::vector<double>&, const Matrix&,
+                         const std::vector<std::size_t>&, bool, bool);
+template double hf03<10>(const std::vector<double>&, std::vector<double>&,
+                         const std::vector<double>&, const Matrix&,
+                         const std::vector<std::size_t>&, bool, bool);
+template double hf03<20>(const std::vector<double>&, std::vector<double>&,
+                         const std::vector<double>&, const Matrix&,
+                         const std::vector<std::size_t>&, bool, bool);
+template double cf01<10>(const std::vector<double>&, std::vector<double>&,
+                         const std::vector<double>&, const Matrix&, bool);
+template double cf01<20>(const std::vector<double>&, std::vector<double>&,
+                         const std::vector<double>&, const Matrix&, bool);
+template double cf02<10>(const std::vector<double>&, std::vector<double>&,
+                         const std::vector<double>&, const Matrix&, bool);
+template double cf02<20>(const std::vector<double>&, std::vector<double>&,
+                         const std::vector<double>&, const Matrix&, bool);
+template double cf03<10>(const std::vector<double>&, std::vector<double>&,
+                         const std::vector<double>&, const Matrix&, bool);
+template double cf03<20>(const std::vector<double>&, std::vector<double>&,
+                         const std::vector<double>&, const Matrix&, bool);
+template double cf04<10>(const std::vector<double>&, std::vector<double>&,
+                         const std::vector<double>&, const Matrix&, bool);
+template double cf04<20>(const std::vector<double>&, std::vector<double>&,
+                         const std::vector<double>&, const Matrix&, bool);
+template double transformed<10>(DeltaEvaluator::Function, const double*,
+                                const std::vector<double>&,
+                                const std::vector<double>&,
+                                const std::vector<std::size_t>&);
+template double transformed<20>(DeltaEvaluator::Function, const double*,
+                                const std::vector<double>&,
+                                const std::vector<double>&,
+                                const std::vector<std::size_t>&);
+
+namespace {
+
+template <std::size_t D> int check()
+{
+    constexpr std::size_t count = 7;
+
+    std::mt19937_64 gen{42};
+    std::uniform_real_distribution<double> random{-100.0, 100.0};
+
+    auto shift = std::vector<double>(6 * D);
+    std::generate(shift.begin(), shift.end(), [&]() { return random(gen); });
+    auto rotate = Matrix{6 * D, D};
+    for (std::size_t i = 0; i < rotate.rows(); ++i) {
+        std::generate_n(rotate.row(i), D,
+                        [&]() { return random(gen) / 100.0; });
+    }
+    auto indices = std::vector<std::size_t>(D);
+    std::iota(indices.begin(), indices.end(), 0);
+    std::shuffle(indices.begin(), indices.end(), gen);
+
+    auto x = std::vector<double>(D);
+    auto aux = std::vector<double>(D);
+
+    auto ok = 1;
+    const auto compare = [&](const char* name, auto&& runtime, auto&& fixed) {
+        auto maxError = 0.0;
+        for (std::size_t p = 0; p < count; ++p) {
+            std::generate(x.begin(), x.end(), [&]() { return random(gen); });
+            const auto expected = runtime();
+            const auto error = std::fabs(expected - fixed()) /
+                               std::max(1.0, std::fabs(expected));
+            maxError = std::max(maxError, error);
+        }
+        std::cout << name << " D" << D << " max relative error = " << maxError
+                  << '\n';
+        if (maxError > 1e-12) {
+            ok = 0;
+        }
+    };
+
+    const auto checkBasic = [&](const char* name, auto runtime, auto fixed) {
+        for (const auto flag : {false, true}) {
+            compare(
+                name, [&] { return runtime(x, aux, shift, rotate, flag, flag); },
+                [&] { return fixed(x, aux, shift, rotate, flag, flag); });
+        }
+    };
+    const auto checkHybrid = [&](const char* name, auto runtime, auto fixed) {
+        compare(
+            name,
+            [&] { return runtime(x, aux, shift, rotate, indices, true, true); },
+            [&] { return fixed(x, aux, shift, rotate, indices, true, true); });
+    };
+    const auto checkComposition = [&](const char* name, auto runtime,
+                                      auto fixed) {
+        compare(
+            name, [&] { return runtime(x, aux, shift, rotate, true); },
+            [&] { return fixed(x, aux, shift, rotate, true); });
+    };
+
+    checkBasic("zakharov_func", cec22::zakharov_func, zakharov_func<D>);
+    checkBasic("rosenbrock_func", cec22::rosenbrock_func, rosenbrock_func<D>);
+    checkBasic("schaffer_F7_func", cec22::schaffer_F7_func,
+               schaffer_F7_func<D>);
+    checkBasic("rastrigin_func", cec22::rastrigin_func, rastrigin_func<D>);
+    checkBasic("levy_func", cec22::levy_func, levy_func<D>);
+    checkHybrid("hf01", cec22::hf01, hf01<D>);
+    checkHybrid("hf02", cec22::hf02, hf02<D>);
+    checkHybrid("hf03", cec22::hf03, hf03<D>);
+    checkComposition("cf01", cec22::cf01, cf01<D>);
+    checkComposition("cf02", cec22::cf02, cf02<D>);
+    checkComposition("cf03", cec22::cf03, cf03<D>);
+    checkComposition("cf04", cec22::cf04, cf04<D>);
+    return ok;
+}
+
+} // namespace
+
+int sanity_check()
+{
+    const auto ok10 = check<10>();
+    const auto ok20 = check<20>();
+    return ok10 and ok20;
+}
+
+} // namespace cec22::fixed
@@ -0,0 +1,82 @@
+#pragma once
+#include "Matrix.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cec22 {
+
+/// The text files of an input_data directory, converted once into one binary
+/// file (cec22.bin) that is memory mapped instead of parsed. Each text file is
+/// an entry named after it, without ".txt":
+///  * M_* rotation matrices, stored with the row stride of Matrix so they can
+///    be used in place
+///  * shift_data_* lines of doubles, in file order
+///  * shuffle_data_* permutations, validated and stored 0 based
+///
+/// Layout, in host byte order: a 64 byte header (magic "CEC22BIN", version,
+/// entry count, file size, FNV-1a checksum of everything after the header),
+/// 64 byte entries, then the 64 byte aligned payloads. The checksum is
+/// verified once, when the bundle is opened.
+class DataBundle
+{
+  public:
+    static constexpr std::uint32_t version = 1;
+    static constexpr const char* fileName = "cec22.bin";
+
+    /// Entries of a bundle being written, by name
+    struct Contents {
+        std::map<std::string, Matrix> matrices;
+        std::map<std::string, std::vector<std::vector<double>>> lines;
+        std::map<std::string, std::vector<std::uint64_t>> permutations;
+    };
+
+    /// The bundle file of directory, opened and checked once per process and
+    /// kept mapped until exit. nullptr when there is no valid bundle, the
+    /// callers then read the text files.
+    static const DataBundle* find(const std::string& directory,
+                                  std::string_view file = fileName);
+
+    /// Converts the text files of directory into directory/cec22.bin
+    static void write(const std::string& directory);
+    /// Writes contents as the bundle file, replacing it at once
+    static void write(const std::string& file, const Contents& contents);
+
+    /// Values of every line of a shift_data file, nullopt if missing
+    std::optional<std::vector<std::span<const double>>>
+    lines(std::string_view name) const;
+    /// The first rows rows and columns columns of a rotation file. Viewing the
+    /// mapped data when the stored columns match, copied otherwise. nullopt if
+    /// missing, throws if the stored matrix is smaller.
+    std::optional<Matrix>
+    matrix(std::string_view name, std::size_t rows, std::size_t columns) const;
+    /// 0 based permutation of a shuffle_data file, nullopt if missing
+    std::optional<std::span<const std::uint64_t>>
+    permutation(std::string_view name) const;
+
+    DataBundle(const DataBundle&) = delete;
+    DataBundle& operator=(const DataBundle&) = delete;
+    ~DataBundle();
+
+  private:
+    struct Entry;
+
+    DataBundle() = default;
+    /// nullptr, after printing why, when file is not a valid bundle
+    static std::unique_ptr<DataBundle> open(const std::string& file);
+    const Entry* entry(std::string_view name, std::uint32_t kind) const;
+
+    const std::byte* data = nullptr;
+    std::size_t size = 0;
+    bool mapped = false;
+    /// Holds the file where mmap is not available
+    std::vector<double, AlignedAllocator<double, Matrix::alignment>> buffer;
+};
+
+} // namespace cec22
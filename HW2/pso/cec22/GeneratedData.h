@@ -0,0 +1,31 @@
+#pragma once
+#include "DataBundle.h"
+#include "Matrix.h"
+
+#include <cstddef>
+#include <random>
+#include <string>
+
+namespace cec22 {
+
+/// Data of function index for dimensions without shipped data, e.g. for
+/// scaling studies. Generated from a seed fixed per function and size, and
+/// cached next to the shipped data as a DataBundle named by generatedFile,
+/// with the entries of the shipped files:
+///  * M_<index>_D<dimensions>, one random rotation per component, stacked
+///  * shift_data_<index>, one line of dimensions values in [-80, 80] per
+///    component
+///  * shuffle_data_<index>_D<dimensions>, hybrid functions only
+/// The standard library distributions differ between implementations, so
+/// another compiler may generate other data; the cached file keeps it fixed.
+/// Safe to call from several threads.
+const DataBundle*
+generatedData(const std::string& directory, int index, std::size_t dimensions);
+
+std::string generatedFile(int index, std::size_t dimensions);
+
+/// Orthogonal matrix, uniformly distributed: Q of the QR decomposition of a
+/// matrix of standard normal values, its columns signed like the diagonal of R
+Matrix randomRotation(std::size_t dimensions, std::mt19937_64& gen);
+
+} // namespace cec22
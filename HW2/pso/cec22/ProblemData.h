@@ -0,0 +1,45 @@
+#pragma once
+#include "Matrix.h"
+
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cec22 {
+
+/// Shift, rotation and shuffle data of one function. Read only once loaded,
+/// shared by every function manager and thread using it.
+struct ProblemData {
+    std::vector<double> shift;
+    Matrix rotate;
+    /// hybrid functions only
+    std::vector<std::size_t> indices;
+    /// rotate rounded to float, rows stride() apart like rotate, for the mixed
+    /// precision batches. Filled by problemData, loaders leave it empty.
+    std::vector<float> singleRotate = {};
+};
+
+/// Which data a function needs. The directory is part of the key because the
+/// input directory comes from the environment and can change.
+struct ProblemKey {
+    std::string directory;
+    int index;
+    int dimensions;
+    bool shiftFlag;
+    bool rotateFlag;
+
+    auto operator<=>(const ProblemKey&) const = default;
+};
+
+/// The data of key, loaded by load the first time it is asked for and kept
+/// until exit. Safe to call from several threads, load runs once per key and
+/// different keys load at the same time. Callers of a key that is loading wait
+/// for it; when load throws they get the exception, nothing is kept and the
+/// next call loads again.
+std::shared_ptr<const ProblemData>
+problemData(const ProblemKey& key, const std::function<ProblemData()>& load);
+
+} // namespace cec22
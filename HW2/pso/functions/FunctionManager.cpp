@@ -1,15 +1,22 @@
 #include "FunctionManager.h"
 
 #include "../cec22/Cec22.h"
+#include "../cec22/DataBundle.h"
+#include "../cec22/Evaluator.h"
+#include "../cec22/GeneratedData.h"
+#include "../cec22/ProblemData.h"
 #include "../utils/Constants.h"
 #include "../utils/Utils.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <ranges>
 #include <set>
 #include <stdexcept>
+#include <tuple>
+#include <unordered_map>
 
 namespace function_layer {
 
@@ -26,25 +33,42 @@ std::string getInputDir()
     // TODO: implement recursive search
 }
 
-std::vector<double> readCompositeShift(std::size_t dimensions, std::size_t rows,
-                                       int index, bool shiftFlag)
+/// The bundle holding the data of function index: the converted shipped data
+/// for 10 and 20 dimensions, generated data for the others
+const cec22::DataBundle* findBundle(int index, std::size_t dimensions)
 {
-    if (not shiftFlag) {
-        return {};
+    if (dimensions == 10 or dimensions == 20) {
+        return cec22::DataBundle::find(getInputDir());
     }
+    return cec22::generatedData(getInputDir(), index, dimensions);
+}
 
-    const auto file =
-        getInputDir() + "shift_data_" + std::to_string(index) + ".txt";
-    if (not fs::exists(file)) {
-        throw std::runtime_error{"File " + file + " does not exist"};
+std::vector<double>
+readCompositeShift(const cec22::DataBundle* bundle, std::size_t dimensions,
+                   std::size_t rows, int index, bool shiftFlag)
+{
+    if (not shiftFlag) {
+        return {};
     }
 
-    std::ifstream in{file};
+    const auto name = "shift_data_" + std::to_string(index);
     std::vector<std::vector<double>> shift;
-    for (std::string str; std::getline(in, str);) {
-        std::istringstream ss{str};
-        shift.push_back({std::istream_iterator<double>{ss},
-                         std::istream_iterator<double>{}});
+    if (const auto lines = bundle ? bundle->lines(name) : std::nullopt) {
+        for (const auto line : *lines) {
+            shift.emplace_back(line.begin(), line.end());
+        }
+    } else {
+        const auto file = getInputDir() + name + ".txt";
+        if (not fs::exists(file)) {
+            throw std::runtime_error{"File " + file + " does not exist"};
+        }
+
+        std::ifstream in{file};
+        for (std::string str; std::getline(in, str);) {
+            std::istringstream ss{str};
+            shift.push_back({std::istream_iterator<double>{ss},
+                             std::istream_iterator<double>{}});
+        }
     }
 
     if (shift.size() < rows) {
@@ -68,22 +92,31 @@ std::vector<double> readCompositeShift(std::size_t dimensions, std::size_t rows,
     return ret;
 }
 
-std::vector<double> readShift(std::size_t dimensions, int index, bool shiftFlag)
+std::vector<double> readShift(const cec22::DataBundle* bundle,
+                              std::size_t dimensions, int index, bool shiftFlag)
 {
     if (not shiftFlag) {
         return {};
     }
 
     // std format is not available yet
-    const auto file =
-        getInputDir() + "shift_data_" + std::to_string(index) + ".txt";
-    if (not fs::exists(file)) {
-        throw std::runtime_error{"File " + file + " does not exist"};
-    }
+    const auto name = "shift_data_" + std::to_string(index);
+    std::vector<double> x;
+    if (const auto lines = bundle ? bundle->lines(name) : std::nullopt) {
+        // all values, in file order
+        for (const auto line : *lines) {
+            x.insert(x.end(), line.begin(), line.end());
+        }
+    } else {
+        const auto file = getInputDir() + name + ".txt";
+        if (not fs::exists(file)) {
+            throw std::runtime_error{"File " + file + " does not exist"};
+        }
 
-    std::ifstream in{file};
-    std::vector<double> x(std::istream_iterator<double>{in},
-                          std::istream_iterator<double>{});
+        std::ifstream in{file};
+        x.assign(std::istream_iterator<double>{in},
+                 std::istream_iterator<double>{});
+    }
 
     if (x.size() < dimensions) {
         std::cerr << "Read " << x.size() << " doubles, expected " << dimensions
@@ -94,48 +127,59 @@ std::vector<double> readShift(std::size_t dimensions, int index, bool shiftFlag)
     return x;
 }
 
-std::vector<std::vector<double>>
-readRotate(std::size_t rows, std::size_t columns, int index, bool rotateFlag)
+cec22::Matrix readRotate(const cec22::DataBundle* bundle, std::size_t rows,
+                         std::size_t columns, int index, bool rotateFlag)
 {
     if (not rotateFlag) {
-        return {{}};
+        return {};
     }
 
-    const auto file = getInputDir() + "M_" + std::to_string(index) + "_D" +
-                      std::to_string(columns) + ".txt";
+    const auto name =
+        "M_" + std::to_string(index) + "_D" + std::to_string(columns);
+    if (auto rotate = bundle ? bundle->matrix(name, rows, columns)
+                             : std::nullopt) {
+        return std::move(*rotate);
+    }
+
+    const auto file = getInputDir() + name + ".txt";
     if (not fs::exists(file)) {
         throw std::runtime_error{"File " + file + " does not exist"};
     }
 
     std::ifstream in{file};
-    std::vector<std::vector<double>> rotate;
-    for (std::string str; std::getline(in, str);) {
+    auto rotate = cec22::Matrix{rows, columns};
+    std::size_t i = 0;
+    for (std::string str; i < rows and std::getline(in, str); ++i) {
         std::istringstream ss{str};
-        rotate.push_back({std::istream_iterator<double>{ss},
-                          std::istream_iterator<double>{}});
-    }
-
-    if (rotate.size() < rows) {
-        std::cerr << "Rotate has " << rotate.size() << " rows, expected "
-                  << rows << "\n";
-        throw std::runtime_error{"Read error"};
-    }
-    rotate.resize(rows);
-    for (auto& row : rotate) {
+        const std::vector<double> row{std::istream_iterator<double>{ss},
+                                      std::istream_iterator<double>{}};
         if (row.size() < columns) {
             std::cerr << "Row has " << row.size() << " columns, expected "
                       << columns << "\n";
             throw std::runtime_error{"Read error"};
         }
-        row.resize(columns);
+        std::copy_n(row.begin(), columns, rotate.row(i));
+    }
+
+    if (i < rows) {
+        std::cerr << "Rotate has " << i << " rows, expected " << rows << "\n";
+        throw std::runtime_error{"Read error"};
     }
     return rotate;
 }
 
-std::vector<std::size_t> readShuffle(std::size_t dimensions, int index)
+std::vector<std::size_t>
+readShuffle(const cec22::DataBundle* bundle, std::size_t dimensions, int index)
 {
-    const auto file = getInputDir() + "shuffle_data_" + std::to_string(index) +
-                      "_D" + std::to_string(dimensions) + ".txt";
+    const auto name = "shuffle_data_" + std::to_string(index) + "_D" +
+                      std::to_string(dimensions);
+    if (const auto permutation =
+            bundle ? bundle->permutation(name) : std::nullopt) {
+        // validated by the converter
+        return {permutation->begin(), permutation->end()};
+    }
+
+    const auto file = getInputDir() + name + ".txt";
     if (not fs::exists(file)) {
         throw std::runtime_error{"File " + file + " does not exist"};
     }
@@ -168,88 +212,120 @@ std::vector<std::size_t> readShuffle(std::size_t dimensions, int index)
     return x;
 }
 
-std::function<double(const std::vector<double>&, std::vector<double>&)>
-initFunction(const std::string& functionName, int dimensions, bool shiftFlag,
-             bool rotateFlag)
+cec22::Evaluator initFunction(const std::string& functionName,
+                              int dimensions, bool shiftFlag, bool rotateFlag)
 {
     using namespace std::string_literals;
     using namespace cec22;
-    const std::unordered_map<
-        std::string,
-        std::tuple<int,
-                   std::function<double(
-                       const std::vector<double>&, std::vector<double>&,
-                       const std::vector<double>&,
-                       const std::vector<std::vector<double>>&, bool, bool)>,
-                   double>>
+    const std::unordered_map<std::string,
+                             std::tuple<int, double, EvaluatorFactory>>
         basicFunctions = {
-            {"zakharov_func"s, {1, zakharov_func, 300.0}},
-            {"rosenbrock_func"s, {2, rosenbrock_func, 400.0}},
-            {"schaffer_F7_func"s, {3, schaffer_F7_func, 600.0}},
-            {"rastrigin_func"s, {4, rastrigin_func, 800.0}},
-            {"levy_func"s, {5, levy_func, 900.0}},
+            {"zakharov_func"s,
+             {1, 300.0,
+              bySize<BasicEvaluator, zakharov_func, fixed::zakharov_func<10>,
+                     fixed::zakharov_func<20>, batch::zakharov_func>}},
+            {"rosenbrock_func"s,
+             {2, 400.0,
+              bySize<BasicEvaluator, rosenbrock_func,
+                     fixed::rosenbrock_func<10>, fixed::rosenbrock_func<20>,
+                     batch::rosenbrock_func>}},
+            {"schaffer_F7_func"s,
+             {3, 600.0,
+              bySize<BasicEvaluator, schaffer_F7_func,
+                     fixed::schaffer_F7_func<10>, fixed::schaffer_F7_func<20>,
+                     batch::schaffer_F7_func>}},
+            {"rastrigin_func"s,
+             {4, 800.0,
+              bySize<BasicEvaluator, rastrigin_func, fixed::rastrigin_func<10>,
+                     fixed::rastrigin_func<20>, batch::rastrigin_func>}},
+            {"levy_func"s,
+             {5, 900.0,
+              bySize<BasicEvaluator, levy_func, fixed::levy_func<10>,
+                     fixed::levy_func<20>, batch::levy_func>}},
         };
-    const std::unordered_map<
-        std::string,
-        std::tuple<int,
-                   std::function<double(
-                       const std::vector<double>&, std::vector<double>&,
-                       const std::vector<double>&,
-                       const std::vector<std::vector<double>>&,
-                       const std::vector<std::size_t>&, bool, bool)>,
-                   double>>
+    const std::unordered_map<std::string,
+                             std::tuple<int, double, EvaluatorFactory>>
         hybridFunctions = {
-            {"hf01"s, {6, hf01, 1800.0}},
-            {"hf02"s, {7, hf02, 2000.0}},
-            {"hf03"s, {8, hf03, 2200.0}},
+            {"hf01"s,
+             {6, 1800.0,
+              bySize<HybridEvaluator, hf01, fixed::hf01<10>, fixed::hf01<20>,
+                     batch::hf01>}},
+            {"hf02"s,
+             {7, 2000.0,
+              bySize<HybridEvaluator, hf02, fixed::hf02<10>, fixed::hf02<20>,
+                     batch::hf02>}},
+            {"hf03"s,
+             {8, 2200.0,
+              bySize<HybridEvaluator, hf03, fixed::hf03<10>, fixed::hf03<20>,
+                     batch::hf03>}},
         };
-    const std::unordered_map<
-        std::string,
-        std::tuple<int,
-                   std::function<double(
-                       const std::vector<double>&, std::vector<double>&,
-                       const std::vector<double>&,
-                       const std::vector<std::vector<double>>&, bool)>,
-                   double, int>>
+    const std::unordered_map<std::string,
+                             std::tuple<int, double, int, EvaluatorFactory>>
         compositionFunctions = {
-            {"cf01"s, {9, cf01, 2300.0, 5}},
-            {"cf02"s, {10, cf02, 2400.0, 3}},
-            {"cf03"s, {11, cf03, 2600.0, 5}},
-            {"cf04"s, {12, cf04, 2700.0, 6}},
+            {"cf01"s,
+             {9, 2300.0, 5,
+              bySize<CompositionEvaluator, cf01, fixed::cf01<10>,
+                     fixed::cf01<20>, batch::cf01>}},
+            {"cf02"s,
+             {10, 2400.0, 3,
+              bySize<CompositionEvaluator, cf02, fixed::cf02<10>,
+                     fixed::cf02<20>, batch::cf02>}},
+            {"cf03"s,
+             {11, 2600.0, 5,
+              bySize<CompositionEvaluator, cf03, fixed::cf03<10>,
+                     fixed::cf03<20>, batch::cf03>}},
+            {"cf04"s,
+             {12, 2700.0, 6,
+              bySize<CompositionEvaluator, cf04, fixed::cf04<10>,
+                     fixed::cf04<20>, batch::cf04>}},
         };
 
     if (basicFunctions.find(functionName) != basicFunctions.end()) {
-        const auto [index, f, fStar] = basicFunctions.at(functionName);
-        return [=, f = std::move(f),
-                shift = readShift(dimensions, index, shiftFlag),
-                rotate = readRotate(dimensions, dimensions, index, rotateFlag)](
-                   const std::vector<double>& x, std::vector<double>& aux) {
-            return f(x, aux, shift, rotate, shiftFlag, rotateFlag);
-            // + fStar;
-        };
+        const auto [index, fStar, make] = basicFunctions.at(functionName);
+        const auto data = problemData(
+            {getInputDir(), index, dimensions, shiftFlag, rotateFlag}, [&] {
+                const auto* bundle = shiftFlag or rotateFlag
+                                         ? findBundle(index, dimensions)
+                                         : nullptr;
+                return ProblemData{readShift(bundle, dimensions, index,
+                                             shiftFlag),
+                                   readRotate(bundle, dimensions, dimensions,
+                                              index, rotateFlag),
+                                   {}};
+            });
+        // + fStar is not added
+        return make(dimensions, data, shiftFlag, rotateFlag);
     }
 
     if (hybridFunctions.find(functionName) != hybridFunctions.end()) {
-        const auto [index, f, fStar] = hybridFunctions.at(functionName);
-        return [=, f = std::move(f),
-                shift = readShift(dimensions, index, shiftFlag),
-                rotate = readRotate(dimensions, dimensions, index, rotateFlag),
-                indices = readShuffle(dimensions, index)](
-                   const std::vector<double>& x, std::vector<double>& aux) {
-            return f(x, aux, shift, rotate, indices, shiftFlag, rotateFlag);
-            // + fStar;
-        };
+        const auto [index, fStar, make] = hybridFunctions.at(functionName);
+        const auto data = problemData(
+            {getInputDir(), index, dimensions, shiftFlag, rotateFlag}, [&] {
+                // the shuffle is always read
+                const auto* bundle = findBundle(index, dimensions);
+                return ProblemData{readShift(bundle, dimensions, index,
+                                             shiftFlag),
+                                   readRotate(bundle, dimensions, dimensions,
+                                              index, rotateFlag),
+                                   readShuffle(bundle, dimensions, index)};
+            });
+        return make(dimensions, data, shiftFlag, rotateFlag);
     }
 
     if (compositionFunctions.find(functionName) != compositionFunctions.end()) {
-        const auto [index, f, fStar, n] = compositionFunctions.at(functionName);
-        return [=, f = std::move(f),
-                shift = readCompositeShift(dimensions, n, index, true),
-                rotate = readRotate(dimensions * n, dimensions, index, true)](
-                   const std::vector<double>& x, std::vector<double>& aux) {
-            return f(x, aux, shift, rotate, true); // always rotate
-            // + fStar;
-        };
+        const auto [index, fStar, n, make] =
+            compositionFunctions.at(functionName);
+        // always shift and rotate
+        const auto data = problemData(
+            {getInputDir(), index, dimensions, true, true}, [&] {
+                const auto* bundle = findBundle(index, dimensions);
+                return ProblemData{
+                    readCompositeShift(bundle, dimensions, n, index, true),
+                    readRotate(bundle, dimensions * n, dimensions, index,
+                               true),
+                    {}};
+            });
+        return make(dimensions, data, true, true);
     }
 
     // No function found
@@ -274,6 +350,11 @@ constexpr auto decayFactor = 0.9;
 
 } // namespace
 
+void convertInputData()
+{
+    cec22::DataBundle::write(getInputDir());
+}
+
 FunctionManager::FunctionManager(
     std::string_view function, int dimensions,
     cache_layer::KDTreeCache::CacheRetrievalStrategy cacheRestrievalStrategy,
@@ -282,20 +363,17 @@ FunctionManager::FunctionManager(
     : functionName{function}
     , maxFes{dimensions == 10 ? 200'000 : 1'000'000}
     , epsilon{maxExpsilon}
-    , function{initFunction(functionName, dimensions, shiftFlag, rotateFlag)}
     , cache{maxFes, dimensions, cacheRestrievalStrategy}
 // clang-format on
 {
-    if ((rotateFlag or shiftFlag) and dimensions != 10 and dimensions != 20) {
-        throw std::runtime_error{
-            "Can't use rotate or shift for dimensions other than 10 or 20"};
-    }
+    this->function =
+        initFunction(functionName, dimensions, shiftFlag, rotateFlag);
 }
 
 double
 FunctionManager::cheat(const std::vector<double>& x, std::vector<double>& aux)
 {
-    return function(x, aux);
+    return std::visit([&](const auto& f) { return f(x, aux); }, function);
 }
 
 int FunctionManager::rebalance = 2;
@@ -318,6 +396,84 @@ double FunctionManager::operator()(const std::vector<double>& x,
     return callFunctionAndUpdateCache(x, aux);
 }
 
+void FunctionManager::evaluateBatch(
+    const std::vector<std::vector<double>>& points, std::vector<double>& values)
+{
+    misses.clear();
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        epsilon *= decayFactor;
+        // misses of this batch are not evaluated yet, but they are calls
+        const auto calls = functionCalls + static_cast<int>(misses.size());
+        if ((calls - 2) % (maxFes / rebalance) == 0) {
+            cache.recreate();
+        }
+
+        const auto value = cache.retrievalStrategy(points[i], epsilon);
+        if (value) {
+            ++cacheHits;
+            values[i] = *value;
+        } else {
+            misses.push_back(i);
+        }
+    }
+    if (misses.empty()) {
+        return;
+    }
+
+    // spending what is left of maxFes before throwing, same as operator()
+    const auto count = std::min<std::size_t>(
+        misses.size(), std::max(maxFes - functionCalls, 0));
+    if (count != 0) {
+        const auto timer =
+            utils::timer::Timer{"FunctionManager::evaluateBatch"};
+        const auto dimensions = points[misses[0]].size();
+        missPoints.resize(dimensions * count);
+        missValues.resize(count);
+        for (std::size_t p = 0; p < count; ++p) {
+            const auto& x = points[misses[p]];
+            for (std::size_t d = 0; d < dimensions; ++d) {
+                missPoints[d * count + p] = x[d];
+            }
+        }
+        // one dispatch for the whole batch
+        std::visit(
+            [&](const auto& f) {
+                f.batch(missPoints, missValues, buffers, precision);
+            },
+            function);
+        if (precision == cec22::Precision::Mixed and
+            *std::min_element(missValues.begin(), missValues.end()) <
+                singleThreshold) {
+            // values this close to the optimum are only reported, and
+            // cached, in double
+            precision = cec22::Precision::Double;
+            std::visit(
+                [&](const auto& f) {
+                    f.batch(missPoints, missValues, buffers);
+                },
+                function);
+        }
+        functionCalls += count;
+
+        for (std::size_t p = 0; p < count; ++p) {
+            values[misses[p]] = missValues[p];
+            // this makes copy
+            cache.insert(points[misses[p]], missValues[p]);
+        }
+    }
+
+    if (count < misses.size()) {
+        ++functionCalls;
+        throw std::out_of_range{"Function call out of range"};
+    }
+}
+
+void FunctionManager::useSinglePrecision(double threshold)
+{
+    precision = cec22::Precision::Mixed;
+    singleThreshold = threshold;
+}
+
 double FunctionManager::callFunctionAndUpdateCache(const std::vector<double>& x,
                                                    std::vector<double>& aux)
 {
@@ -337,7 +493,7 @@ double FunctionManager::callFunction(const std::vector<double>& x,
         throw std::out_of_range{"Function call out of range"};
     }
 
-    return function(x, aux);
+    return std::visit([&](const auto& f) { return f(x, aux); }, function);
 }
 
 } // namespace function_layer
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../cec22/Cec22.h"
+#include "../cec22/Evaluator.h"
 #include "../utils/Timer.h"
 #include "CacheLayer.h"
 
@@ -12,6 +14,10 @@
 
 namespace function_layer {
 
+/// Writes the binary bundle of the input data directory, read instead of the
+/// text files from then on
+void convertInputData();
+
 class FunctionManager
 {
   public:
@@ -24,6 +30,16 @@ class FunctionManager
 
     double operator()(const std::vector<double>& x, std::vector<double>& aux);
     double cheat(const std::vector<double>& x, std::vector<double>& aux);
+    /// Evaluates all points at once. Cache lookups are done first, then all
+    /// misses are evaluated with a single batched call, so points of the same
+    /// batch do not hit each other in the cache.
+    void evaluateBatch(const std::vector<std::vector<double>>& points,
+                       std::vector<double>& values);
+    /// Opt-in mixed precision for exploring: cache misses of a batch are
+    /// shifted and rotated in single precision until one has a value below
+    /// threshold. Those misses are evaluated again in double, and so is
+    /// everything after them. Single point calls are always double.
+    void useSinglePrecision(double threshold);
     int missCount() const
     {
         return functionCalls;
@@ -64,8 +80,16 @@ class FunctionManager
     int functionCalls = 0;
     int cacheHits = 0;
 
-    std::function<double(const std::vector<double>&, std::vector<double>&)>
-        function;
+    /// The concrete evaluator, dispatched by std::visit
+    cec22::Evaluator function;
+    cec22::Precision precision = cec22::Precision::Double;
+    double singleThreshold = 0.0;
+    cec22::batch::Buffers buffers;
+    // indices of the points not found in cache, and their structure-of-arrays
+    // block
+    std::vector<std::size_t> misses;
+    std::vector<double> missPoints;
+    std::vector<double> missValues;
     cache_layer::KDTreeCache cache;
 };
 
@@ -25,8 +25,12 @@ void timeTest();
 
 void fineTuning(int argc, char* argv[]);
 
-int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[])
+int main(int argc, char* argv[])
 {
+    if (argc > 1 and argv[1] == std::string_view{"convert"}) {
+        function_layer::convertInputData();
+        return 0;
+    }
     // std::cout << cec22::sanity_check() << '\n';
     // runDefault();
     // runTest();
@@ -1,5 +1,6 @@
 #include "Swarm.h"
 
+#include <algorithm>
 #include <execution>
 #include <iostream>
 #include <stdexcept>
@@ -48,6 +49,74 @@ std::string vecToString(const std::vector<double>& v)
 
 constexpr auto epsilon = 1e-6;
 
+/// Coefficients of the velocity update of one particle, each multiplied by its
+/// random factor
+struct VelocityTerms {
+    double inertia;
+    double cognition;
+    double social;
+    double attraction;
+};
+
+/// v = inertia v + cognition (past - x) + social (visible - x) + jitter +
+/// attraction (swarmsBest - x), clamped to the values range, then x += v,
+/// reflected into the domain. x starts in the domain and |v| is at most the
+/// values range, so one reflection is enough.
+[[gnu::always_inline]] inline void
+moveParticle(double* x, double* v, const double* past, const double* visible,
+             const double* jitter, const double* swarmsBest,
+             const VelocityTerms& terms, std::size_t n)
+{
+    for (std::size_t d = 0; d < n; ++d) {
+        auto velocity = terms.inertia * v[d] +
+                        terms.cognition * (past[d] - x[d]) +
+                        terms.social * (visible[d] - x[d]) + jitter[d] +
+                        terms.attraction * (swarmsBest[d] - x[d]);
+        velocity = std::clamp(velocity, -constants::valuesRange,
+                              constants::valuesRange);
+        v[d] = velocity;
+
+        // TODO: Add strategy (clipping to domain or reflection)
+        auto position = x[d] + velocity;
+        position = position < constants::minimum
+                       ? 2 * constants::minimum - position
+                       : position;
+        position = position > constants::maximum
+                       ? 2 * constants::maximum - position
+                       : position;
+        x[d] = position;
+    }
+}
+
+using Mover = void (*)(double*, double*, const double*, const double*,
+                       const double*, const double*, const VelocityTerms&,
+                       std::size_t);
+
+// Builds of moveParticle for each instruction set of cec22::simd, picked with
+// its active one
+// clang-format off
+void moveParticleSse2(double* x, double* v, const double* past, const double* visible, const double* jitter, const double* swarmsBest, const VelocityTerms& terms, std::size_t n) { moveParticle(x, v, past, visible, jitter, swarmsBest, terms, n); }
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+void moveParticleAvx2(double* x, double* v, const double* past, const double* visible, const double* jitter, const double* swarmsBest, const VelocityTerms& terms, std::size_t n) { moveParticle(x, v, past, visible, jitter, swarmsBest, terms, n); }
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512dq,avx2,fma")
+void moveParticleAvx512(double* x, double* v, const double* past, const double* visible, const double* jitter, const double* swarmsBest, const VelocityTerms& terms, std::size_t n) { moveParticle(x, v, past, visible, jitter, swarmsBest, terms, n); }
+#pragma GCC pop_options
+// clang-format on
+
+Mover mover()
+{
+    const auto isa = cec22::simd::active();
+    if (isa == cec22::simd::Isa::Avx512) {
+        return moveParticleAvx512;
+    }
+    return isa == cec22::simd::Isa::Avx2 ? moveParticleAvx2 : moveParticleSse2;
+}
+
 } // namespace
 
 // clang-format off
@@ -88,6 +157,10 @@ Swarm::Swarm(
         populationSize, std::vector<double>(dimensions));
     populationPastBests = std::vector<std::vector<double>>(
         populationSize, std::vector<double>(dimensions));
+    visibleBests = std::vector<std::vector<double>>(
+        populationSize, std::vector<double>(dimensions));
+    jitters = std::vector<std::vector<double>>(
+        populationSize, std::vector<double>(dimensions));
     topologyChromosomes = std::vector<std::vector<bool>>(
         populationSize, std::vector<bool>(dimensions));
     populationInertia = std::vector<double>(populationSize);
@@ -375,6 +448,7 @@ void Swarm::mutateParticles()
 
 void Swarm::updateVelocity(const std::vector<double>& swarmsBest)
 {
+    const auto move = mover();
     // par_unseq or unseq?
     std::for_each(
         std::execution::par_unseq, indices.begin(), indices.end(),
@@ -384,57 +458,33 @@ void Swarm::updateVelocity(const std::vector<double>& swarmsBest)
             const auto rInertia = randomDouble(gen);
             const auto rSwarm = randomDouble(gen);
 
+            // the topology and the jitter are picked per dimension, the
+            // arithmetic runs on whole vectors. The buffers are the
+            // particle's own: par_unseq may interleave particles on one
+            // thread, so a per thread buffer could be shared.
+            auto* visible = visibleBests[i].data();
+            auto* jitter = jitters[i].data();
             for (auto d = 0; d < dimensions; ++d) {
-                // TODO: this can be faster if we only do the else and apply the
-                // mutation outside when applying the mutation it is not
-                // necessary to iterate through all particles all dimensions, we
-                // can generate the positions that are going to be mutated
-                populationVelocity[i][d] =
-                    inertia * populationVelocity[i][d] +
-                    cognition * rCognition *
-                        (populationPastBests[i][d] - population[i][d]) +
-                    social * rSocial *
-                        (getVisibleBest(i, d) - population[i][d]) +
-                    getJitter() +
-                    swarmAttraction * rSwarm *
-                        (swarmsBest[d] - population[i][d]);
-
-                // TODO: Use modulo arithmetics
-                if (populationVelocity[i][d] > constants::valuesRange) {
-                    populationVelocity[i][d] = constants::valuesRange;
-                } else if (populationVelocity[i][d] < -constants::valuesRange) {
-                    populationVelocity[i][d] = -constants::valuesRange;
-                }
-
-                // TODO: Add strategy (clipping to domain or reflection)
-
-                // TODO: See if modulo arithmetic can be used in this case.
-                // How would this work: use an usigned to represent [minimum,
-                // maximum] and do operations for unsigneds then convert to
-                // double
-                population[i][d] += populationVelocity[i][d];
-                while (population[i][d] < constants::minimum or
-                       population[i][d] > constants::maximum) {
-                    if (population[i][d] < constants::minimum) {
-                        population[i][d] =
-                            2 * constants::minimum - population[i][d];
-                    }
-                    if (population[i][d] > constants::maximum) {
-                        population[i][d] =
-                            2 * constants::maximum - population[i][d];
-                    }
-                }
+                visible[d] = getVisibleBest(i, d);
+                jitter[d] = getJitter();
             }
+            // TODO: this can be faster if we only do the else and apply the
+            // mutation outside when applying the mutation it is not necessary
+            // to iterate through all particles all dimensions, we can generate
+            // the positions that are going to be mutated
+            move(population[i].data(), populationVelocity[i].data(),
+                 populationPastBests[i].data(), visible, jitter,
+                 swarmsBest.data(),
+                 {inertia, cognition * rCognition, social * rSocial,
+                  swarmAttraction * rSwarm},
+                 dimensions);
         });
 }
 
 void Swarm::evaluate()
 {
-    // cannot be parallelized because exception triggers std::terminate
-    std::transform(population.begin(), population.end(), aux.begin(),
-                   evaluations.begin(), [&](const auto& particle, auto& aux) {
-                       return function(particle, aux);
-                   });
+    // cache misses of the whole population are evaluated in a single call
+    function.evaluateBatch(population, evaluations);
 }
 
 void Swarm::updateBest()
@@ -100,6 +100,9 @@ class Swarm
     std::vector<std::vector<double>> aux;
     std::vector<std::vector<double>> populationVelocity;
     std::vector<std::vector<double>> populationPastBests;
+    // per particle inputs of the velocity update
+    std::vector<std::vector<double>> visibleBests;
+    std::vector<std::vector<double>> jitters;
     std::vector<std::vector<bool>> topologyChromosomes;
     std::vector<double> populationInertia;
     std::vector<double> evaluations;
@@ -1,9 +1,9 @@
 #include "Timer.h"
 
 namespace utils::timer {
-std::map<std::string, int> Timer::timers = {};
+std::map<std::string, int, std::less<>> Timer::timers = {};
 
-Timer::Timer(const std::string& name) : name{name}
+Timer::Timer(std::string_view name) : name{name}
 {
     start = std::chrono::high_resolution_clock::now();
 }
@@ -13,7 +13,11 @@ Timer::~Timer()
     const auto stop = std::chrono::high_resolution_clock::now();
     const auto duration =
         std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
-    timers[name] += duration.count();
+    auto it = timers.find(name);
+    if (it == timers.end()) {
+        it = timers.emplace(name, 0).first;
+    }
+    it->second += duration.count();
 }
 
 // static
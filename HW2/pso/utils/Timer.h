@@ -1,8 +1,10 @@
 #pragma once
 #include <chrono>
+#include <functional>
 #include <map>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 namespace utils::timer {
 
@@ -11,7 +13,9 @@ class Timer
 {
   public:
     Timer() = delete;
-    Timer(const std::string& name);
+    /// name is not copied, it has to outlive the timer (string literals are
+    /// fine)
+    Timer(std::string_view name);
     ~Timer();
 
     static void clean();
@@ -19,9 +23,10 @@ class Timer
 
   private:
     std::chrono::high_resolution_clock::time_point start;
-    std::string name;
+    std::string_view name;
 
-    static std::map<std::string, int> timers;
+    // transparent comparator, looking up a string_view does not allocate
+    static std::map<std::string, int, std::less<>> timers;
 };
 
 } // namespace utils::timer
@@ -0,0 +1,143 @@
+#include "../pso/functions/FunctionManager.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// Counts every call of the global allocation functions. Evaluations must not
+// touch the heap once the scratch buffers were sized by a warmup call.
+
+namespace {
+
+std::size_t allocations = 0;
+
+void* allocate(std::size_t size)
+{
+    ++allocations;
+    if (auto p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void* allocate(std::size_t size, std::align_val_t alignment)
+{
+    ++allocations;
+    const auto align = static_cast<std::size_t>(alignment);
+    // aligned_alloc requires size to be a multiple of the alignment
+    const auto rounded = (size + align - 1) / align * align;
+    if (auto p = std::aligned_alloc(align, rounded == 0 ? align : rounded)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    return allocate(size);
+}
+void* operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocate(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return allocate(size, alignment);
+}
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+
+constexpr auto evaluations = 1'000;
+
+/// returns the number of allocations done by evaluations that bypass the
+/// cache, measured after a warmup call. Cache insertions store a copy of each
+/// point, so operator() and evaluateBatch allocate by design.
+std::size_t countAllocations(const std::string& name, int dimensions)
+{
+    function_layer::FunctionManager function{
+        name, dimensions,
+        function_layer::cache_layer::KDTreeCache::CacheRetrievalStrategy::
+            Nearest,
+        true, true};
+
+    std::mt19937_64 gen{42};
+    std::uniform_real_distribution<double> dist{-100.0, 100.0};
+    std::vector<double> x(dimensions);
+    std::vector<double> aux(dimensions);
+
+    const auto single = [&]() {
+        for (auto& v : x) {
+            v = dist(gen);
+        }
+        function.cheat(x, aux);
+    };
+
+    single();
+    const auto before = allocations;
+    for (auto i = 0; i < evaluations; ++i) {
+        single();
+    }
+    return allocations - before;
+}
+
+} // namespace
+
+int main()
+{
+    const std::vector<std::string> functions = {
+        "zakharov_func", "rosenbrock_func", "schaffer_F7_func",
+        "rastrigin_func", "levy_func", "hf01", "hf02", "hf03", "cf01", "cf02",
+        "cf03", "cf04"};
+
+    auto failed = false;
+    for (const auto dimensions : {10, 20}) {
+        for (const auto& name : functions) {
+            const auto count = countAllocations(name, dimensions);
+            failed = failed or count != 0;
+            std::cout << (count == 0 ? "ok   " : "FAIL ") << name << " D"
+                      << dimensions << ": " << count << " allocations\n";
+        }
+    }
+    return failed ? 1 : 0;
+}